@@ -55,6 +55,7 @@ extern unsigned int libcfs_console_max_delay;
 extern unsigned int libcfs_console_min_delay;
 extern unsigned int libcfs_console_backoff;
 extern unsigned int libcfs_debug_binary;
+extern unsigned int libcfs_debug_defer;
 extern char libcfs_debug_file_path_arr[PATH_MAX];
 
 int libcfs_debug_mask2str(char *str, int size, int mask, int is_subsys);
@@ -84,6 +85,8 @@ struct ptldebug_header {
 
 
 #define PH_FLAG_FIRST_RECORD 1
+/* message not formatted yet, never seen outside of the kernel */
+#define PH_FLAG_DEFERRED 2
 
 /* Debugging subsystems (32 bits, non-overlapping) */
 /* keep these in sync with lnet/utils/debug.c and lnet/libcfs/debug.c */
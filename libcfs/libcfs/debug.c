@@ -90,6 +90,12 @@ EXPORT_SYMBOL(libcfs_console_backoff);
 unsigned int libcfs_debug_binary = 1;
 EXPORT_SYMBOL(libcfs_debug_binary);
 
+unsigned int libcfs_debug_defer;
+CFS_MODULE_PARM(libcfs_debug_defer, "i", uint, 0644,
+                "Record debug messages unformatted and format them when "
+                "the debug log is dumped");
+EXPORT_SYMBOL(libcfs_debug_defer);
+
 unsigned int libcfs_stack = 3 * THREAD_SIZE / 4;
 EXPORT_SYMBOL(libcfs_stack);
 
@@ -101,6 +101,7 @@ enum {
         PSDEV_LNET_FORCE_LBUG,    /* hook to force an LBUG */
         PSDEV_LNET_FAIL_LOC,      /* control test failures instrumentation */
         PSDEV_LNET_FAIL_VAL,      /* userdata for fail loc */
+        PSDEV_LNET_DEBUG_DEFER,   /* defer formatting of debug messages */
 };
 #else
 #define CTL_LNET                        CTL_UNNUMBERED
@@ -126,6 +127,7 @@ enum {
 #define PSDEV_LNET_FORCE_LBUG           CTL_UNNUMBERED
 #define PSDEV_LNET_FAIL_LOC             CTL_UNNUMBERED
 #define PSDEV_LNET_FAIL_VAL             CTL_UNNUMBERED
+#define PSDEV_LNET_DEBUG_DEFER          CTL_UNNUMBERED
 #endif
 
 int
@@ -532,6 +534,14 @@ static cfs_sysctl_table_t lnet_table[] = {
                 .mode     = 0644,
                 .proc_handler = &proc_debug_mb,
         },
+        {
+                INIT_CTL_NAME(PSDEV_LNET_DEBUG_DEFER)
+                .procname = "debug_defer",
+                .data     = &libcfs_debug_defer,
+                .maxlen   = sizeof(int),
+                .mode     = 0644,
+                .proc_handler = &proc_dointvec
+        },
         {
                 INIT_CTL_NAME(PSDEV_LNET_WATCHDOG_RATELIMIT)
                 .procname = "watchdog_ratelimit",
@@ -165,6 +165,7 @@ cfs_trace_get_tage_try(struct cfs_trace_cpu_data *tcd, unsigned long len)
                 }
 
                 tage->used = 0;
+                tage->deferred = 0;
                 tage->cpu = cfs_smp_processor_id();
                 tage->type = tcd->tcd_type;
                 cfs_list_add_tail(&tage->linkage, &tcd->tcd_pages);
@@ -238,11 +239,621 @@ static struct cfs_trace_page *cfs_trace_get_tage(struct cfs_trace_cpu_data *tcd,
         if (tcd->tcd_cur_pages > 0) {
                 tage = cfs_tage_from_list(tcd->tcd_pages.next);
                 tage->used = 0;
+                tage->deferred = 0;
                 cfs_tage_to_tail(tage, &tcd->tcd_pages);
         }
         return tage;
 }
 
+/*
+ * Deferred formatting.
+ *
+ * With libcfs_debug_defer set, a message which isn't going to the console
+ * is recorded as the IDs of its format strings followed by the raw
+ * arguments, and only formatted when the pages are dumped, spooled by the
+ * debug daemon or printed on panic.  Format strings are interned in
+ * cfs_trace_fmts, so a record stays printable after the module which
+ * logged it is gone.  Strings passed as arguments are copied into the
+ * record; messages using conversions we can't replay later (e.g. the
+ * kernel's %p extensions, which dereference their argument) are formatted
+ * immediately as usual.
+ */
+#define CFS_TRACE_FMT_BITS	14
+#define CFS_TRACE_FMT_NR	(1 << CFS_TRACE_FMT_BITS)
+#define CFS_TRACE_FMT_NONE	((__u32)~0)
+
+struct cfs_trace_fmt {
+	/* format string of the caller, lookup key */
+	const char		*tf_key;
+	/* our copy of it */
+	char			*tf_fmt;
+};
+
+static struct cfs_trace_fmt	*cfs_trace_fmts;
+static int			 cfs_trace_nfmts;
+static spinlock_t		 cfs_trace_fmt_lock;
+
+/* return the ID of format string @fmt, interning it if needed */
+static int cfs_trace_fmt_id(const char *fmt)
+{
+	struct cfs_trace_fmt	*tf;
+	unsigned long		 flags;
+	unsigned long		 hash;
+	char			*copy;
+	int			 len;
+	int			 i;
+
+	if (cfs_trace_fmts == NULL)
+		return -1;
+
+	hash = cfs_hash_long((unsigned long)fmt, CFS_TRACE_FMT_BITS);
+	for (i = 0; i < CFS_TRACE_FMT_NR; i++) {
+		tf = &cfs_trace_fmts[(hash + i) & (CFS_TRACE_FMT_NR - 1)];
+		if (tf->tf_key == NULL)
+			break;
+		/* NB: a module reloaded at the same address may reuse the
+		 * pointer for another string */
+		if (tf->tf_key == fmt) {
+			cfs_mb();
+			if (strcmp(tf->tf_fmt, fmt) == 0)
+				return (hash + i) & (CFS_TRACE_FMT_NR - 1);
+		}
+	}
+
+	if (cfs_trace_nfmts >= CFS_TRACE_FMT_NR / 4 * 3)
+		return -1;
+
+	len = strlen(fmt) + 1;
+	copy = cfs_alloc(len, CFS_ALLOC_ATOMIC | CFS_ALLOC_NOWARN);
+	if (copy == NULL)
+		return -1;
+	memcpy(copy, fmt, len);
+
+	spin_lock_irqsave(&cfs_trace_fmt_lock, flags);
+	for (; i < CFS_TRACE_FMT_NR; i++) {
+		tf = &cfs_trace_fmts[(hash + i) & (CFS_TRACE_FMT_NR - 1)];
+		if (tf->tf_key == NULL)
+			break;
+		if (tf->tf_key == fmt && strcmp(tf->tf_fmt, fmt) == 0) {
+			/* raced with another CPU */
+			spin_unlock_irqrestore(&cfs_trace_fmt_lock, flags);
+			cfs_free(copy);
+			return (hash + i) & (CFS_TRACE_FMT_NR - 1);
+		}
+	}
+
+	if (i == CFS_TRACE_FMT_NR) {
+		spin_unlock_irqrestore(&cfs_trace_fmt_lock, flags);
+		cfs_free(copy);
+		return -1;
+	}
+
+	tf->tf_fmt = copy;
+	/* publish the copy before the key */
+	cfs_mb();
+	tf->tf_key = fmt;
+	cfs_trace_nfmts++;
+	spin_unlock_irqrestore(&cfs_trace_fmt_lock, flags);
+
+	return (hash + i) & (CFS_TRACE_FMT_NR - 1);
+}
+
+static void cfs_trace_fmt_init(void)
+{
+	spin_lock_init(&cfs_trace_fmt_lock);
+	/* deferred formatting just stays unavailable without the table */
+	cfs_trace_fmts = cfs_alloc_large(CFS_TRACE_FMT_NR *
+					 sizeof(*cfs_trace_fmts));
+	if (cfs_trace_fmts != NULL)
+		memset(cfs_trace_fmts, 0,
+		       CFS_TRACE_FMT_NR * sizeof(*cfs_trace_fmts));
+}
+
+static void cfs_trace_fmt_fini(void)
+{
+	int	i;
+
+	if (cfs_trace_fmts == NULL)
+		return;
+
+	for (i = 0; i < CFS_TRACE_FMT_NR; i++) {
+		if (cfs_trace_fmts[i].tf_key != NULL)
+			cfs_free(cfs_trace_fmts[i].tf_fmt);
+	}
+	cfs_free_large(cfs_trace_fmts);
+	cfs_trace_fmts = NULL;
+	cfs_trace_nfmts = 0;
+}
+
+/* argument types of a conversion */
+enum {
+	CFS_TRACE_ARG_NONE,	/* "%%" */
+	CFS_TRACE_ARG_INT,
+	CFS_TRACE_ARG_LONG,
+	CFS_TRACE_ARG_LLONG,
+	CFS_TRACE_ARG_SIZE,
+	CFS_TRACE_ARG_PTR,
+	CFS_TRACE_ARG_STR,
+};
+
+struct cfs_trace_conv {
+	/* length of the conversion, from '%' */
+	int			tc_len;
+	/* argument type */
+	int			tc_type;
+	/* width and precision are passed as arguments ('*') */
+	int			tc_width_arg;
+	int			tc_prec_arg;
+	/* literal precision, -1 if none */
+	int			tc_prec;
+};
+
+/* parse the conversion at @fmt, which points at a '%' */
+static int cfs_trace_parse_conv(const char *fmt, struct cfs_trace_conv *tc)
+{
+	const char	*p = fmt + 1;
+	int		 nlong = 0;
+	int		 size = 0;
+
+	memset(tc, 0, sizeof(*tc));
+	tc->tc_prec = -1;
+
+	if (*p == '%') {
+		tc->tc_len = 2;
+		tc->tc_type = CFS_TRACE_ARG_NONE;
+		return 0;
+	}
+
+	while (*p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0')
+		p++;
+
+	if (*p == '*') {
+		tc->tc_width_arg = 1;
+		p++;
+	} else {
+		while (*p >= '0' && *p <= '9')
+			p++;
+	}
+
+	if (*p == '.') {
+		p++;
+		if (*p == '*') {
+			tc->tc_prec_arg = 1;
+			p++;
+		} else {
+			tc->tc_prec = 0;
+			while (*p >= '0' && *p <= '9')
+				tc->tc_prec = tc->tc_prec * 10 + *p++ - '0';
+		}
+	}
+
+	for (;; p++) {
+		if (*p == 'h')
+			continue;
+		if (*p == 'l')
+			nlong++;
+		else if (*p == 'L' || *p == 'q' || *p == 'j')
+			nlong = 2;
+		else if (*p == 'z' || *p == 'Z' || *p == 't')
+			size = 1;
+		else
+			break;
+	}
+
+	switch (*p) {
+	case 'd':
+	case 'i':
+	case 'u':
+	case 'x':
+	case 'X':
+	case 'o':
+	case 'c':
+		tc->tc_type = size ? CFS_TRACE_ARG_SIZE :
+			      nlong >= 2 ? CFS_TRACE_ARG_LLONG :
+			      nlong == 1 ? CFS_TRACE_ARG_LONG :
+					   CFS_TRACE_ARG_INT;
+		break;
+	case 's':
+		if (nlong != 0)
+			return -1;
+		tc->tc_type = CFS_TRACE_ARG_STR;
+		break;
+	case 'p':
+		if ((p[1] >= 'a' && p[1] <= 'z') ||
+		    (p[1] >= 'A' && p[1] <= 'Z') ||
+		    (p[1] >= '0' && p[1] <= '9'))
+			return -1;
+		tc->tc_type = CFS_TRACE_ARG_PTR;
+		break;
+	default:
+		return -1;
+	}
+
+	tc->tc_len = p + 1 - fmt;
+	return 0;
+}
+
+#define CFS_TRACE_PUT(p, end, val)					\
+do {									\
+	if ((p) + sizeof(val) > (end))					\
+		return -E2BIG;						\
+	memcpy(p, &(val), sizeof(val));					\
+	(p) += sizeof(val);						\
+} while (0)
+
+#define CFS_TRACE_GET(p, end, val)					\
+do {									\
+	if ((p) + sizeof(val) > (end))					\
+		return -EINVAL;						\
+	memcpy(&(val), p, sizeof(val));					\
+	(p) += sizeof(val);						\
+} while (0)
+
+/**
+ * Store the arguments of \a fmt taken from \a args at \a buf.
+ *
+ * \retval # bytes stored
+ * \retval -E2BIG they don't fit in \a size bytes
+ * \retval -EINVAL \a fmt can't be formatted later
+ */
+static int cfs_trace_capture(char *buf, int size, const char *fmt,
+			     va_list args)
+{
+	struct cfs_trace_conv	 tc;
+	char			*end = buf + size;
+	char			*p = buf;
+	const char		*str;
+	unsigned long long	 llval;
+	unsigned long		 lval;
+	size_t			 zval;
+	void			*ptr;
+	int			 ival;
+	int			 prec;
+	int			 len;
+
+	for (; *fmt != 0; fmt++) {
+		if (*fmt != '%')
+			continue;
+
+		if (cfs_trace_parse_conv(fmt, &tc) != 0)
+			return -EINVAL;
+		fmt += tc.tc_len - 1;
+
+		if (tc.tc_width_arg) {
+			ival = va_arg(args, int);
+			CFS_TRACE_PUT(p, end, ival);
+		}
+
+		prec = tc.tc_prec;
+		if (tc.tc_prec_arg) {
+			prec = ival = va_arg(args, int);
+			CFS_TRACE_PUT(p, end, ival);
+		}
+
+		switch (tc.tc_type) {
+		case CFS_TRACE_ARG_NONE:
+			break;
+		case CFS_TRACE_ARG_INT:
+			ival = va_arg(args, int);
+			CFS_TRACE_PUT(p, end, ival);
+			break;
+		case CFS_TRACE_ARG_LONG:
+			lval = va_arg(args, unsigned long);
+			CFS_TRACE_PUT(p, end, lval);
+			break;
+		case CFS_TRACE_ARG_LLONG:
+			llval = va_arg(args, unsigned long long);
+			CFS_TRACE_PUT(p, end, llval);
+			break;
+		case CFS_TRACE_ARG_SIZE:
+			zval = va_arg(args, size_t);
+			CFS_TRACE_PUT(p, end, zval);
+			break;
+		case CFS_TRACE_ARG_PTR:
+			ptr = va_arg(args, void *);
+			CFS_TRACE_PUT(p, end, ptr);
+			break;
+		case CFS_TRACE_ARG_STR:
+			str = va_arg(args, const char *);
+			if (str == NULL)
+				str = "(null)";
+			/* the string may not be terminated within its
+			 * precision */
+			len = prec >= 0 ? strnlen(str, prec) : strlen(str);
+			if (p + len + 1 > end)
+				return -E2BIG;
+			memcpy(p, str, len);
+			p[len] = 0;
+			p += len + 1;
+			break;
+		}
+	}
+
+	return p - buf;
+}
+
+/**
+ * Format \a fmt into \a buf with the arguments stored at \a data by
+ * cfs_trace_capture().  The length of the text is returned in \a nob.
+ *
+ * \retval # bytes of \a data consumed
+ */
+static int cfs_trace_replay(char *buf, int size, int *nob, const char *fmt,
+			    char *data, int datalen)
+{
+	struct cfs_trace_conv	 tc;
+	char			*end = data + datalen;
+	char			*p = data;
+	char			 conv[32];
+	unsigned long long	 llval;
+	unsigned long		 lval;
+	size_t			 zval;
+	void			*ptr;
+	int			 ival;
+	int			 n = 0;
+	int			 rc;
+	int			 i;
+	int			 j;
+
+	for (; *fmt != 0 && n < size - 1; fmt++) {
+		if (*fmt != '%') {
+			buf[n++] = *fmt;
+			continue;
+		}
+
+		if (cfs_trace_parse_conv(fmt, &tc) != 0)
+			return -EINVAL;
+
+		/* rebuild the conversion with '*' replaced by the values */
+		for (i = j = 0; i < tc.tc_len && j < sizeof(conv) - 12; i++) {
+			if (fmt[i] != '*') {
+				conv[j++] = fmt[i];
+				continue;
+			}
+			CFS_TRACE_GET(p, end, ival);
+			j += snprintf(conv + j, sizeof(conv) - j, "%d", ival);
+		}
+		conv[j] = 0;
+		fmt += tc.tc_len - 1;
+
+		switch (tc.tc_type) {
+		case CFS_TRACE_ARG_NONE:
+			rc = snprintf(buf + n, size - n, "%%");
+			break;
+		case CFS_TRACE_ARG_INT:
+			CFS_TRACE_GET(p, end, ival);
+			rc = snprintf(buf + n, size - n, conv, ival);
+			break;
+		case CFS_TRACE_ARG_LONG:
+			CFS_TRACE_GET(p, end, lval);
+			rc = snprintf(buf + n, size - n, conv, lval);
+			break;
+		case CFS_TRACE_ARG_LLONG:
+			CFS_TRACE_GET(p, end, llval);
+			rc = snprintf(buf + n, size - n, conv, llval);
+			break;
+		case CFS_TRACE_ARG_SIZE:
+			CFS_TRACE_GET(p, end, zval);
+			rc = snprintf(buf + n, size - n, conv, zval);
+			break;
+		case CFS_TRACE_ARG_PTR:
+			CFS_TRACE_GET(p, end, ptr);
+			rc = snprintf(buf + n, size - n, conv, ptr);
+			break;
+		case CFS_TRACE_ARG_STR:
+			rc = snprintf(buf + n, size - n, conv, p);
+			p += strnlen(p, end - p) + 1;
+			break;
+		default:
+			rc = 0;
+			break;
+		}
+		n += min(rc, size - 1 - n);
+	}
+
+	buf[n] = 0;
+	*nob = n;
+	return p - data;
+}
+
+/* skip header, file and function name of a record, see
+ * cfs_trace_defer_msg() */
+static char *cfs_trace_record_payload(struct ptldebug_header *hdr)
+{
+	char	*p = (char *)(hdr + 1);
+
+	p += strlen(p) + 1;
+	p += strlen(p) + 1;
+	return p;
+}
+
+/* format the message of deferred record @hdr into @buf */
+static int cfs_trace_replay_record(struct ptldebug_header *hdr, char *buf,
+				   int size)
+{
+	char	*end = (char *)hdr + hdr->ph_len;
+	char	*p = cfs_trace_record_payload(hdr);
+	__u32	 ids[2];
+	int	 nob = 0;
+	int	 len;
+	int	 rc;
+	int	 i;
+
+	memcpy(ids, p, sizeof(ids));
+	p += sizeof(ids);
+
+	for (i = 0; i < 2; i++) {
+		if (ids[i] == CFS_TRACE_FMT_NONE)
+			continue;
+
+		rc = cfs_trace_replay(buf + nob, size - nob, &len,
+				      cfs_trace_fmts[ids[i]].tf_fmt,
+				      p, end - p);
+		if (rc < 0)
+			break;
+		p += rc;
+		nob += len;
+	}
+
+	return nob;
+}
+
+/**
+ * Record a message without formatting it.
+ *
+ * \retval 0 the message is recorded
+ * \retval -ve it must be formatted now
+ */
+static int cfs_trace_defer_msg(struct cfs_trace_cpu_data *tcd,
+			       struct ptldebug_header *header,
+			       const char *file, const char *fn, int depth,
+			       const char *format1, va_list args1,
+			       const char *format2, va_list args2)
+{
+	struct cfs_trace_page	*tage = NULL;
+	char			*debug_buf;
+	char			*end;
+	char			*p;
+	va_list			 ap;
+	__u32			 ids[2] = { CFS_TRACE_FMT_NONE,
+					    CFS_TRACE_FMT_NONE };
+	int			 known_size;
+	int			 needed = 64;
+	int			 rc = 0;
+	int			 i;
+
+	if (format1 != NULL) {
+		rc = cfs_trace_fmt_id(format1);
+		if (rc < 0)
+			return rc;
+		ids[0] = rc;
+	}
+
+	if (format2 != NULL) {
+		rc = cfs_trace_fmt_id(format2);
+		if (rc < 0)
+			return rc;
+		ids[1] = rc;
+	}
+
+	known_size = sizeof(*header) + depth + strlen(file) + 1 +
+		     strlen(fn) + 1 + sizeof(ids);
+
+	for (i = 0; i < 2; i++) {
+		tage = cfs_trace_get_tage(tcd, known_size + needed);
+		if (tage == NULL)
+			return -ENOMEM;
+
+		debug_buf = (char *)cfs_page_address(tage->page) + tage->used;
+		end = (char *)cfs_page_address(tage->page) + CFS_PAGE_SIZE;
+		p = debug_buf + known_size;
+
+		if (format1 != NULL) {
+			va_copy(ap, args1);
+			rc = cfs_trace_capture(p, end - p, format1, ap);
+			va_end(ap);
+			if (rc < 0)
+				goto again;
+			p += rc;
+		}
+
+		if (format2 != NULL) {
+			va_copy(ap, args2);
+			rc = cfs_trace_capture(p, end - p, format2, ap);
+			va_end(ap);
+			if (rc < 0)
+				goto again;
+			p += rc;
+		}
+		break;
+again:
+		if (rc != -E2BIG)
+			return rc;
+		/* try again at the start of a new page */
+		needed = CFS_PAGE_SIZE - known_size;
+	}
+
+	if (rc < 0)
+		return rc;
+
+	header->ph_flags |= PH_FLAG_DEFERRED;
+	header->ph_len = p - debug_buf;
+	memcpy(debug_buf, header, sizeof(*header));
+	debug_buf += sizeof(*header);
+
+	/* indent message according to the nesting level */
+	while (depth-- > 0)
+		*(debug_buf++) = '.';
+
+	strcpy(debug_buf, file);
+	debug_buf += strlen(file) + 1;
+	strcpy(debug_buf, fn);
+	debug_buf += strlen(fn) + 1;
+	memcpy(debug_buf, ids, sizeof(ids));
+
+	tage->used += header->ph_len;
+	tage->deferred++;
+	__LASSERT(tage->used <= CFS_PAGE_SIZE);
+
+	return 0;
+}
+
+/**
+ * Write the records of \a tage to \a filp at \a pos, formatting deferred
+ * records on the way through \a buf, which is 2 pages large.
+ *
+ * \retval # bytes of the page written, tage->used on success
+ */
+static int cfs_trace_write_page(cfs_file_t *filp, struct cfs_trace_page *tage,
+				char *buf, loff_t *pos)
+{
+	struct ptldebug_header	*hdr;
+	char			*p = cfs_page_address(tage->page);
+	char			*end = p + tage->used;
+	char			*start = p;
+	int			 nob = 0;
+	int			 len;
+	int			 rc;
+
+	if (tage->deferred == 0)
+		return cfs_filp_write(filp, p, tage->used, pos);
+
+	while (p < end) {
+		hdr = (struct ptldebug_header *)p;
+		len = hdr->ph_len;
+
+		if ((hdr->ph_flags & PH_FLAG_DEFERRED) == 0) {
+			memcpy(buf + nob, p, len);
+			nob += len;
+		} else {
+			struct ptldebug_header *out;
+			int			prefix;
+
+			/* header, file and function name as they are */
+			prefix = cfs_trace_record_payload(hdr) - p;
+			memcpy(buf + nob, p, prefix);
+			out = (struct ptldebug_header *)(buf + nob);
+			out->ph_len = prefix +
+				      cfs_trace_replay_record(hdr,
+							      buf + nob + prefix,
+							      CFS_PAGE_SIZE -
+							      prefix);
+			out->ph_flags &= ~PH_FLAG_DEFERRED;
+			nob += out->ph_len;
+		}
+		p += len;
+
+		if (nob > CFS_PAGE_SIZE || (p >= end && nob > 0)) {
+			rc = cfs_filp_write(filp, buf, nob, pos);
+			if (rc != nob)
+				return rc < 0 ? rc : p - start - len;
+			nob = 0;
+		}
+	}
+
+	return tage->used;
+}
+
 int libcfs_debug_msg(struct libcfs_debug_msg_data *msgdata,
                      const char *format, ...)
 {
@@ -301,6 +912,23 @@ int libcfs_debug_vmsg2(struct libcfs_debug_msg_data *msgdata,
         }
 
         depth = __current_nesting_level();
+
+        /* leave formatting to whoever reads the log, unless the message
+         * goes to the console as well */
+        if (libcfs_debug_defer && libcfs_debug_binary &&
+            (mask & libcfs_printk) == 0) {
+                va_start(ap, format2);
+                i = cfs_trace_defer_msg(tcd, &header, file,
+                                        msgdata->msg_fn != NULL ?
+                                        msgdata->msg_fn : "", depth,
+                                        format1, args, format2, ap);
+                va_end(ap);
+                if (i == 0) {
+                        cfs_trace_put_tcd(tcd);
+                        return 1;
+                }
+        }
+
         known_size = strlen(file) + 1 + depth;
         if (msgdata->msg_fn)
                 known_size += strlen(msgdata->msg_fn) + 1;
@@ -669,7 +1297,19 @@ void cfs_trace_debug_print(void)
                         p += strlen(fn) + 1;
                         len = hdr->ph_len - (int)(p - (char *)hdr);
 
-                        cfs_print_to_console(hdr, D_EMERG, p, len, file, fn);
+                        if (hdr->ph_flags & PH_FLAG_DEFERRED) {
+                                char *buf = cfs_trace_get_console_buffer();
+                                int   nob;
+
+                                nob = cfs_trace_replay_record(hdr, buf,
+                                        CFS_TRACE_CONSOLE_BUFFER_SIZE);
+                                cfs_print_to_console(hdr, D_EMERG, buf, nob,
+                                                     file, fn);
+                                cfs_trace_put_console_buffer(buf);
+                        } else {
+                                cfs_print_to_console(hdr, D_EMERG, p, len,
+                                                     file, fn);
+                        }
 
                         p += len;
                 }
@@ -685,10 +1325,16 @@ int cfs_tracefile_dump_all_pages(char *filename)
         cfs_file_t *filp;
         struct cfs_trace_page *tage;
         struct cfs_trace_page *tmp;
+        char *buf;
         int rc;
 
         CFS_DECL_MMSPACE;
 
+        /* for formatting deferred records */
+        buf = cfs_alloc(2 * CFS_PAGE_SIZE, CFS_ALLOC_STD);
+        if (buf == NULL)
+                return -ENOMEM;
+
         cfs_tracefile_write_lock();
 
         filp = cfs_filp_open(filename,
@@ -717,8 +1363,8 @@ int cfs_tracefile_dump_all_pages(char *filename)
 
                 __LASSERT_TAGE_INVARIANT(tage);
 
-                rc = cfs_filp_write(filp, cfs_page_address(tage->page),
-                                    tage->used, cfs_filp_poff(filp));
+                rc = cfs_trace_write_page(filp, tage, buf,
+                                          cfs_filp_poff(filp));
                 if (rc != (int)tage->used) {
                         printk(CFS_KERN_WARNING "wanted to write %u but wrote "
                                "%d\n", tage->used, rc);
@@ -737,6 +1383,7 @@ int cfs_tracefile_dump_all_pages(char *filename)
         cfs_filp_close(filp);
  out:
         cfs_tracefile_write_unlock();
+        cfs_free(buf);
         return rc;
 }
 
@@ -985,6 +1632,7 @@ static int tracefiled(void *arg)
         struct cfs_trace_page *tage;
         struct cfs_trace_page *tmp;
         cfs_file_t *filp;
+        char *buf = NULL;
         int last_loop = 0;
         int rc;
 
@@ -1005,9 +1653,13 @@ static int tracefiled(void *arg)
                 if (cfs_list_empty(&pc.pc_pages))
                         goto end_loop;
 
+                /* for formatting deferred records */
+                if (buf == NULL)
+                        buf = cfs_alloc(2 * CFS_PAGE_SIZE, CFS_ALLOC_STD);
+
                 filp = NULL;
                 cfs_tracefile_read_lock();
-                if (cfs_tracefile[0] != 0) {
+                if (buf != NULL && cfs_tracefile[0] != 0) {
                         filp = cfs_filp_open(cfs_tracefile,
                                              O_CREAT | O_RDWR | O_LARGEFILE,
                                              0600, &rc);
@@ -1036,8 +1688,7 @@ static int tracefiled(void *arg)
                         else if (f_pos > (off_t)cfs_filp_size(filp))
                                 f_pos = cfs_filp_size(filp);
 
-                        rc = cfs_filp_write(filp, cfs_page_address(tage->page),
-                                            tage->used, &f_pos);
+                        rc = cfs_trace_write_page(filp, tage, buf, &f_pos);
                         if (rc != (int)tage->used) {
                                 printk(CFS_KERN_WARNING "wanted to write %u "
                                        "but wrote %d\n", tage->used, rc);
@@ -1088,6 +1739,8 @@ end_loop:
                                     cfs_time_seconds(1));
                 cfs_waitq_del(&tctl->tctl_waitq, &__wait);
         }
+        if (buf != NULL)
+                cfs_free(buf);
 	complete(&tctl->tctl_stop);
         return 0;
 }
@@ -1145,6 +1798,8 @@ int cfs_tracefile_init(int max_pages)
         if (rc != 0)
                 return rc;
 
+        cfs_trace_fmt_init();
+
         cfs_tcd_for_each(tcd, i, j) {
                 /* tcd_pages_factor is initialized int tracefile_init_arch. */
                 factor = tcd->tcd_pages_factor;
@@ -1198,6 +1853,7 @@ static void cfs_trace_cleanup(void)
 	trace_cleanup_on_all_cpus();
 
 	cfs_tracefile_fini_arch();
+	cfs_trace_fmt_fini();
 }
 
 void cfs_tracefile_exit(void)
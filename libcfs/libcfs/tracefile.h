@@ -257,6 +257,10 @@ struct cfs_trace_page {
 	 * type(context) of this page
 	 */
 	unsigned short       type;
+	/*
+	 * number of records in this page still to be formatted
+	 */
+	unsigned int         deferred;
 };
 
 extern void cfs_set_ptldebug_header(struct ptldebug_header *header,
@@ -474,10 +474,20 @@ typedef struct {
 	lnet_ping_info_t	*rcd_pinginfo;	/* ping buffer */
 } lnet_rc_data_t;
 
+#define LNET_NRBPOOLS         3                 /* # different router buffer pools */
+
+/* one peer's messages blocking for buffers in one router buffer pool */
+typedef struct {
+        cfs_list_t        lpq_list;             /* chain on rbp_peers */
+        cfs_list_t        lpq_msgs;             /* blocked messages */
+} lnet_peer_rtrbufq_t;
+
 typedef struct lnet_peer {
         cfs_list_t        lp_hashlist;          /* chain on peer hash */
         cfs_list_t        lp_txq;               /* messages blocking for tx credits */
         cfs_list_t        lp_rtrq;              /* messages blocking for router credits */
+        /* messages blocking for router buffers, by pool */
+        lnet_peer_rtrbufq_t lp_rtrbufq[LNET_NRBPOOLS];
         cfs_list_t        lp_rtr_list;          /* chain on router list */
         int               lp_txcredits;         /* # tx credits available */
         int               lp_mintxcredits;      /* low water mark */
@@ -493,6 +503,8 @@ typedef struct lnet_peer {
         cfs_time_t        lp_timestamp;         /* time of last aliveness news */
         cfs_time_t        lp_ping_timestamp;    /* time of last ping attempt */
         cfs_time_t        lp_ping_deadline;     /* != 0 if ping reply expected */
+	unsigned int		lp_ping_rtt;	/* smoothed ping RTT (usecs) */
+	struct timeval		lp_ping_sent;	/* when the last ping was posted */
         cfs_time_t        lp_last_alive;        /* when I was last alive */
         cfs_time_t        lp_last_query;        /* when lp_ni was queried last time */
         lnet_ni_t        *lp_ni;                /* interface peer is on */
@@ -544,11 +556,15 @@ typedef struct {
 
 typedef struct {
         cfs_list_t rbp_bufs;             /* my free buffer pool */
-        cfs_list_t rbp_msgs;             /* messages blocking for a buffer */
+        cfs_list_t rbp_peers;            /* peers with messages blocking for a buffer */
         int        rbp_npages;           /* # pages in each buffer */
         int        rbp_nbuffers;         /* # buffers */
         int        rbp_credits;          /* # free buffers / blocked messages */
         int        rbp_mincredits;       /* low water mark */
+        int        rbp_lwcredits;        /* low water mark since last resize check */
+        int        rbp_nbuffers_min;     /* never shrink below this */
+        int        rbp_nbuffers_max;     /* never grow above this */
+        int        rbp_nidle;            /* # checks without a shortage */
 } lnet_rtrbufpool_t;
 
 typedef struct {
@@ -575,8 +591,6 @@ typedef struct {
 
 #define LNET_PEER_HASHSIZE   503                /* prime! */
 
-#define LNET_NRBPOOLS         3                 /* # different router buffer pools */
-
 enum {
 	/* Didn't match anything */
 	LNET_MATCHMD_NONE	= (1 << 0),
@@ -72,6 +72,7 @@
 #define LSTIO_TEST_ADD          0xC26           /* add test (to batch) */
 #define LSTIO_BATCH_QUERY       0xC27           /* query batch status */
 #define LSTIO_STAT_QUERY        0xC30           /* get stats */
+#define LSTIO_LAT_QUERY         0xC31           /* get RPC latency histograms */
 
 typedef struct {
         lnet_nid_t              ses_nid;                /* nid of console node */
@@ -410,9 +411,26 @@ typedef struct {
         cfs_list_t             *lstio_sta_resultp;      /* OUT: list head of result buffer */
 } lstio_stat_args_t;
 
+#define LST_LAT_IDX_ALL         (-1)    /* aggregate of all peers */
+#define LST_LAT_RESET           0x1     /* clear histograms after reading */
+
+/* query RPC latency histograms */
+typedef struct {
+        int                     lstio_lat_key;          /* IN: session key */
+        int                     lstio_lat_timeout;      /* IN: timeout for latency requst */
+        int                     lstio_lat_nmlen;        /* IN: group name length */
+        char                   *lstio_lat_namep;        /* IN: group name */
+        int                     lstio_lat_count;        /* IN: # of pid */
+        lnet_process_id_t      *lstio_lat_idsp;         /* IN: pid */
+        int                     lstio_lat_idx;          /* IN: peer index, or LST_LAT_IDX_ALL */
+        int                     lstio_lat_flags;        /* IN: LST_LAT_* flags */
+        cfs_list_t             *lstio_lat_resultp;      /* OUT: list head of result buffer */
+} lstio_lat_args_t;
+
 typedef enum {
         LST_TEST_BULK   = 1,
-        LST_TEST_PING   = 2
+        LST_TEST_PING   = 2,
+        LST_TEST_STORM  = 3
 } lst_test_type_t;
 
 /* create a test in a batch */
@@ -488,6 +506,21 @@ typedef struct {
         __u32 brw_errors;
         __u32 ping_errors;
 } WIRE_ATTR sfw_counters_t;
+
+/* bucket 0 counts round trips under 1 usec, bucket i those of
+ * [2^(i-1), 2^i) usec and the last one everything slower */
+#define LST_LAT_BUCKETS         24
+
+typedef struct {
+        __u32 lat_max;                          /* slowest round trip (usec) */
+        __u32 lat_buckets[LST_LAT_BUCKETS];     /* log2 histogram */
+} WIRE_ATTR lst_lat_hist_t;
 #include <libcfs/libcfs_unpack.h>
 
+typedef struct {
+        int                     lte_npeers;             /* # of peers known by the node */
+        lnet_process_id_t       lte_peer;               /* peer of the histogram */
+        lst_lat_hist_t          lte_hist;               /* latency histogram */
+} lstcon_lat_ent_t;                                     /*** reply payload of latency query */
+
 #endif
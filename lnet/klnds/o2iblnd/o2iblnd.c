@@ -733,6 +733,7 @@ kiblnd_create_conn(kib_peer_t *peer, struct rdma_cm_id *cmid,
 	kib_conn_t		*conn;
 	struct ib_cq		*cq;
 	unsigned long		flags;
+	int			frwr;
 	int			cpt;
 	int			rc;
 	int			i;
@@ -741,6 +742,8 @@ kiblnd_create_conn(kib_peer_t *peer, struct rdma_cm_id *cmid,
 	LASSERT(!cfs_in_interrupt());
 
 	dev = net->ibn_dev;
+	/* send queue room for the registration WRs of FRWR */
+	frwr = net->ibn_frwr_ps != NULL;
 
 	cpt = lnet_cpt_of_nid(peer->ibp_nid);
 	sched = kiblnd_data.kib_scheds[cpt];
@@ -828,16 +831,16 @@ kiblnd_create_conn(kib_peer_t *peer, struct rdma_cm_id *cmid,
 #ifdef HAVE_OFED_IB_COMP_VECTOR
 	cq = ib_create_cq(cmid->device,
 			  kiblnd_cq_completion, kiblnd_cq_event, conn,
-			  IBLND_CQ_ENTRIES(version),
+			  IBLND_CQ_ENTRIES(version, frwr),
 			  kiblnd_get_completion_vector(conn, cpt));
 #else
         cq = ib_create_cq(cmid->device,
                           kiblnd_cq_completion, kiblnd_cq_event, conn,
-                          IBLND_CQ_ENTRIES(version));
+                          IBLND_CQ_ENTRIES(version, frwr));
 #endif
         if (IS_ERR(cq)) {
                 CERROR("Can't create CQ: %ld, cqe: %d\n",
-                       PTR_ERR(cq), IBLND_CQ_ENTRIES(version));
+                       PTR_ERR(cq), IBLND_CQ_ENTRIES(version, frwr));
                 goto failed_2;
         }
 
@@ -851,7 +854,7 @@ kiblnd_create_conn(kib_peer_t *peer, struct rdma_cm_id *cmid,
 
         init_qp_attr->event_handler = kiblnd_qp_event;
         init_qp_attr->qp_context = conn;
-        init_qp_attr->cap.max_send_wr = IBLND_SEND_WRS(version);
+        init_qp_attr->cap.max_send_wr = IBLND_SEND_WRS(version, frwr);
         init_qp_attr->cap.max_recv_wr = IBLND_RECV_WRS(version);
         init_qp_attr->cap.max_send_sge = 1;
         init_qp_attr->cap.max_recv_sge = 1;
@@ -2043,6 +2046,233 @@ kiblnd_create_pmr_pool(kib_poolset_t *ps, int size, kib_pool_t **pp_po)
         return 0;
 }
 
+void
+kiblnd_frwr_pool_unmap(kib_frwr_t *frwr, int status)
+{
+        kib_frwr_pool_t *fwpo = frwr->frwr_pool;
+
+        if (frwr->frwr_posted && status != 0) {
+                /* the tx failed and its QP is (going) into error, so a
+                 * LOCAL_INV can't be posted; deregistering the MR revokes
+                 * the key before the pages are unmapped and reused, and
+                 * kiblnd_frwr_pool_map() allocates a new one */
+                ib_dereg_mr(frwr->frwr_mr);
+                frwr->frwr_mr    = NULL;
+                frwr->frwr_valid = 0;
+        } else if (frwr->frwr_posted) {
+                /* registration is (or may be) live on the HCA, the next
+                 * user invalidates it inline, so no flush is needed */
+                frwr->frwr_valid = 1;
+        } else if (frwr->frwr_inv) {
+                /* never reached the HCA: it still knows the old key */
+                ib_update_fast_reg_key(frwr->frwr_mr,
+                                       frwr->frwr_inv_wr.ex.invalidate_rkey &
+                                       0xff);
+        }
+
+        frwr->frwr_inv    = 0;
+        frwr->frwr_posted = 0;
+        kiblnd_pool_free_node(&fwpo->fwpo_pool, &frwr->frwr_list);
+}
+
+int
+kiblnd_frwr_pool_map(kib_frwr_poolset_t *fwps, kib_hca_dev_t *hdev,
+                     kib_rdma_desc_t *rd, int nob, kib_frwr_t **pp_frwr)
+{
+        kib_frwr_t        *frwr;
+        struct ib_send_wr *wrq;
+        cfs_list_t        *node;
+        __u64             *pages;
+        __u64              addr;
+        __u64              end;
+        __u32              key;
+        int                npages;
+        int                i;
+
+        node = kiblnd_pool_alloc_node(&fwps->fwps_poolset);
+        if (node == NULL) {
+                CERROR("Failed to allocate FRWR descriptor\n");
+                return -ENOMEM;
+        }
+
+        frwr = container_of(node, kib_frwr_t, frwr_list);
+        if (frwr->frwr_pool->fwpo_hdev != hdev) {
+                kiblnd_pool_free_node(&frwr->frwr_pool->fwpo_pool, node);
+                return -EAGAIN;
+        }
+
+        if (frwr->frwr_mr == NULL) {
+                /* retired by a failed tx */
+                frwr->frwr_mr = ib_alloc_fast_reg_mr(hdev->ibh_pd,
+                                                     IBLND_FRWR_PAGES);
+                if (IS_ERR(frwr->frwr_mr)) {
+                        CERROR("Failed to reallocate FRWR MR: %ld\n",
+                               PTR_ERR(frwr->frwr_mr));
+                        frwr->frwr_mr = NULL;
+                        kiblnd_pool_free_node(&frwr->frwr_pool->fwpo_pool,
+                                              node);
+                        return -ENOMEM;
+                }
+        }
+
+        pages = frwr->frwr_frpl->page_list;
+        for (i = 0, npages = 0; i < rd->rd_nfrags; i++) {
+                addr = rd->rd_frags[i].rf_addr & hdev->ibh_page_mask;
+                end  = rd->rd_frags[i].rf_addr + rd->rd_frags[i].rf_nob;
+
+                for (; addr < end; addr += hdev->ibh_page_size) {
+                        if (npages == IBLND_FRWR_PAGES) {
+                                CERROR("Too many pages to register: "
+                                       "%d frags, %d bytes\n",
+                                       rd->rd_nfrags, nob);
+                                kiblnd_pool_free_node(&frwr->frwr_pool->
+                                                      fwpo_pool, node);
+                                return -EMSGSIZE;
+                        }
+                        pages[npages++] = addr;
+                }
+        }
+
+        key = frwr->frwr_mr->rkey;
+        frwr->frwr_inv = frwr->frwr_valid;
+        if (frwr->frwr_inv) {
+                wrq = &frwr->frwr_inv_wr;
+                memset(wrq, 0, sizeof(*wrq));
+                wrq->wr_id  = kiblnd_ptr2wreqid(frwr, IBLND_WID_MR);
+                wrq->opcode = IB_WR_LOCAL_INV;
+                wrq->ex.invalidate_rkey = key;
+
+                /* new key, so a stale reference to the old one fails */
+                key = ib_inc_rkey(key);
+                ib_update_fast_reg_key(frwr->frwr_mr, key & 0xff);
+        }
+
+        wrq = &frwr->frwr_reg_wr;
+        memset(wrq, 0, sizeof(*wrq));
+        wrq->wr_id  = kiblnd_ptr2wreqid(frwr, IBLND_WID_MR);
+        wrq->opcode = IB_WR_FAST_REG_MR;
+        wrq->wr.fast_reg.iova_start    = pages[0];
+        wrq->wr.fast_reg.page_list     = frwr->frwr_frpl;
+        wrq->wr.fast_reg.page_list_len = npages;
+        wrq->wr.fast_reg.page_shift    = hdev->ibh_page_shift;
+        wrq->wr.fast_reg.length        = npages * hdev->ibh_page_size;
+        wrq->wr.fast_reg.rkey          = key;
+        wrq->wr.fast_reg.access_flags  = IB_ACCESS_LOCAL_WRITE |
+                                         IB_ACCESS_REMOTE_WRITE;
+
+        frwr->frwr_posted = 0;
+        *pp_frwr = frwr;
+        return 0;
+}
+
+/* Put the registration WRs of @frwr ahead of @wrq, unless they have been
+ * posted already (e.g. this is the PUT_DONE of an RDMA PUT) */
+struct ib_send_wr *
+kiblnd_frwr_chain(kib_frwr_t *frwr, struct ib_send_wr *wrq)
+{
+        if (frwr->frwr_posted)
+                return wrq;
+
+        frwr->frwr_reg_wr.next = wrq;
+        if (!frwr->frwr_inv)
+                return &frwr->frwr_reg_wr;
+
+        frwr->frwr_inv_wr.next = &frwr->frwr_reg_wr;
+        return &frwr->frwr_inv_wr;
+}
+
+static void
+kiblnd_destroy_frwr_pool(kib_pool_t *pool)
+{
+        kib_frwr_pool_t *fwpo = container_of(pool, kib_frwr_pool_t,
+                                             fwpo_pool);
+        kib_frwr_t      *frwr;
+
+        LASSERT (pool->po_allocated == 0);
+
+        while (!cfs_list_empty(&pool->po_free_list)) {
+                frwr = cfs_list_entry(pool->po_free_list.next,
+                                      kib_frwr_t, frwr_list);
+                cfs_list_del(&frwr->frwr_list);
+
+                if (frwr->frwr_mr != NULL)
+                        ib_dereg_mr(frwr->frwr_mr);
+
+                if (frwr->frwr_frpl != NULL)
+                        ib_free_fast_reg_page_list(frwr->frwr_frpl);
+
+                LIBCFS_FREE(frwr, sizeof(kib_frwr_t));
+        }
+
+        kiblnd_fini_pool(pool);
+        if (fwpo->fwpo_hdev != NULL)
+                kiblnd_hdev_decref(fwpo->fwpo_hdev);
+
+        LIBCFS_FREE(fwpo, sizeof(kib_frwr_pool_t));
+}
+
+static int
+kiblnd_create_frwr_pool(kib_poolset_t *ps, int size, kib_pool_t **pp_po)
+{
+	struct kib_frwr_pool	*fwpo;
+	struct kib_pool		*pool;
+	kib_hca_dev_t		*hdev;
+	kib_frwr_t		*frwr;
+	int			rc = 0;
+	int			i;
+
+	LIBCFS_CPT_ALLOC(fwpo, lnet_cpt_table(),
+			 ps->ps_cpt, sizeof(kib_frwr_pool_t));
+	if (fwpo == NULL) {
+		CERROR("Failed to allocate FRWR pool\n");
+		return -ENOMEM;
+	}
+
+	pool = &fwpo->fwpo_pool;
+	kiblnd_init_pool(ps, pool, size);
+
+	/* MRs belong to the PD of the HCA they are allocated on */
+	hdev = fwpo->fwpo_hdev = kiblnd_current_hdev(ps->ps_net->ibn_dev);
+
+	for (i = 0; i < size; i++) {
+		LIBCFS_CPT_ALLOC(frwr, lnet_cpt_table(),
+				 ps->ps_cpt, sizeof(kib_frwr_t));
+		if (frwr == NULL) {
+			rc = -ENOMEM;
+			break;
+		}
+
+		frwr->frwr_pool = fwpo;
+		cfs_list_add(&frwr->frwr_list, &pool->po_free_list);
+
+		frwr->frwr_frpl = ib_alloc_fast_reg_page_list(hdev->ibh_ibdev,
+							      IBLND_FRWR_PAGES);
+		if (IS_ERR(frwr->frwr_frpl)) {
+			rc = PTR_ERR(frwr->frwr_frpl);
+			frwr->frwr_frpl = NULL;
+			CERROR("Failed to allocate FRWR page list: %d\n", rc);
+			break;
+		}
+
+		frwr->frwr_mr = ib_alloc_fast_reg_mr(hdev->ibh_pd,
+						     IBLND_FRWR_PAGES);
+		if (IS_ERR(frwr->frwr_mr)) {
+			rc = PTR_ERR(frwr->frwr_mr);
+			frwr->frwr_mr = NULL;
+			CERROR("Failed to allocate FRWR MR: %d\n", rc);
+			break;
+		}
+	}
+
+	if (rc != 0) {
+		ps->ps_pool_destroy(pool);
+		return rc;
+	}
+
+	*pp_po = pool;
+	return 0;
+}
+
 static void
 kiblnd_destroy_tx_pool(kib_pool_t *pool)
 {
@@ -2200,6 +2430,7 @@ kiblnd_net_fini_pools(kib_net_t *net)
 
 	cfs_cpt_for_each(i, lnet_cpt_table()) {
 		kib_tx_poolset_t	*tps;
+		kib_frwr_poolset_t	*fwps;
 		kib_fmr_poolset_t	*fps;
 		kib_pmr_poolset_t	*pps;
 
@@ -2208,6 +2439,11 @@ kiblnd_net_fini_pools(kib_net_t *net)
 			kiblnd_fini_poolset(&tps->tps_poolset);
 		}
 
+		if (net->ibn_frwr_ps != NULL) {
+			fwps = net->ibn_frwr_ps[i];
+			kiblnd_fini_poolset(&fwps->fwps_poolset);
+		}
+
 		if (net->ibn_fmr_ps != NULL) {
 			fps = net->ibn_fmr_ps[i];
 			kiblnd_fini_fmr_poolset(fps);
@@ -2224,6 +2460,11 @@ kiblnd_net_fini_pools(kib_net_t *net)
 		net->ibn_tx_ps = NULL;
 	}
 
+	if (net->ibn_frwr_ps != NULL) {
+		cfs_percpt_free(net->ibn_frwr_ps);
+		net->ibn_frwr_ps = NULL;
+	}
+
 	if (net->ibn_fmr_ps != NULL) {
 		cfs_percpt_free(net->ibn_fmr_ps);
 		net->ibn_fmr_ps = NULL;
@@ -2239,6 +2480,7 @@ int
 kiblnd_net_init_pools(kib_net_t *net, __u32 *cpts, int ncpts)
 {
 	unsigned long	flags;
+	int		fastreg;
 	int		cpt;
 	int		rc;
 	int		i;
@@ -2251,6 +2493,7 @@ kiblnd_net_init_pools(kib_net_t *net, __u32 *cpts, int ncpts)
 		goto create_tx_pool;
 	}
 
+	fastreg = net->ibn_dev->ibd_hdev->ibh_fastreg;
 	read_unlock_irqrestore(&kiblnd_data.kib_global_lock, flags);
 
 	if (*kiblnd_tunables.kib_fmr_pool_size <
@@ -2269,6 +2512,48 @@ kiblnd_net_init_pools(kib_net_t *net, __u32 *cpts, int ncpts)
 	/* premapping can fail if ibd_nmr > 1, so we always create
 	 * FMR/PMR pool and map-on-demand if premapping failed */
 
+	if (!*kiblnd_tunables.kib_use_fastreg || !fastreg)
+		goto create_fmr_pool;
+
+	/* FRWR registers inline with the RDMA and never flushes, so
+	 * prefer it to FMR whenever the HCA can do it */
+	net->ibn_frwr_ps = cfs_percpt_alloc(lnet_cpt_table(),
+					    sizeof(kib_frwr_poolset_t));
+	if (net->ibn_frwr_ps == NULL) {
+		CERROR("Failed to allocate FRWR pool array\n");
+		rc = -ENOMEM;
+		goto failed;
+	}
+
+	for (i = 0; i < ncpts; i++) {
+		cpt = (cpts == NULL) ? i : cpts[i];
+		rc = kiblnd_init_poolset(&net->ibn_frwr_ps[cpt]->fwps_poolset,
+					 cpt, net, "FRWR",
+					 kiblnd_fmr_pool_size(ncpts),
+					 kiblnd_create_frwr_pool,
+					 kiblnd_destroy_frwr_pool, NULL, NULL);
+		if (rc != 0 && i == 0) /* can't use FRWR at all */
+			break;
+
+		if (rc != 0) {
+			CERROR("Can't initialize FRWR pool for CPT %d: %d\n",
+			       cpt, rc);
+			goto failed;
+		}
+	}
+
+	if (i > 0) {
+		LASSERT(i == ncpts);
+		goto create_tx_pool;
+	}
+
+	kiblnd_fini_poolset(&net->ibn_frwr_ps[cpt]->fwps_poolset);
+	cfs_percpt_free(net->ibn_frwr_ps);
+	net->ibn_frwr_ps = NULL;
+
+	CWARN("Failed to create FRWR pool: %d, falling back to FMR\n", rc);
+
+ create_fmr_pool:
 	net->ibn_fmr_ps = cfs_percpt_alloc(lnet_cpt_table(),
 					   sizeof(kib_fmr_poolset_t));
 	if (net->ibn_fmr_ps == NULL) {
@@ -2383,8 +2668,13 @@ kiblnd_hdev_get_attr(kib_hca_dev_t *hdev)
         }
 
         rc = ib_query_device(hdev->ibh_ibdev, attr);
-        if (rc == 0)
+        if (rc == 0) {
                 hdev->ibh_mr_size = attr->max_mr_size;
+                hdev->ibh_fastreg =
+                        (attr->device_cap_flags &
+                         IB_DEVICE_MEM_MGT_EXTENSIONS) != 0 &&
+                        attr->max_fast_reg_page_list_len >= IBLND_FRWR_PAGES;
+        }
 
         LIBCFS_FREE(attr, sizeof(*attr));
 
@@ -2702,7 +2992,11 @@ kiblnd_dev_failover(kib_dev_t *dev)
 			kiblnd_fail_poolset(&net->ibn_tx_ps[i]->tps_poolset,
 					    &zombie_tpo);
 
-			if (net->ibn_fmr_ps != NULL) {
+			if (net->ibn_frwr_ps != NULL) {
+				kiblnd_fail_poolset(&net->ibn_frwr_ps[i]->
+						    fwps_poolset, &zombie_ppo);
+
+			} else if (net->ibn_fmr_ps != NULL) {
 				kiblnd_fail_fmr_poolset(net->ibn_fmr_ps[i],
 							&zombie_fpo);
 
@@ -104,7 +104,8 @@ typedef struct
         int              *kib_map_on_demand;    /* map-on-demand if RD has more fragments
                                                  * than this value, 0 disable map-on-demand */
         int              *kib_pmr_pool_size;    /* # physical MR in pool */
-        int              *kib_fmr_pool_size;    /* # FMRs in pool */
+        int              *kib_use_fastreg;      /* prefer FRWR over FMR? */
+        int              *kib_fmr_pool_size;    /* # FMRs/FRWR MRs in pool */
         int              *kib_fmr_flush_trigger; /* When to trigger FMR flush */
         int              *kib_fmr_cache;        /* enable FMR pool cache? */
 #if defined(CONFIG_SYSCTL) && !CFS_SYSFS_MODULE_PARM
@@ -172,6 +173,8 @@ kiblnd_concurrent_sends_v1(void)
 #define IBLND_PMR_POOL			256
 #define IBLND_FMR_POOL			256
 #define IBLND_FMR_POOL_FLUSH		192
+/* max # pages one FRWR MR can register */
+#define IBLND_FRWR_PAGES		(LNET_MAX_PAYLOAD / PAGE_SIZE)
 
 /* TX messages (shared by all connections) */
 #define IBLND_TX_MSGS()            (*kiblnd_tunables.kib_ntx)
@@ -183,8 +186,10 @@ kiblnd_concurrent_sends_v1(void)
 
 /* WRs and CQEs (per connection) */
 #define IBLND_RECV_WRS(v)            IBLND_RX_MSGS(v)
-#define IBLND_SEND_WRS(v)          ((IBLND_RDMA_FRAGS(v) + 1) * IBLND_CONCURRENT_SENDS(v))
-#define IBLND_CQ_ENTRIES(v)         (IBLND_RECV_WRS(v) + IBLND_SEND_WRS(v))
+/* with FRWR (f != 0) each send may be preceded by an invalidate + register */
+#define IBLND_SEND_WRS(v, f)       ((IBLND_RDMA_FRAGS(v) + 1 + ((f) ? 2 : 0)) * \
+                                    IBLND_CONCURRENT_SENDS(v))
+#define IBLND_CQ_ENTRIES(v, f)      (IBLND_RECV_WRS(v) + IBLND_SEND_WRS(v, f))
 
 struct kib_hca_dev;
 
@@ -224,6 +229,7 @@ typedef struct kib_hca_dev
         int                  ibh_nmrs;          /* # of global MRs */
         struct ib_mr       **ibh_mrs;           /* global MR */
         struct ib_pd        *ibh_pd;            /* PD */
+        int                  ibh_fastreg;       /* HCA supports FRWR */
         kib_dev_t           *ibh_dev;           /* owner */
         cfs_atomic_t         ibh_ref;           /* refcount */
 } kib_hca_dev_t;
@@ -313,6 +319,30 @@ typedef struct kib_pmr_pool {
         kib_pool_t              ppo_pool;               /* pool */
 } kib_pmr_pool_t;
 
+typedef struct {
+        kib_poolset_t           fwps_poolset;           /* pool-set */
+} kib_frwr_poolset_t;
+
+typedef struct kib_frwr_pool {
+        struct kib_hca_dev     *fwpo_hdev;              /* device for this pool */
+        kib_pool_t              fwpo_pool;              /* pool */
+} kib_frwr_pool_t;
+
+/* Fast registration MR.  It is (re)registered by work requests posted
+ * ahead of the message or RDMA that uses it, so returning it to the pool
+ * needs no flush; the next user invalidates the old key inline instead. */
+typedef struct {
+        cfs_list_t              frwr_list;              /* chain node */
+        struct kib_frwr_pool   *frwr_pool;              /* owner of this MR */
+        struct ib_mr           *frwr_mr;                /* IB MR */
+        struct ib_fast_reg_page_list *frwr_frpl;        /* pages to register */
+        struct ib_send_wr       frwr_inv_wr;            /* invalidate old key */
+        struct ib_send_wr       frwr_reg_wr;            /* register new key */
+        int                     frwr_valid;             /* registered on HCA */
+        int                     frwr_inv;               /* frwr_inv_wr needed */
+        int                     frwr_posted;            /* WRs posted */
+} kib_frwr_t;
+
 typedef struct
 {
 	spinlock_t		fps_lock;		/* serialize */
@@ -356,6 +386,7 @@ typedef struct kib_net
 	cfs_atomic_t		ibn_nconns;	/* # connections extant */
 
 	kib_tx_poolset_t	**ibn_tx_ps;	/* tx pool-set */
+	kib_frwr_poolset_t	**ibn_frwr_ps;	/* frwr pool-set */
 	kib_fmr_poolset_t	**ibn_fmr_ps;	/* fmr pool-set */
 	kib_pmr_poolset_t	**ibn_pmr_ps;	/* pmr pool-set */
 
@@ -578,6 +609,7 @@ typedef struct kib_tx                           /* transmit message */
         __u64                    *tx_pages;     /* rdma phys page addrs */
         union {
                 kib_phys_mr_t      *pmr;        /* MR for physical buffer */
+                kib_frwr_t         *frwr;       /* fast registration MR */
                 kib_fmr_t           fmr;        /* FMR */
         }                         tx_u;
         int                       tx_dmadir;    /* dma direction */
@@ -826,6 +858,7 @@ kiblnd_queue2str (kib_conn_t *conn, cfs_list_t *q)
 #define IBLND_WID_TX    0
 #define IBLND_WID_RDMA  1
 #define IBLND_WID_RX    2
+#define IBLND_WID_MR    3
 #define IBLND_WID_MASK  3UL
 
 static inline __u64
@@ -1054,6 +1087,12 @@ int  kiblnd_pmr_pool_map(kib_pmr_poolset_t *pps, kib_hca_dev_t *hdev,
                          kib_rdma_desc_t *rd, __u64 *iova, kib_phys_mr_t **pp_pmr);
 void kiblnd_pmr_pool_unmap(kib_phys_mr_t *pmr);
 
+int  kiblnd_frwr_pool_map(kib_frwr_poolset_t *fwps, kib_hca_dev_t *hdev,
+                          kib_rdma_desc_t *rd, int nob, kib_frwr_t **pp_frwr);
+void kiblnd_frwr_pool_unmap(kib_frwr_t *frwr, int status);
+struct ib_send_wr *kiblnd_frwr_chain(kib_frwr_t *frwr,
+                                     struct ib_send_wr *wrq);
+
 int  kiblnd_startup (lnet_ni_t *ni);
 void kiblnd_shutdown (lnet_ni_t *ni);
 int  kiblnd_ctl (lnet_ni_t *ni, unsigned int cmd, void *arg);
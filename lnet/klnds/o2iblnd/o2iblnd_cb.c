@@ -593,6 +593,43 @@ kiblnd_fmr_map_tx(kib_net_t *net, kib_tx_t *tx, kib_rdma_desc_t *rd, int nob)
         return 0;
 }
 
+static int
+kiblnd_frwr_map_tx(kib_net_t *net, kib_tx_t *tx, kib_rdma_desc_t *rd, int nob)
+{
+	kib_hca_dev_t		*hdev;
+	kib_frwr_poolset_t	*fwps;
+	kib_frwr_t		*frwr;
+	int			cpt;
+	int			rc;
+
+	LASSERT(tx->tx_pool != NULL);
+	LASSERT(tx->tx_pool->tpo_pool.po_owner != NULL);
+
+	hdev = tx->tx_pool->tpo_hdev;
+	cpt = tx->tx_pool->tpo_pool.po_owner->ps_cpt;
+
+	fwps = net->ibn_frwr_ps[cpt];
+	rc = kiblnd_frwr_pool_map(fwps, hdev, rd, nob, &tx->tx_u.frwr);
+	if (rc != 0) {
+		CERROR("Can't register %d frags by FRWR: %d\n",
+		       rd->rd_nfrags, rc);
+		return rc;
+	}
+
+	frwr = tx->tx_u.frwr;
+	/* The registration WRs go out ahead of this tx's work items (see
+	 * kiblnd_post_tx_locked()); the region starts at the first page,
+	 * so the first fragment's address is still valid within it.
+	 * If rd is not tx_rd, it's going to get sent to a peer, who will
+	 * need the rkey */
+	rd->rd_key = (rd != tx->tx_rd) ? frwr->frwr_mr->rkey :
+					 frwr->frwr_mr->lkey;
+	rd->rd_frags[0].rf_nob = nob;
+	rd->rd_nfrags = 1;
+
+	return 0;
+}
+
 static int
 kiblnd_pmr_map_tx(kib_net_t *net, kib_tx_t *tx, kib_rdma_desc_t *rd, int nob)
 {
@@ -636,7 +673,11 @@ kiblnd_unmap_tx(lnet_ni_t *ni, kib_tx_t *tx)
 
 	LASSERT(net != NULL);
 
-	if (net->ibn_fmr_ps != NULL && tx->tx_u.fmr.fmr_pfmr != NULL) {
+	if (net->ibn_frwr_ps != NULL && tx->tx_u.frwr != NULL) {
+		kiblnd_frwr_pool_unmap(tx->tx_u.frwr, tx->tx_status);
+		tx->tx_u.frwr = NULL;
+
+	} else if (net->ibn_fmr_ps != NULL && tx->tx_u.fmr.fmr_pfmr != NULL) {
 		kiblnd_fmr_pool_unmap(&tx->tx_u.fmr, tx->tx_status);
 		tx->tx_u.fmr.fmr_pfmr = NULL;
 
@@ -687,7 +728,9 @@ kiblnd_map_tx(lnet_ni_t *ni, kib_tx_t *tx,
                 return 0;
         }
 
-	if (net->ibn_fmr_ps != NULL)
+	if (net->ibn_frwr_ps != NULL)
+		return kiblnd_frwr_map_tx(net, tx, rd, nob);
+	else if (net->ibn_fmr_ps != NULL)
 		return kiblnd_fmr_map_tx(net, tx, rd, nob);
 	else if (net->ibn_pmr_ps != NULL)
 		return kiblnd_pmr_map_tx(net, tx, rd, nob);
@@ -794,9 +837,11 @@ kiblnd_post_tx_locked (kib_conn_t *conn, kib_tx_t *tx, int credit)
 {
         kib_msg_t         *msg = tx->tx_msg;
         kib_peer_t        *peer = conn->ibc_peer;
+        kib_net_t         *net = peer->ibp_ni->ni_data;
         int                ver = conn->ibc_version;
         int                rc;
         int                done;
+        struct ib_send_wr *wrq = tx->tx_wrq;
         struct ib_send_wr *bad_wrq;
 
         LASSERT (tx->tx_queued);
@@ -877,8 +922,14 @@ kiblnd_post_tx_locked (kib_conn_t *conn, kib_tx_t *tx, int credit)
                 /* close_conn will launch failover */
                 rc = -ENETDOWN;
         } else {
-                rc = ib_post_send(conn->ibc_cmid->qp,
-                                  tx->tx_wrq, &bad_wrq);
+                /* register the tx's buffer inline, ahead of its RDMA or
+                 * the message that hands the key to the peer */
+                if (net->ibn_frwr_ps != NULL && tx->tx_u.frwr != NULL)
+                        wrq = kiblnd_frwr_chain(tx->tx_u.frwr, wrq);
+
+                rc = ib_post_send(conn->ibc_cmid->qp, wrq, &bad_wrq);
+                if (rc == 0 && wrq != tx->tx_wrq)
+                        tx->tx_u.frwr->frwr_posted = 1;
         }
 
         conn->ibc_last_send = jiffies;
@@ -3268,6 +3319,13 @@ kiblnd_complete (struct ib_wc *wc)
                         kiblnd_wreqid2ptr(wc->wr_id), wc->status);
                 return;
 
+        case IBLND_WID_MR:
+                /* FRWR work items are unsignalled too, so this is a
+                 * failure; the tx's SEND fails and closes the conn */
+                CNETERR("FastReg (frwr: %p) failed: %d\n",
+                        kiblnd_wreqid2ptr(wc->wr_id), wc->status);
+                return;
+
         case IBLND_WID_TX:
                 kiblnd_tx_complete(kiblnd_wreqid2ptr(wc->wr_id), wc->status);
                 return;
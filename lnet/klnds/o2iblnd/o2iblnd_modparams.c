@@ -112,10 +112,15 @@ static int map_on_demand = 0;
 CFS_MODULE_PARM(map_on_demand, "i", int, 0444,
                 "map on demand");
 
+static int use_fastreg = 1;
+CFS_MODULE_PARM(use_fastreg, "i", int, 0444,
+		"use fast registration work requests instead of FMR "
+		"when the HCA supports them");
+
 /* NB: this value is shared by all CPTs, it can grow at runtime */
 static int fmr_pool_size = 512;
 CFS_MODULE_PARM(fmr_pool_size, "i", int, 0444,
-		"size of fmr pool on each CPT (>= ntx / 4)");
+		"size of fmr/frwr pool on each CPT (>= ntx / 4)");
 
 /* NB: this value is shared by all CPTs, it can grow at runtime */
 static int fmr_flush_trigger = 384;
@@ -167,6 +172,7 @@ kib_tunables_t kiblnd_tunables = {
         .kib_concurrent_sends       = &concurrent_sends,
         .kib_ib_mtu                 = &ib_mtu,
         .kib_map_on_demand          = &map_on_demand,
+        .kib_use_fastreg            = &use_fastreg,
         .kib_fmr_pool_size          = &fmr_pool_size,
         .kib_fmr_flush_trigger      = &fmr_flush_trigger,
         .kib_fmr_cache              = &fmr_cache,
@@ -203,7 +209,8 @@ enum {
         O2IBLND_FMR_FLUSH_TRIGGER,
         O2IBLND_FMR_CACHE,
         O2IBLND_PMR_POOL_SIZE,
-        O2IBLND_DEV_FAILOVER
+        O2IBLND_DEV_FAILOVER,
+        O2IBLND_USE_FASTREG
 };
 #else
 
@@ -228,6 +235,7 @@ enum {
 #define O2IBLND_FMR_CACHE        CTL_UNNUMBERED
 #define O2IBLND_PMR_POOL_SIZE    CTL_UNNUMBERED
 #define O2IBLND_DEV_FAILOVER     CTL_UNNUMBERED
+#define O2IBLND_USE_FASTREG      CTL_UNNUMBERED
 
 #endif
 
@@ -401,6 +409,14 @@ static cfs_sysctl_table_t kiblnd_ctl_table[] = {
                 .mode     = 0444,
                 .proc_handler = &proc_dointvec
         },
+        {
+                .ctl_name = O2IBLND_USE_FASTREG,
+                .procname = "use_fastreg",
+                .data     = &use_fastreg,
+                .maxlen   = sizeof(int),
+                .mode     = 0444,
+                .proc_handler = &proc_dointvec
+        },
         {0}
 };
 
@@ -84,6 +84,8 @@ ksocknal_create_route (__u32 ipaddr, int port)
         route->ksnr_deleted = 0;
         route->ksnr_conn_count = 0;
         route->ksnr_share_count = 0;
+        memset(route->ksnr_nconns, 0, sizeof(route->ksnr_nconns));
+        memset(route->ksnr_max_nconns, 0, sizeof(route->ksnr_max_nconns));
 
         return (route);
 }
@@ -358,7 +360,11 @@ ksocknal_associate_route_conn_locked(ksock_route_t *route, ksock_conn_t *conn)
                         iface->ksni_nroutes++;
         }
 
-        route->ksnr_connected |= (1<<type);
+        /* a type only counts as connected once all the sockets it
+         * stripes over are up */
+        route->ksnr_nconns[type]++;
+        if (route->ksnr_nconns[type] >= ksocknal_conns_wanted(route, type))
+                route->ksnr_connected |= (1<<type);
         route->ksnr_conn_count++;
 
         /* Successful connection => further attempts can
@@ -1203,6 +1209,18 @@ ksocknal_create_conn (lnet_ni_t *ni, ksock_route_t *route,
         case 0:
                 break;
         case EALREADY:
+                /* The peer refused another socket of a type it already has
+                 * from me while not connecting to me itself, e.g. it
+                 * doesn't stripe bulk connections: make do with those
+                 * rather than reconnecting forever. */
+                if (active && peer->ksnp_accepting == 0 &&
+                    route->ksnr_nconns[conn->ksnc_type] > 0) {
+                        route->ksnr_max_nconns[conn->ksnc_type] =
+                                route->ksnr_nconns[conn->ksnc_type];
+                        route->ksnr_connected |= (1 << conn->ksnc_type);
+                        warn = "peer has enough conns";
+                        goto failed_2;
+                }
                 warn = "lost conn race";
                 goto failed_2;
         case EPROTO:
@@ -1211,8 +1229,22 @@ ksocknal_create_conn (lnet_ni_t *ni, ksock_route_t *route,
         }
 
         /* Refuse to duplicate an existing connection, unless this is a
-         * loopback connection */
+         * loopback connection.  Bulk connections may be striped, so only
+         * refuse those once we already have as many as wanted; the peer
+         * decides how many it opens to me, bounded by the hard limit. */
         if (conn->ksnc_ipaddr != conn->ksnc_myipaddr) {
+                int     nconns = 0;
+                int     limit;
+
+                if (active)
+                        limit = ksocknal_conns_wanted(route,
+                                                      conn->ksnc_type);
+                else if (conn->ksnc_type == SOCKLND_CONN_BULK_IN ||
+                         conn->ksnc_type == SOCKLND_CONN_BULK_OUT)
+                        limit = SOCKNAL_CONNS_PER_PEER_MAX;
+                else
+                        limit = 1;
+
                 cfs_list_for_each(tmp, &peer->ksnp_conns) {
                         conn2 = cfs_list_entry(tmp, ksock_conn_t, ksnc_list);
 
@@ -1221,6 +1253,9 @@ ksocknal_create_conn (lnet_ni_t *ni, ksock_route_t *route,
                             conn2->ksnc_type != conn->ksnc_type)
                                 continue;
 
+                        if (++nconns < limit)
+                                continue;
+
                         /* Reply on a passive connection attempt so the peer
                          * realises we're connected. */
                         LASSERT (rc == 0);
@@ -1262,6 +1297,20 @@ ksocknal_create_conn (lnet_ni_t *ni, ksock_route_t *route,
         peer->ksnp_send_keepalive = 0;
         peer->ksnp_error = 0;
 
+        /* run the connection on the CPT local to the NIC it uses, if
+         * that CPT has schedulers, so its softirq and socket callbacks
+         * stay on one NUMA node */
+        if (*ksocknal_tunables.ksnd_nic_cpt_affinity) {
+                ksock_interface_t *iface;
+
+                iface = ksocknal_ip2iface(ni, conn->ksnc_myipaddr);
+                if (iface != NULL && iface->ksni_cpt >= 0 &&
+                    iface->ksni_cpt < cfs_cpt_number(lnet_cpt_table()) &&
+                    ksocknal_data.ksnd_sched_info[iface->ksni_cpt]->
+                    ksi_nthreads > 0)
+                        cpt = iface->ksni_cpt;
+        }
+
 	sched = ksocknal_choose_scheduler_locked(cpt);
         sched->kss_nconns++;
         conn->ksnc_scheduler = sched;
@@ -1411,8 +1460,6 @@ ksocknal_close_conn_locked (ksock_conn_t *conn, int error)
          * Caller holds ksnd_global_lock exclusively in irq context */
         ksock_peer_t      *peer = conn->ksnc_peer;
         ksock_route_t     *route;
-        ksock_conn_t      *conn2;
-        cfs_list_t        *tmp;
 
         LASSERT (peer->ksnp_error == 0);
         LASSERT (!conn->ksnc_closing);
@@ -1425,20 +1472,16 @@ ksocknal_close_conn_locked (ksock_conn_t *conn, int error)
         if (route != NULL) {
                 /* dissociate conn from route... */
                 LASSERT (!route->ksnr_deleted);
-                LASSERT ((route->ksnr_connected & (1 << conn->ksnc_type)) != 0);
-
-                conn2 = NULL;
-                cfs_list_for_each(tmp, &peer->ksnp_conns) {
-                        conn2 = cfs_list_entry(tmp, ksock_conn_t, ksnc_list);
-
-                        if (conn2->ksnc_route == route &&
-                            conn2->ksnc_type == conn->ksnc_type)
-                                break;
+                LASSERT (route->ksnr_nconns[conn->ksnc_type] > 0);
 
-                        conn2 = NULL;
-                }
-                if (conn2 == NULL)
+                /* reconnect as soon as a stripe is lost */
+                route->ksnr_nconns[conn->ksnc_type]--;
+                if (route->ksnr_nconns[conn->ksnc_type] <
+                    ksocknal_conns_wanted(route, conn->ksnc_type))
                         route->ksnr_connected &= ~(1 << conn->ksnc_type);
+                /* the peer may accept more once reconnected */
+                if (route->ksnr_nconns[conn->ksnc_type] == 0)
+                        route->ksnr_max_nconns[conn->ksnc_type] = 0;
 
                 conn->ksnc_route = NULL;
 
@@ -1971,6 +2014,7 @@ ksocknal_add_interface(lnet_ni_t *ni, __u32 ipaddress, __u32 netmask)
                 iface->ksni_netmask = netmask;
                 iface->ksni_nroutes = 0;
                 iface->ksni_npeers = 0;
+                iface->ksni_cpt = CFS_CPT_ANY; /* no name to look up */
 
                 for (i = 0; i < ksocknal_data.ksnd_peer_hash_size; i++) {
                         cfs_list_for_each(ptmp, &ksocknal_data.ksnd_peers[i]) {
@@ -2829,6 +2873,11 @@ ksocknal_startup (lnet_ni_t *ni)
 		net->ksnn_ninterfaces = i;
 	}
 
+	for (i = 0; i < net->ksnn_ninterfaces; i++) {
+		net->ksnn_interfaces[i].ksni_cpt =
+			ksocknal_lib_iface_cpt(net->ksnn_interfaces[i].ksni_name);
+	}
+
 	/* call it before add it to ksocknal_data.ksnd_nets */
 	rc = ksocknal_net_start_threads(net, ni->ni_cpts, ni->ni_ncpts);
 	if (rc != 0)
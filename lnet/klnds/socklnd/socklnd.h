@@ -48,6 +48,7 @@
 #define SOCKNAL_RESCHED         100             /* # scheduler loops before reschedule */
 #define SOCKNAL_INSANITY_RECONN 5000            /* connd is trying on reconn infinitely */
 #define SOCKNAL_ENOMEM_RETRY    CFS_TICK        /* jiffies between retries */
+#define SOCKNAL_CONNS_PER_PEER_MAX 16           /* max bulk conns per direction */
 
 #define SOCKNAL_SINGLE_FRAG_TX      0           /* disable multi-fragment sends */
 #define SOCKNAL_SINGLE_FRAG_RX      0           /* disable multi-fragment receives */
@@ -102,6 +103,7 @@ typedef struct                                  /* in-use interface */
 	__u32		ksni_netmask;		/* interface's network mask */
 	int		ksni_nroutes;		/* # routes using (active) */
 	int		ksni_npeers;		/* # peers using (passive) */
+	int		ksni_cpt;		/* CPT local to the NIC */
 	char		ksni_name[IFNAMSIZ];	/* interface name */
 } ksock_interface_t;
 
@@ -117,6 +119,8 @@ typedef struct
         int              *ksnd_max_reconnectms; /* ...exponentially increasing to this */
         int              *ksnd_eager_ack;       /* make TCP ack eagerly? */
         int              *ksnd_typed_conns;     /* drive sockets by type? */
+        int              *ksnd_conns_per_peer;  /* # bulk conns per direction */
+        int              *ksnd_nic_cpt_affinity; /* schedule conns on NIC's CPT? */
         int              *ksnd_min_bulk;        /* smallest "large" message */
         int              *ksnd_tx_buffer_size;  /* socket tx buffer size */
         int              *ksnd_rx_buffer_size;  /* socket rx buffer size */
@@ -354,6 +358,8 @@ typedef struct ksock_route
         unsigned int          ksnr_deleted:1;   /* been removed from peer? */
         unsigned int          ksnr_share_count; /* created explicitly? */
         int                   ksnr_conn_count;  /* # conns established by this route */
+        int                   ksnr_nconns[SOCKLND_CONN_NTYPES]; /* # conns by type */
+        int                   ksnr_max_nconns[SOCKLND_CONN_NTYPES]; /* peer's limit, 0 if unknown */
 } ksock_route_t;
 
 #define SOCKNAL_KEEPALIVE_PING          1       /* cookie for keepalive ping */
@@ -437,6 +443,24 @@ ksocknal_route_mask(void)
                 (1 << SOCKLND_CONN_BULK_OUT));
 }
 
+/* # connections of this type a route should establish; bulk traffic
+ * is striped over several sockets to use more than one TCP stream, as
+ * far as the peer accepts them */
+static inline int
+ksocknal_conns_wanted(ksock_route_t *route, int type)
+{
+        int wanted = 1;
+
+        if (type == SOCKLND_CONN_BULK_IN ||
+            type == SOCKLND_CONN_BULK_OUT)
+                wanted = *ksocknal_tunables.ksnd_conns_per_peer;
+
+        if (route->ksnr_max_nconns[type] != 0)
+                wanted = MIN(wanted, route->ksnr_max_nconns[type]);
+
+        return wanted;
+}
+
 static inline cfs_list_t *
 ksocknal_nid2peerlist (lnet_nid_t nid)
 {
@@ -621,3 +645,4 @@ extern void ksocknal_lib_csum_tx(ksock_tx_t *tx);
 
 extern int ksocknal_lib_memory_pressure(ksock_conn_t *conn);
 extern int ksocknal_lib_bind_thread_to_cpu(int id);
+extern int ksocknal_lib_iface_cpt(char *name);
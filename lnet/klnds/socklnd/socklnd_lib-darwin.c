@@ -1076,3 +1076,9 @@ ksocknal_lib_reset_callback(struct socket *sock, ksock_conn_t *conn)
 }
 
 #endif  /* !__DARWIN8__ */
+
+int
+ksocknal_lib_iface_cpt(char *name)
+{
+        return CFS_CPT_ANY;
+}
@@ -1182,3 +1182,43 @@ ksocknal_lib_memory_pressure(ksock_conn_t *conn)
 
 	return rc;
 }
+
+/* CPT of the NUMA node the NIC hangs off, which is where its interrupts
+ * are normally steered; CFS_CPT_ANY if that can't be worked out */
+int
+ksocknal_lib_iface_cpt(char *name)
+{
+	struct net_device *dev;
+	char		   ifnam[IFNAMSIZ];
+	char		  *colon;
+	int		   node;
+	int		   cpu;
+
+	/* an alias (e.g. eth0:1) shares its device with the base name */
+	strncpy(ifnam, name, IFNAMSIZ);
+	ifnam[IFNAMSIZ - 1] = 0;
+	colon = strchr(ifnam, ':');
+	if (colon != NULL)
+		*colon = 0;
+
+#ifdef HAVE_DEV_GET_BY_NAME_2ARG
+	dev = dev_get_by_name(&init_net, ifnam);
+#else
+	dev = dev_get_by_name(ifnam);
+#endif
+	if (dev == NULL)
+		return CFS_CPT_ANY;
+
+	node = dev_to_node(&dev->dev);
+	dev_put(dev);
+
+	if (node < 0)
+		return CFS_CPT_ANY;
+
+	for_each_online_cpu(cpu) {
+		if (cpu_to_node(cpu) == node)
+			return cfs_cpt_of_cpu(lnet_cpt_table(), cpu);
+	}
+
+	return CFS_CPT_ANY;
+}
@@ -678,3 +678,9 @@ ksocknal_lib_bind_thread_to_cpu(int id)
 {
         return 0;
 }
+
+int
+ksocknal_lib_iface_cpt(char *name)
+{
+        return CFS_CPT_ANY;
+}
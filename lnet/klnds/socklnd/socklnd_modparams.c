@@ -76,6 +76,14 @@ static int typed_conns = 1;
 CFS_MODULE_PARM(typed_conns, "i", int, 0444,
                 "use different sockets for bulk");
 
+static int conns_per_peer = 1;
+CFS_MODULE_PARM(conns_per_peer, "i", int, 0444,
+                "# bulk connections of each direction per peer");
+
+static int nic_cpt_affinity = 0;
+CFS_MODULE_PARM(nic_cpt_affinity, "i", int, 0644,
+                "schedule connections on the CPT local to their NIC");
+
 static int min_bulk = (1<<10);
 CFS_MODULE_PARM(min_bulk, "i", int, 0644,
                 "smallest 'large' message");
@@ -181,6 +189,8 @@ int ksocknal_tunables_init(void)
         ksocknal_tunables.ksnd_max_reconnectms    = &max_reconnectms;
         ksocknal_tunables.ksnd_eager_ack          = &eager_ack;
         ksocknal_tunables.ksnd_typed_conns        = &typed_conns;
+        ksocknal_tunables.ksnd_conns_per_peer     = &conns_per_peer;
+        ksocknal_tunables.ksnd_nic_cpt_affinity   = &nic_cpt_affinity;
         ksocknal_tunables.ksnd_min_bulk           = &min_bulk;
         ksocknal_tunables.ksnd_tx_buffer_size     = &tx_buffer_size;
         ksocknal_tunables.ksnd_rx_buffer_size     = &rx_buffer_size;
@@ -227,6 +237,12 @@ int ksocknal_tunables_init(void)
         if (*ksocknal_tunables.ksnd_zc_min_payload < (2 << 10))
                 *ksocknal_tunables.ksnd_zc_min_payload = (2 << 10);
 
+        if (*ksocknal_tunables.ksnd_conns_per_peer < 1)
+                *ksocknal_tunables.ksnd_conns_per_peer = 1;
+        if (*ksocknal_tunables.ksnd_conns_per_peer > SOCKNAL_CONNS_PER_PEER_MAX)
+                *ksocknal_tunables.ksnd_conns_per_peer =
+                        SOCKNAL_CONNS_PER_PEER_MAX;
+
         /* initialize platform-sepcific tunables */
         return ksocknal_lib_tunables_init();
 };
@@ -921,6 +921,43 @@ lnet_msg2bufpool(lnet_msg_t *msg)
 	return rbp;
 }
 
+/* Messages blocking for a router buffer queue on their source peer, and
+ * the peer queues on the pool, so the pool serves blocked peers
+ * round-robin and one bursty peer can't starve everyone else */
+static void
+lnet_rtrbuf_block_locked(lnet_rtrbufpool_t *rbp, lnet_msg_t *msg)
+{
+	lnet_peer_rtrbufq_t	*lpq;
+
+	lpq = &msg->msg_rxpeer->lp_rtrbufq[rbp -
+					   the_lnet.ln_rtrpools[msg->msg_rx_cpt]];
+	if (cfs_list_empty(&lpq->lpq_msgs))
+		cfs_list_add_tail(&lpq->lpq_list, &rbp->rbp_peers);
+
+	cfs_list_add_tail(&msg->msg_list, &lpq->lpq_msgs);
+}
+
+static lnet_msg_t *
+lnet_rtrbuf_unblock_locked(lnet_rtrbufpool_t *rbp)
+{
+	lnet_peer_rtrbufq_t	*lpq;
+	lnet_msg_t		*msg;
+
+	LASSERT(!cfs_list_empty(&rbp->rbp_peers));
+
+	lpq = cfs_list_entry(rbp->rbp_peers.next,
+			     lnet_peer_rtrbufq_t, lpq_list);
+	msg = cfs_list_entry(lpq->lpq_msgs.next, lnet_msg_t, msg_list);
+	cfs_list_del(&msg->msg_list);
+
+	/* this peer goes to the back of the line */
+	cfs_list_del(&lpq->lpq_list);
+	if (!cfs_list_empty(&lpq->lpq_msgs))
+		cfs_list_add_tail(&lpq->lpq_list, &rbp->rbp_peers);
+
+	return msg;
+}
+
 int
 lnet_post_routed_recv_locked (lnet_msg_t *msg, int do_recv)
 {
@@ -963,18 +1000,20 @@ lnet_post_routed_recv_locked (lnet_msg_t *msg, int do_recv)
 
         if (!msg->msg_rtrcredit) {
                 LASSERT ((rbp->rbp_credits < 0) ==
-                         !cfs_list_empty(&rbp->rbp_msgs));
+                         !cfs_list_empty(&rbp->rbp_peers));
 
                 msg->msg_rtrcredit = 1;
                 rbp->rbp_credits--;
                 if (rbp->rbp_credits < rbp->rbp_mincredits)
                         rbp->rbp_mincredits = rbp->rbp_credits;
+                if (rbp->rbp_credits < rbp->rbp_lwcredits)
+                        rbp->rbp_lwcredits = rbp->rbp_credits;
 
                 if (rbp->rbp_credits < 0) {
                         /* must have checked eager_recv before here */
 			LASSERT(msg->msg_rx_ready_delay);
 			msg->msg_rx_delayed = 1;
-                        cfs_list_add_tail(&msg->msg_list, &rbp->rbp_msgs);
+			lnet_rtrbuf_block_locked(rbp, msg);
                         return EAGAIN;
                 }
         }
@@ -996,6 +1035,29 @@ lnet_post_routed_recv_locked (lnet_msg_t *msg, int do_recv)
 	}
 	return 0;
 }
+
+/* Give router buffer @rb (back) to its pool and let the next blocked
+ * message have it.  NB may drop and retake lnet_net_lock(@cpt) */
+void
+lnet_rtrbuf_release_locked(lnet_rtrbuf_t *rb, int cpt)
+{
+	lnet_rtrbufpool_t	*rbp = rb->rb_pool;
+	lnet_msg_t		*msg;
+
+	LASSERT((rbp->rbp_credits < 0) ==
+		!cfs_list_empty(&rbp->rbp_peers));
+	LASSERT((rbp->rbp_credits > 0) ==
+		!cfs_list_empty(&rbp->rbp_bufs));
+
+	cfs_list_add(&rb->rb_list, &rbp->rbp_bufs);
+	rbp->rbp_credits++;
+	if (rbp->rbp_credits <= 0) {
+		msg = lnet_rtrbuf_unblock_locked(rbp);
+		LASSERT(msg->msg_rx_cpt == cpt);
+
+		(void) lnet_post_routed_recv_locked(msg, 1);
+	}
+}
 #endif
 
 void
@@ -1068,9 +1130,9 @@ lnet_return_rx_credits_locked(lnet_msg_t *msg)
                 lnet_rtrbuf_t     *rb;
                 lnet_rtrbufpool_t *rbp;
 
-                /* NB If a msg ever blocks for a buffer in rbp_msgs, it stays
-                 * there until it gets one allocated, or aborts the wait
-                 * itself */
+                /* NB If a msg ever blocks for a buffer in rbp_peers, it
+                 * stays there until it gets one allocated, or aborts the
+                 * wait itself */
                 LASSERT (msg->msg_kiov != NULL);
 
                 rb = cfs_list_entry(msg->msg_kiov, lnet_rtrbuf_t, rb_kiov[0]);
@@ -1080,20 +1142,7 @@ lnet_return_rx_credits_locked(lnet_msg_t *msg)
                 msg->msg_kiov = NULL;
                 msg->msg_rtrcredit = 0;
 
-                LASSERT((rbp->rbp_credits < 0) ==
-                        !cfs_list_empty(&rbp->rbp_msgs));
-                LASSERT((rbp->rbp_credits > 0) ==
-                        !cfs_list_empty(&rbp->rbp_bufs));
-
-                cfs_list_add(&rb->rb_list, &rbp->rbp_bufs);
-                rbp->rbp_credits++;
-                if (rbp->rbp_credits <= 0) {
-                        msg2 = cfs_list_entry(rbp->rbp_msgs.next,
-                                              lnet_msg_t, msg_list);
-                        cfs_list_del(&msg2->msg_list);
-
-                        (void) lnet_post_routed_recv_locked(msg2, 1);
-                }
+                lnet_rtrbuf_release_locked(rb, msg->msg_rx_cpt);
         }
 
         if (msg->msg_peerrtrcredit) {
@@ -1122,6 +1171,20 @@ lnet_return_rx_credits_locked(lnet_msg_t *msg)
         }
 }
 
+/* Each pick of a route advances its lr_seq by a stride that grows with the
+ * gateway's smoothed ping RTT, so among otherwise equal routes a gateway
+ * gets a share of traffic inversely proportional to its latency */
+#define LNET_ROUTE_RTT_QUANTUM	1000	/* usecs of RTT per unit of stride */
+#define LNET_ROUTE_STRIDE_MAX	64
+
+static inline int
+lnet_route_stride(lnet_route_t *rtr)
+{
+	return min(1 + (int)(rtr->lr_gateway->lp_ping_rtt /
+			     LNET_ROUTE_RTT_QUANTUM),
+		   LNET_ROUTE_STRIDE_MAX);
+}
+
 static int
 lnet_compare_routes(lnet_route_t *r1, lnet_route_t *r2)
 {
@@ -1134,16 +1197,20 @@ lnet_compare_routes(lnet_route_t *r1, lnet_route_t *r2)
 	if (r1->lr_hops > r2->lr_hops)
 		return -1;
 
-	if (p1->lp_txqnob < p2->lp_txqnob)
+	/* only whole MTUs of queued data count as congestion; smaller
+	 * differences come and go and shouldn't override the weighting */
+	if ((p1->lp_txqnob >> LNET_MTU_BITS) <
+	    (p2->lp_txqnob >> LNET_MTU_BITS))
 		return 1;
 
-	if (p1->lp_txqnob > p2->lp_txqnob)
+	if ((p1->lp_txqnob >> LNET_MTU_BITS) >
+	    (p2->lp_txqnob >> LNET_MTU_BITS))
 		return -1;
 
-	if (p1->lp_txcredits > p2->lp_txcredits)
+	if (p1->lp_txcredits > 0 && p2->lp_txcredits <= 0)
 		return 1;
 
-	if (p1->lp_txcredits < p2->lp_txcredits)
+	if (p1->lp_txcredits <= 0 && p2->lp_txcredits > 0)
 		return -1;
 
 	if (r1->lr_seq - r2->lr_seq <= 0)
@@ -1204,11 +1271,19 @@ lnet_find_route_locked(lnet_ni_t *ni, lnet_nid_t target, lnet_nid_t rtr_nid)
 		lp_best = lp;
 	}
 
-	/* set sequence number on the best router to the latest sequence + 1
-	 * so we can round-robin all routers, it's race and inaccurate but
-	 * harmless and functional  */
-	if (rtr_best != NULL)
-		rtr_best->lr_seq = rtr_last->lr_seq + 1;
+	/* advance the best router's sequence by its stride so routers take
+	 * turns weighted by RTT; a router that hasn't been picked for a while
+	 * (e.g. it was down) is pulled up to near the latest sequence so it
+	 * can't take all traffic while catching up. It's racy and inaccurate
+	 * but harmless and functional */
+	if (rtr_best != NULL) {
+		int stride = lnet_route_stride(rtr_best);
+
+		if (rtr_last->lr_seq - rtr_best->lr_seq > LNET_ROUTE_STRIDE_MAX)
+			rtr_best->lr_seq = rtr_last->lr_seq -
+					   LNET_ROUTE_STRIDE_MAX;
+		rtr_best->lr_seq += stride;
+	}
 	return lp_best;
 }
 
@@ -165,12 +165,15 @@ void
 lnet_destroy_peer_locked(lnet_peer_t *lp)
 {
 	struct lnet_peer_table *ptable;
+	int			i;
 
 	LASSERT(lp->lp_refcount == 0);
 	LASSERT(lp->lp_rtr_refcount == 0);
 	LASSERT(cfs_list_empty(&lp->lp_txq));
 	LASSERT(cfs_list_empty(&lp->lp_hashlist));
 	LASSERT(lp->lp_txqnob == 0);
+	for (i = 0; i < LNET_NRBPOOLS; i++)
+		LASSERT(cfs_list_empty(&lp->lp_rtrbufq[i].lpq_msgs));
 
 	ptable = the_lnet.ln_peer_tables[lp->lp_cpt];
 	LASSERT(ptable->pt_number > 0);
@@ -208,6 +211,7 @@ lnet_nid2peer_locked(lnet_peer_t **lpp, lnet_nid_t nid, int cpt)
 	lnet_peer_t		*lp = NULL;
 	lnet_peer_t		*lp2;
 	int			cpt2;
+	int			i;
 	int			rc = 0;
 
 	*lpp = NULL;
@@ -251,6 +255,10 @@ lnet_nid2peer_locked(lnet_peer_t **lpp, lnet_nid_t nid, int cpt)
 	CFS_INIT_LIST_HEAD(&lp->lp_txq);
 	CFS_INIT_LIST_HEAD(&lp->lp_rtrq);
 	CFS_INIT_LIST_HEAD(&lp->lp_routes);
+	for (i = 0; i < LNET_NRBPOOLS; i++) {
+		CFS_INIT_LIST_HEAD(&lp->lp_rtrbufq[i].lpq_list);
+		CFS_INIT_LIST_HEAD(&lp->lp_rtrbufq[i].lpq_msgs);
+	}
 
         lp->lp_notify = 0;
         lp->lp_notifylnd = 0;
@@ -261,6 +269,7 @@ lnet_nid2peer_locked(lnet_peer_t **lpp, lnet_nid_t nid, int cpt)
         lp->lp_last_alive = cfs_time_current(); /* assumes alive */
         lp->lp_last_query = 0; /* haven't asked NI yet */
         lp->lp_ping_timestamp = 0;
+	lp->lp_ping_rtt = 0;
 	lp->lp_ping_feats = LNET_PING_FEAT_INVAL;
 	lp->lp_nid = nid;
 	lp->lp_cpt = cpt2;
@@ -50,6 +50,10 @@ static int peer_buffer_credits = 0;
 CFS_MODULE_PARM(peer_buffer_credits, "i", int, 0444,
                 "# router buffer credits per peer");
 
+static int router_buffers_autosize = 1;
+CFS_MODULE_PARM(router_buffers_autosize, "i", int, 0644,
+		"Grow router buffer pools under load, shrink them when idle");
+
 static int auto_down = 1;
 CFS_MODULE_PARM(auto_down, "i", int, 0444,
                 "Automatically mark peers down on comms error");
@@ -70,6 +74,7 @@ lnet_peer_buffer_credits(lnet_ni_t *ni)
 
 /* forward ref's */
 static int lnet_router_checker(void *);
+static void lnet_rtrpools_adjust(void);
 #else
 
 int
@@ -696,6 +701,32 @@ lnet_parse_rc_info(lnet_rc_data_t *rcd)
 	}
 }
 
+/* fold the RTT of the ping that just got its reply into the gateway's
+ * smoothed RTT, srtt = 7/8 srtt + 1/8 sample */
+static void
+lnet_update_rtt_locked(lnet_peer_t *gw)
+{
+	struct timeval	now;
+	long		usec;
+	unsigned int	rtt;
+
+	/* not jiffies, RTTs are usually well below a tick */
+	cfs_gettimeofday(&now);
+	usec = cfs_timeval_sub(&now, &gw->lp_ping_sent, NULL);
+	if (usec < 0)	/* the clock was set back */
+		return;
+	rtt = usec;
+
+	if (gw->lp_ping_rtt == 0)
+		gw->lp_ping_rtt = rtt;
+	else
+		gw->lp_ping_rtt = gw->lp_ping_rtt - (gw->lp_ping_rtt >> 3) +
+				  (rtt >> 3);
+
+	CDEBUG(D_NET, "rtr %s: rtt %uus srtt %uus\n",
+	       libcfs_nid2str(gw->lp_nid), rtt, gw->lp_ping_rtt);
+}
+
 static void
 lnet_router_checker_event(lnet_event_t *event)
 {
@@ -742,6 +773,9 @@ lnet_router_checker_event(lnet_event_t *event)
 	 * XXX If 'lp' stops being a router before then, it will still
 	 * have the notification pending!!! */
 
+	if (event->status == 0)
+		lnet_update_rtt_locked(lp);
+
 	if (avoid_asym_router_failure && event->status == 0)
 		lnet_parse_rc_info(rcd);
 
@@ -986,6 +1020,7 @@ lnet_ping_router_locked (lnet_peer_t *rtr)
 				cfs_time_shift(router_ping_timeout);
 		}
 
+		cfs_gettimeofday(&rtr->lp_ping_sent);
 		lnet_net_unlock(rtr->lp_cpt);
 
 		rc = LNetGet(LNET_NID_ANY, mdh, id, LNET_RESERVED_PORTAL,
@@ -1271,6 +1306,9 @@ rescan:
 
 		lnet_net_unlock(cpt);
 
+		if (the_lnet.ln_routing && router_buffers_autosize)
+			lnet_rtrpools_adjust();
+
 		lnet_prune_rc_data(0); /* don't wait for UNLINK */
 
                 /* Call cfs_pause() here always adds 1 to load average 
@@ -1345,7 +1383,7 @@ lnet_rtrpool_free_bufs(lnet_rtrbufpool_t *rbp)
 	if (rbp->rbp_nbuffers == 0) /* not initialized or already freed */
 		return;
 
-        LASSERT (cfs_list_empty(&rbp->rbp_msgs));
+        LASSERT (cfs_list_empty(&rbp->rbp_peers));
         LASSERT (rbp->rbp_credits == rbp->rbp_nbuffers);
 
         while (!cfs_list_empty(&rbp->rbp_bufs)) {
@@ -1395,18 +1433,31 @@ lnet_rtrpool_alloc_bufs(lnet_rtrbufpool_t *rbp, int nbufs, int cpt)
         }
 
         LASSERT (rbp->rbp_credits == nbufs);
+
+	/* autosizing never shrinks below what was asked for, and never
+	 * takes more than 1/16 of this CPT's share of memory */
+	rbp->rbp_lwcredits = rbp->rbp_credits;
+	rbp->rbp_nbuffers_min = nbufs;
+	rbp->rbp_nbuffers_max = (cfs_num_physpages / 16 / LNET_CPT_NUMBER) /
+				max(rbp->rbp_npages, 1);
+	rbp->rbp_nbuffers_max = min(rbp->rbp_nbuffers_max, nbufs * 4);
+	rbp->rbp_nbuffers_max = max(rbp->rbp_nbuffers_max, nbufs);
         return 0;
 }
 
 void
 lnet_rtrpool_init(lnet_rtrbufpool_t *rbp, int npages)
 {
-        CFS_INIT_LIST_HEAD(&rbp->rbp_msgs);
+        CFS_INIT_LIST_HEAD(&rbp->rbp_peers);
         CFS_INIT_LIST_HEAD(&rbp->rbp_bufs);
 
         rbp->rbp_npages = npages;
         rbp->rbp_credits = 0;
         rbp->rbp_mincredits = 0;
+	rbp->rbp_lwcredits = 0;
+	rbp->rbp_nbuffers_min = 0;
+	rbp->rbp_nbuffers_max = 0;
+	rbp->rbp_nidle = 0;
 }
 
 void
@@ -1428,6 +1479,129 @@ lnet_rtrpools_free(void)
 	the_lnet.ln_rtrpools = NULL;
 }
 
+/* # of router checker passes (~1s each) a pool must stay mostly idle
+ * before it starts giving buffers back */
+#define LNET_RTRPOOL_IDLE_CHECKS	60
+
+static void
+lnet_rtrpool_grow(lnet_rtrbufpool_t *rbp, int cpt, int nbufs)
+{
+	CFS_LIST_HEAD	(bufs);
+	lnet_rtrbuf_t	*rb;
+	int		i;
+
+	for (i = 0; i < nbufs; i++) {
+		rb = lnet_new_rtrbuf(rbp, cpt);
+		if (rb == NULL)
+			break;
+		cfs_list_add(&rb->rb_list, &bufs);
+	}
+
+	if (i == 0)
+		return;
+
+	CDEBUG(D_NET, "cpt %d: growing %d page pool by %d buffers\n",
+	       cpt, rbp->rbp_npages, i);
+
+	lnet_net_lock(cpt);
+	while (!cfs_list_empty(&bufs)) {
+		rb = cfs_list_entry(bufs.next, lnet_rtrbuf_t, rb_list);
+		cfs_list_del(&rb->rb_list);
+
+		rbp->rbp_nbuffers++;
+		/* NB may drop and retake the lock to forward a blocked msg */
+		lnet_rtrbuf_release_locked(rb, cpt);
+	}
+	lnet_net_unlock(cpt);
+}
+
+static void
+lnet_rtrpool_shrink(lnet_rtrbufpool_t *rbp, int cpt, int nbufs)
+{
+	CFS_LIST_HEAD	(bufs);
+	lnet_rtrbuf_t	*rb;
+	int		i = 0;
+
+	lnet_net_lock(cpt);
+	while (i < nbufs && rbp->rbp_credits > 0 &&
+	       rbp->rbp_nbuffers > rbp->rbp_nbuffers_min) {
+		LASSERT(!cfs_list_empty(&rbp->rbp_bufs));
+
+		rb = cfs_list_entry(rbp->rbp_bufs.next, lnet_rtrbuf_t, rb_list);
+		cfs_list_del(&rb->rb_list);
+		cfs_list_add(&rb->rb_list, &bufs);
+
+		rbp->rbp_nbuffers--;
+		rbp->rbp_credits--;
+		i++;
+	}
+	rbp->rbp_mincredits = min(rbp->rbp_mincredits, rbp->rbp_credits);
+	rbp->rbp_lwcredits = rbp->rbp_credits;
+	lnet_net_unlock(cpt);
+
+	if (i == 0)
+		return;
+
+	CDEBUG(D_NET, "cpt %d: shrinking %d page pool by %d buffers\n",
+	       cpt, rbp->rbp_npages, i);
+
+	while (!cfs_list_empty(&bufs)) {
+		rb = cfs_list_entry(bufs.next, lnet_rtrbuf_t, rb_list);
+		cfs_list_del(&rb->rb_list);
+		lnet_destroy_rtrbuf(rb, rbp->rbp_npages);
+	}
+}
+
+/* Called once a second by the router checker.  A pool that ran dry since
+ * the last pass grows by 1/4; a pool that stayed at least half idle for
+ * LNET_RTRPOOL_IDLE_CHECKS passes gives 1/4 back, never dropping below the
+ * configured size. */
+static void
+lnet_rtrpools_adjust(void)
+{
+	lnet_rtrbufpool_t	*rtrp;
+	lnet_rtrbufpool_t	*rbp;
+	int			nbuffers;
+	int			lwcredits;
+	int			cpt;
+	int			i;
+
+	if (the_lnet.ln_rtrpools == NULL)
+		return;
+
+	cfs_percpt_for_each(rtrp, cpt, the_lnet.ln_rtrpools) {
+		for (i = 0; i < LNET_NRBPOOLS; i++) {
+			rbp = &rtrp[i];
+
+			lnet_net_lock(cpt);
+			nbuffers = rbp->rbp_nbuffers;
+			lwcredits = rbp->rbp_lwcredits;
+			rbp->rbp_lwcredits = rbp->rbp_credits;
+			lnet_net_unlock(cpt);
+
+			if (lwcredits <= 0) {
+				rbp->rbp_nidle = 0;
+				if (nbuffers < rbp->rbp_nbuffers_max) {
+					lnet_rtrpool_grow(rbp, cpt,
+						min(max(nbuffers / 4, 1),
+						    rbp->rbp_nbuffers_max -
+						    nbuffers));
+				}
+			} else if (lwcredits > nbuffers / 2 &&
+				   nbuffers > rbp->rbp_nbuffers_min) {
+				if (++rbp->rbp_nidle >=
+				    LNET_RTRPOOL_IDLE_CHECKS) {
+					rbp->rbp_nidle = 0;
+					lnet_rtrpool_shrink(rbp, cpt,
+						max(nbuffers / 4, 1));
+				}
+			} else {
+				rbp->rbp_nidle = 0;
+			}
+		}
+	}
+}
+
 static int
 lnet_nrb_tiny_calculate(int npages)
 {
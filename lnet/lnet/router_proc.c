@@ -305,10 +305,10 @@ int LL_PROC_PROTO(proc_lnet_routers)
 
         if (*ppos == 0) {
 		s += snprintf(s, tmpstr + tmpsiz - s,
-			      "%-4s %7s %9s %6s %12s %9s %8s %7s %s\n",
+			      "%-4s %7s %9s %6s %12s %9s %8s %7s %8s %s\n",
 			      "ref", "rtr_ref", "alive_cnt", "state",
 			      "last_ping", "ping_sent", "deadline",
-			      "down_ni", "router");
+			      "down_ni", "rtt", "router");
 		LASSERT(tmpstr + tmpsiz - s > 0);
 
 		lnet_net_lock(0);
@@ -356,6 +356,7 @@ int LL_PROC_PROTO(proc_lnet_routers)
                         int last_ping = cfs_duration_sec(cfs_time_sub(now,
                                                      peer->lp_ping_timestamp));
 			int down_ni   = 0;
+			unsigned int rtt = peer->lp_ping_rtt;
 			lnet_route_t *rtr;
 
 			if ((peer->lp_ping_feats &
@@ -373,19 +374,19 @@ int LL_PROC_PROTO(proc_lnet_routers)
 
                         if (deadline == 0)
                                 s += snprintf(s, tmpstr + tmpsiz - s,
-                                              "%-4d %7d %9d %6s %12d %9d %8s %7d %s\n",
+                                              "%-4d %7d %9d %6s %12d %9d %8s %7d %8u %s\n",
                                               nrefs, nrtrrefs, alive_cnt,
                                               alive ? "up" : "down", last_ping,
-                                              pingsent, "NA", down_ni,
+                                              pingsent, "NA", down_ni, rtt,
                                               libcfs_nid2str(nid));
                         else
                                 s += snprintf(s, tmpstr + tmpsiz - s,
-                                              "%-4d %7d %9d %6s %12d %9d %8lu %7d %s\n",
+                                              "%-4d %7d %9d %6s %12d %9d %8lu %7d %8u %s\n",
                                               nrefs, nrtrrefs, alive_cnt,
                                               alive ? "up" : "down", last_ping,
                                               pingsent,
                                               cfs_duration_sec(cfs_time_sub(deadline, now)),
-                                              down_ni, libcfs_nid2str(nid));
+                                              down_ni, rtt, libcfs_nid2str(nid));
                         LASSERT (tmpstr + tmpsiz - s > 0);
                 }
 
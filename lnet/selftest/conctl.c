@@ -722,6 +722,47 @@ lst_stat_query_ioctl(lstio_stat_args_t *args)
         return rc;
 }
 
+int
+lst_lat_query_ioctl(lstio_lat_args_t *args)
+{
+        int             rc;
+        char           *name;
+
+        if (args->lstio_lat_key != console_session.ses_key)
+                return -EACCES;
+
+        if (args->lstio_lat_resultp == NULL ||
+            (args->lstio_lat_namep  == NULL &&
+             args->lstio_lat_idsp   == NULL) ||
+            args->lstio_lat_nmlen <= 0 ||
+            args->lstio_lat_nmlen > LST_NAME_SIZE ||
+            args->lstio_lat_idx < LST_LAT_IDX_ALL)
+                return -EINVAL;
+
+        if (args->lstio_lat_idsp != NULL &&
+            args->lstio_lat_count <= 0)
+                return -EINVAL;
+
+        if (args->lstio_lat_idsp != NULL)
+                return lstcon_nodes_latency(args);
+
+        LIBCFS_ALLOC(name, args->lstio_lat_nmlen + 1);
+        if (name == NULL)
+                return -ENOMEM;
+
+        if (cfs_copy_from_user(name, args->lstio_lat_namep,
+                               args->lstio_lat_nmlen)) {
+                LIBCFS_FREE(name, args->lstio_lat_nmlen + 1);
+                return -EFAULT;
+        }
+
+        rc = lstcon_group_latency(name, args);
+
+        LIBCFS_FREE(name, args->lstio_lat_nmlen + 1);
+
+        return rc;
+}
+
 int lst_test_add_ioctl(lstio_test_args_t *args)
 {
         char           *name;
@@ -914,6 +955,9 @@ lstcon_ioctl_entry(unsigned int cmd, struct libcfs_ioctl_data *data)
                 case LSTIO_STAT_QUERY:
                         rc = lst_stat_query_ioctl((lstio_stat_args_t *)buf);
                         break;
+                case LSTIO_LAT_QUERY:
+                        rc = lst_lat_query_ioctl((lstio_lat_args_t *)buf);
+                        break;
                 default:
                         rc = -EINVAL;
         }
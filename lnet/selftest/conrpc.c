@@ -232,6 +232,9 @@ lstcon_rpc_trans_name(int transop)
         if (transop == LST_TRANS_STATQRY)
                 return "STATQRY";
 
+        if (transop == LST_TRANS_LATQRY)
+                return "LATQRY";
+
         return "Unknown";
 }
 
@@ -710,6 +713,26 @@ lstcon_statrpc_prep(lstcon_node_t *nd, unsigned feats, lstcon_rpc_t **crpc)
         return 0;
 }
 
+int
+lstcon_latrpc_prep(lstcon_node_t *nd, unsigned feats,
+		   lstio_lat_args_t *args, lstcon_rpc_t **crpc)
+{
+	srpc_lat_reqst_t *lrq;
+	int		  rc;
+
+	rc = lstcon_rpc_prep(nd, SRPC_SERVICE_QUERY_LAT, feats, 0, 0, crpc);
+	if (rc != 0)
+		return rc;
+
+	lrq = &(*crpc)->crp_rpc->crpc_reqstmsg.msg_body.lat_reqst;
+
+	lrq->lar_sid   = console_session.ses_id;
+	lrq->lar_idx   = args->lstio_lat_idx;
+	lrq->lar_flags = args->lstio_lat_flags;
+
+	return 0;
+}
+
 lnet_process_id_packed_t *
 lstcon_next_id(int idx, int nkiov, lnet_kiov_t *kiov)
 {
@@ -905,6 +928,12 @@ lstcon_testrpc_prep(lstcon_node_t *nd, int transop, unsigned feats,
 					 &test->tes_param[0], trq);
 		break;
 
+	case LST_TEST_STORM:
+		trq->tsr_service = SRPC_SERVICE_STORM;
+		rc = lstcon_pingrpc_prep((lst_test_ping_param_t *)
+					 &test->tes_param[0], trq);
+		break;
+
 	case LST_TEST_BULK:
 		trq->tsr_service = SRPC_SERVICE_BRW;
 		if ((feats & LST_FEAT_BULK_LEN) == 0) {
@@ -976,6 +1005,7 @@ lstcon_rpc_stat_reply(lstcon_rpc_trans_t *trans, srpc_msg_t *msg,
         srpc_batch_reply_t *bat_rep;
         srpc_test_reply_t  *test_rep;
         srpc_stat_reply_t  *stat_rep;
+        srpc_lat_reply_t   *lat_rep;
         int                 rc = 0;
 
 	switch (trans->tas_opc) {
@@ -1077,6 +1107,18 @@ lstcon_rpc_stat_reply(lstcon_rpc_trans_t *trans, srpc_msg_t *msg,
                 rc = stat_rep->str_status;
                 break;
 
+        case LST_TRANS_LATQRY:
+                lat_rep = &msg->msg_body.lat_reply;
+
+                if (lat_rep->lar_status == 0) {
+                        lstcon_statqry_stat_success(stat, 1);
+                        return;
+                }
+
+                lstcon_statqry_stat_failure(stat, 1);
+                rc = lat_rep->lar_status;
+                break;
+
         default:
                 LBUG();
         }
@@ -1148,6 +1190,10 @@ lstcon_rpc_trans_ndlist(cfs_list_t *ndlist,
 		case LST_TRANS_STATQRY:
 			rc = lstcon_statrpc_prep(nd, feats, &rpc);
                         break;
+		case LST_TRANS_LATQRY:
+			rc = lstcon_latrpc_prep(nd, feats,
+						(lstio_lat_args_t *)arg, &rpc);
+			break;
                 default:
                         rc = -EINVAL;
                         break;
@@ -1507,9 +1507,9 @@ lstcon_group_stat(char *grp_name, int timeout, cfs_list_t *result_up)
         return rc;
 }
 
-int
-lstcon_nodes_stat(int count, lnet_process_id_t *ids_up,
-                  int timeout, cfs_list_t *result_up)
+static int
+lstcon_nodes_tmp_group(int count, lnet_process_id_t *ids_up,
+                       lstcon_group_t **grpp)
 {
         lstcon_ndlink_t         *ndl;
         lstcon_group_t          *tmp;
@@ -1544,6 +1544,21 @@ lstcon_nodes_stat(int count, lnet_process_id_t *ids_up,
                 return rc;
         }
 
+        *grpp = tmp;
+        return 0;
+}
+
+int
+lstcon_nodes_stat(int count, lnet_process_id_t *ids_up,
+                  int timeout, cfs_list_t *result_up)
+{
+        lstcon_group_t          *tmp;
+        int                      rc;
+
+        rc = lstcon_nodes_tmp_group(count, ids_up, &tmp);
+        if (rc != 0)
+                return rc;
+
         rc = lstcon_ndlist_stat(&tmp->grp_ndl_list, timeout, result_up);
 
         lstcon_group_put(tmp);
@@ -1551,6 +1566,94 @@ lstcon_nodes_stat(int count, lnet_process_id_t *ids_up,
         return rc;
 }
 
+static int
+lstcon_latrpc_readent(int transop, srpc_msg_t *msg,
+                      lstcon_rpc_ent_t *ent_up)
+{
+        srpc_lat_reply_t *rep = &msg->msg_body.lat_reply;
+        lstcon_lat_ent_t *lat = (lstcon_lat_ent_t *)&ent_up->rpe_payload[0];
+        lnet_process_id_t peer;
+        int               npeers;
+
+        if (rep->lar_status != 0)
+                return 0;
+
+        npeers   = rep->lar_npeers;
+        peer.nid = rep->lar_peer.nid;
+        peer.pid = rep->lar_peer.pid;
+
+        if (cfs_copy_to_user(&lat->lte_npeers, &npeers, sizeof(npeers)) ||
+            cfs_copy_to_user(&lat->lte_peer, &peer, sizeof(peer)) ||
+            cfs_copy_to_user(&lat->lte_hist, &rep->lar_hist,
+                             sizeof(rep->lar_hist)))
+                return -EFAULT;
+
+        return 0;
+}
+
+static int
+lstcon_ndlist_latency(cfs_list_t *ndlist, lstio_lat_args_t *args)
+{
+        cfs_list_t          head;
+        lstcon_rpc_trans_t *trans;
+        int                 rc;
+
+        CFS_INIT_LIST_HEAD(&head);
+
+        rc = lstcon_rpc_trans_ndlist(ndlist, &head,
+                                     LST_TRANS_LATQRY, args, NULL, &trans);
+        if (rc != 0) {
+                CERROR("Can't create transaction: %d\n", rc);
+                return rc;
+        }
+
+        lstcon_rpc_trans_postwait(trans,
+                                  LST_VALIDATE_TIMEOUT(args->lstio_lat_timeout));
+
+        rc = lstcon_rpc_trans_interpreter(trans, args->lstio_lat_resultp,
+                                          lstcon_latrpc_readent);
+        lstcon_rpc_trans_destroy(trans);
+
+        return rc;
+}
+
+int
+lstcon_group_latency(char *grp_name, lstio_lat_args_t *args)
+{
+        lstcon_group_t     *grp;
+        int                 rc;
+
+        rc = lstcon_group_find(grp_name, &grp);
+        if (rc != 0) {
+                CDEBUG(D_NET, "Can't find group %s\n", grp_name);
+                return rc;
+        }
+
+        rc = lstcon_ndlist_latency(&grp->grp_ndl_list, args);
+
+        lstcon_group_put(grp);
+
+        return rc;
+}
+
+int
+lstcon_nodes_latency(lstio_lat_args_t *args)
+{
+        lstcon_group_t     *tmp;
+        int                 rc;
+
+        rc = lstcon_nodes_tmp_group(args->lstio_lat_count,
+                                    args->lstio_lat_idsp, &tmp);
+        if (rc != 0)
+                return rc;
+
+        rc = lstcon_ndlist_latency(&tmp->grp_ndl_list, args);
+
+        lstcon_group_put(tmp);
+
+        return rc;
+}
+
 int
 lstcon_debug_ndlist(cfs_list_t *ndlist,
                     cfs_list_t *translist,
@@ -100,6 +100,15 @@ do {                                    \
         __swab64s(&(lc).route_length);  \
 } while (0)
 
+#define sfw_unpack_lat_hist(lh)         \
+do {                                    \
+        int __i;                        \
+                                        \
+        __swab32s(&(lh).lat_max);       \
+        for (__i = 0; __i < LST_LAT_BUCKETS; __i++) \
+                __swab32s(&(lh).lat_buckets[__i]); \
+} while (0)
+
 #define sfw_test_active(t)      (cfs_atomic_read(&(t)->tsi_nactive) != 0)
 #define sfw_batch_active(b)     (cfs_atomic_read(&(b)->bat_nactive) != 0)
 
@@ -280,6 +289,7 @@ sfw_init_session(sfw_session_t *sn, lst_sid_t sid,
 		 unsigned features, const char *name)
 {
         stt_timer_t *timer = &sn->sn_timer;
+	int	     i;
 
         memset(sn, 0, sizeof(sfw_session_t));
         CFS_INIT_LIST_HEAD(&sn->sn_list);
@@ -289,6 +299,11 @@ sfw_init_session(sfw_session_t *sn, lst_sid_t sid,
         cfs_atomic_set(&sn->sn_ping_errors, 0);
         strncpy(&sn->sn_name[0], name, LST_NAME_SIZE);
 
+	spin_lock_init(&sn->sn_lat_lock);
+	CFS_INIT_LIST_HEAD(&sn->sn_lat_peers);
+	for (i = 0; i < SFW_LAT_HASH_SIZE; i++)
+		CFS_INIT_LIST_HEAD(&sn->sn_lat_hash[i]);
+
         sn->sn_timer_active = 0;
         sn->sn_id           = sid;
 	sn->sn_features	    = features;
@@ -432,6 +447,159 @@ sfw_get_stats (srpc_stat_reqst_t *request, srpc_stat_reply_t *reply)
         return 0;
 }
 
+static inline cfs_list_t *
+sfw_lat_hash(sfw_session_t *sn, lnet_process_id_t id)
+{
+	return &sn->sn_lat_hash[(unsigned int)id.nid % SFW_LAT_HASH_SIZE];
+}
+
+/* caller should hold sn_lat_lock */
+static sfw_lat_peer_t *
+sfw_lat_peer_find(sfw_session_t *sn, lnet_process_id_t id)
+{
+	sfw_lat_peer_t *lp;
+
+	cfs_list_for_each_entry_typed(lp, sfw_lat_hash(sn, id),
+				      sfw_lat_peer_t, lp_hash) {
+		if (lp->lp_id.nid == id.nid && lp->lp_id.pid == id.pid)
+			return lp;
+	}
+
+	return NULL;
+}
+
+static int
+sfw_lat_peer_add(sfw_session_t *sn, lnet_process_id_t id)
+{
+	sfw_lat_peer_t *lp;
+
+	LIBCFS_ALLOC(lp, sizeof(*lp));
+	if (lp == NULL)
+		return -ENOMEM;
+
+	memset(lp, 0, sizeof(*lp));
+	lp->lp_id = id;
+
+	spin_lock(&sn->sn_lat_lock);
+	if (sfw_lat_peer_find(sn, id) == NULL) {
+		cfs_list_add_tail(&lp->lp_list, &sn->sn_lat_peers);
+		cfs_list_add(&lp->lp_hash, sfw_lat_hash(sn, id));
+		sn->sn_lat_npeers++;
+		lp = NULL;
+	}
+	spin_unlock(&sn->sn_lat_lock);
+
+	if (lp != NULL) /* already tracked by another test */
+		LIBCFS_FREE(lp, sizeof(*lp));
+	return 0;
+}
+
+static void
+sfw_lat_peers_free(sfw_session_t *sn)
+{
+	sfw_lat_peer_t *lp;
+
+	while (!cfs_list_empty(&sn->sn_lat_peers)) {
+		lp = cfs_list_entry(sn->sn_lat_peers.next,
+				    sfw_lat_peer_t, lp_list);
+		cfs_list_del(&lp->lp_list);
+		cfs_list_del(&lp->lp_hash);
+		LIBCFS_FREE(lp, sizeof(*lp));
+	}
+	sn->sn_lat_npeers = 0;
+}
+
+static inline void
+sfw_lat_hist_add(lst_lat_hist_t *hist, __u32 usec)
+{
+	int i = 0;
+
+	while (i < LST_LAT_BUCKETS - 1 && (usec >> i) != 0)
+		i++;
+
+	hist->lat_buckets[i]++;
+	if (usec > hist->lat_max)
+		hist->lat_max = usec;
+}
+
+static void
+sfw_lat_record(sfw_session_t *sn, srpc_client_rpc_t *rpc,
+	       struct timeval *now)
+{
+	sfw_lat_peer_t *lp;
+	long		usec;
+
+	usec = (now->tv_sec - rpc->crpc_sent.tv_sec) * 1000000 +
+	       (now->tv_usec - rpc->crpc_sent.tv_usec);
+	if (usec < 0) /* wall clock stepped back */
+		usec = 0;
+
+	spin_lock(&sn->sn_lat_lock);
+
+	sfw_lat_hist_add(&sn->sn_lat_total, (__u32)usec);
+	lp = sfw_lat_peer_find(sn, rpc->crpc_dest);
+	if (lp != NULL)
+		sfw_lat_hist_add(&lp->lp_hist, (__u32)usec);
+
+	spin_unlock(&sn->sn_lat_lock);
+}
+
+int
+sfw_get_latency(srpc_lat_reqst_t *request, srpc_lat_reply_t *reply)
+{
+	sfw_session_t  *sn = sfw_data.fw_session;
+	sfw_lat_peer_t *lp = NULL;
+	lst_lat_hist_t *hist;
+	__u32		idx = 0;
+
+	reply->lar_sid = (sn == NULL) ? LST_INVALID_SID : sn->sn_id;
+
+	if (request->lar_sid.ses_nid == LNET_NID_ANY) {
+		reply->lar_status = EINVAL;
+		return 0;
+	}
+
+	if (sn == NULL || !sfw_sid_equal(request->lar_sid, sn->sn_id)) {
+		reply->lar_status = ESRCH;
+		return 0;
+	}
+
+	spin_lock(&sn->sn_lat_lock);
+
+	reply->lar_npeers = sn->sn_lat_npeers;
+
+	if (request->lar_idx == (__u32)LST_LAT_IDX_ALL) {
+		reply->lar_peer.nid = LNET_NID_ANY;
+		reply->lar_peer.pid = LNET_PID_ANY;
+		hist = &sn->sn_lat_total;
+	} else {
+		cfs_list_for_each_entry_typed(lp, &sn->sn_lat_peers,
+					      sfw_lat_peer_t, lp_list) {
+			if (idx++ == request->lar_idx)
+				break;
+		}
+
+		if (idx <= request->lar_idx) {
+			spin_unlock(&sn->sn_lat_lock);
+			reply->lar_status = ENOENT;
+			return 0;
+		}
+
+		reply->lar_peer.nid = lp->lp_id.nid;
+		reply->lar_peer.pid = lp->lp_id.pid;
+		hist = &lp->lp_hist;
+	}
+
+	reply->lar_hist = *hist;
+	if ((request->lar_flags & LST_LAT_RESET) != 0)
+		memset(hist, 0, sizeof(*hist));
+
+	spin_unlock(&sn->sn_lat_lock);
+
+	reply->lar_status = 0;
+	return 0;
+}
+
 int
 sfw_make_session(srpc_mksn_reqst_t *request, srpc_mksn_reply_t *reply)
 {
@@ -693,6 +861,7 @@ sfw_destroy_session (sfw_session_t *sn)
                 sfw_destroy_batch(batch);
         }
 
+        sfw_lat_peers_free(sn);
         LIBCFS_FREE(sn, sizeof(*sn));
         cfs_atomic_dec(&sfw_data.fw_nzombies);
         return;
@@ -731,7 +900,8 @@ sfw_unpack_addtest_req(srpc_msg_t *msg)
 		return;
 	}
 
-        if (req->tsr_service == SRPC_SERVICE_PING) {
+        if (req->tsr_service == SRPC_SERVICE_PING ||
+            req->tsr_service == SRPC_SERVICE_STORM) {
                 test_ping_req_t *ping = &req->tsr_u.ping;
 
                 __swab32s(&ping->png_size);
@@ -752,6 +922,7 @@ sfw_add_test_instance (sfw_batch_t *tsb, srpc_server_rpc_t *rpc)
         int                  ndest = req->tsr_ndest;
         sfw_test_unit_t     *tsu;
         sfw_test_instance_t *tsi;
+        lnet_process_id_t    peer;
         int                  i;
         int                  rc;
 
@@ -817,6 +988,12 @@ sfw_add_test_instance (sfw_batch_t *tsb, srpc_server_rpc_t *rpc)
                 if (msg->msg_magic != SRPC_MSG_MAGIC)
                         sfw_unpack_id(id);
 
+		peer.nid = id.nid;
+		peer.pid = id.pid;
+		rc = sfw_lat_peer_add(tsb->bat_session, peer);
+		if (rc != 0)
+			goto error;
+
                 for (j = 0; j < tsi->tsi_concur; j++) {
                         LIBCFS_ALLOC(tsu, sizeof(sfw_test_unit_t));
                         if (tsu == NULL) {
@@ -895,10 +1072,17 @@ sfw_test_rpc_done (srpc_client_rpc_t *rpc)
 {
         sfw_test_unit_t     *tsu = rpc->crpc_priv;
         sfw_test_instance_t *tsi = tsu->tsu_instance;
+        struct timeval       now;
         int                  done = 0;
 
+        cfs_gettimeofday(&now);
+
         tsi->tsi_ops->tso_done_rpc(tsu, rpc);
 
+        /* only replies which passed the test's checks count */
+        if (rpc->crpc_status == 0)
+                sfw_lat_record(tsi->tsi_batch->bat_session, rpc, &now);
+
 	spin_lock(&tsi->tsi_lock);
 
         LASSERT (sfw_test_active(tsi));
@@ -1001,6 +1185,8 @@ sfw_run_test (swi_workitem_t *wi)
 
 	rpc->crpc_timeout = rpc_timeout;
 
+	cfs_gettimeofday(&rpc->crpc_sent);
+
 	spin_lock(&rpc->crpc_lock);
 	srpc_post_rpc(rpc);
 	spin_unlock(&rpc->crpc_lock);
@@ -1333,6 +1519,11 @@ sfw_handle_server_rpc(struct srpc_server_rpc *rpc)
                                    &reply->msg_body.stat_reply);
                 break;
 
+        case SRPC_SERVICE_QUERY_LAT:
+                rc = sfw_get_latency(&request->msg_body.lat_reqst,
+                                     &reply->msg_body.lat_reply);
+                break;
+
         case SRPC_SERVICE_DEBUG:
                 rc = sfw_debug_session(&request->msg_body.dbg_reqst,
                                        &reply->msg_body.dbg_reply);
@@ -1488,6 +1679,27 @@ sfw_unpack_message (srpc_msg_t *msg)
                 return;
         }
 
+        if (msg->msg_type == SRPC_MSG_LAT_REQST) {
+                srpc_lat_reqst_t *req = &msg->msg_body.lat_reqst;
+
+                __swab64s(&req->lar_rpyid);
+                sfw_unpack_sid(req->lar_sid);
+                __swab32s(&req->lar_idx);
+                __swab32s(&req->lar_flags);
+                return;
+        }
+
+        if (msg->msg_type == SRPC_MSG_LAT_REPLY) {
+                srpc_lat_reply_t *rep = &msg->msg_body.lat_reply;
+
+                __swab32s(&rep->lar_status);
+                sfw_unpack_sid(rep->lar_sid);
+                __swab32s(&rep->lar_npeers);
+                sfw_unpack_id(rep->lar_peer);
+                sfw_unpack_lat_hist(rep->lar_hist);
+                return;
+        }
+
         if (msg->msg_type == SRPC_MSG_MKSN_REQST) {
                 srpc_mksn_reqst_t *req = &msg->msg_body.mksn_reqst;
 
@@ -1644,6 +1856,11 @@ static srpc_service_t sfw_services[] =
                 /* sv_name */  "query stats",
                 0
         },
+        {
+                /* sv_id */    SRPC_SERVICE_QUERY_LAT,
+                /* sv_name */  "query latency",
+                0
+        },
         {
                 /* sv_id */    SRPC_SERVICE_MAKE_SESSION,
                 /* sv_name */  "make session",
@@ -1676,6 +1893,11 @@ extern srpc_service_t        ping_test_service;
 extern void ping_init_test_client(void);
 extern void ping_init_test_service(void);
 
+extern sfw_test_client_ops_t storm_test_client;
+extern srpc_service_t        storm_test_service;
+extern void storm_init_test_client(void);
+extern void storm_init_test_service(void);
+
 extern sfw_test_client_ops_t brw_test_client;
 extern srpc_service_t        brw_test_service;
 extern void brw_init_test_client(void);
@@ -1741,6 +1963,11 @@ sfw_startup (void)
         rc = sfw_register_test(&ping_test_service, &ping_test_client);
         LASSERT (rc == 0);
 
+        storm_init_test_client();
+        storm_init_test_service();
+        rc = sfw_register_test(&storm_test_service, &storm_test_client);
+        LASSERT (rc == 0);
+
         error = 0;
         cfs_list_for_each_entry_typed (tsc, &sfw_data.fw_tests,
                                        sfw_test_case_t, tsc_list) {
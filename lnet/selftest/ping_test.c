@@ -176,7 +176,8 @@ ping_server_handle(struct srpc_server_rpc *rpc)
         srpc_ping_reqst_t *req = &reqstmsg->msg_body.ping_reqst;
         srpc_ping_reply_t *rep = &rpc->srpc_replymsg.msg_body.ping_reply;
 
-        LASSERT (sv->sv_id == SRPC_SERVICE_PING);
+        LASSERT (sv->sv_id == SRPC_SERVICE_PING ||
+                 sv->sv_id == SRPC_SERVICE_STORM);
 
         if (reqstmsg->msg_magic != SRPC_MSG_MAGIC) {
                 LASSERT (reqstmsg->msg_magic == __swab32(SRPC_MSG_MAGIC));
@@ -210,6 +211,49 @@ ping_server_handle(struct srpc_server_rpc *rpc)
 	return 0;
 }
 
+/*
+ * Small message storm: the same request/reply exchange as ping, but each
+ * test unit walks all destinations of the test instead of sticking to
+ * its own one, so every peer is hit by every unit with no think time.
+ */
+static int
+storm_client_init(sfw_test_instance_t *tsi)
+{
+	sfw_test_unit_t *tsu;
+	int		 rc;
+
+	rc = ping_client_init(tsi);
+	if (rc != 0)
+		return rc;
+
+	cfs_list_for_each_entry_typed(tsu, &tsi->tsi_units,
+				      sfw_test_unit_t, tsu_list)
+		tsu->tsu_private = tsu; /* start from my own destination */
+
+	return 0;
+}
+
+static int
+storm_client_prep_rpc(sfw_test_unit_t *tsu,
+		      lnet_process_id_t dest, srpc_client_rpc_t **rpc)
+{
+	sfw_test_instance_t *tsi  = tsu->tsu_instance;
+	sfw_test_unit_t     *next = tsu->tsu_private;
+	cfs_list_t	    *pos  = &next->tsu_list;
+	int		     i;
+
+	/* units of the same destination are adjacent on tsi_units,
+	 * so skipping tsi_concur of them moves on to the next one */
+	for (i = 0; i < tsi->tsi_concur; i++) {
+		pos = pos->next;
+		if (pos == &tsi->tsi_units)
+			pos = pos->next;
+	}
+	tsu->tsu_private = cfs_list_entry(pos, sfw_test_unit_t, tsu_list);
+
+	return ping_client_prep_rpc(tsu, next->tsu_dest, rpc);
+}
+
 sfw_test_client_ops_t ping_test_client;
 void ping_init_test_client(void)
 {
@@ -227,3 +271,21 @@ void ping_init_test_service(void)
 	ping_test_service.sv_handler  = ping_server_handle;
 	ping_test_service.sv_wi_total = ping_srv_workitems;
 }
+
+sfw_test_client_ops_t storm_test_client;
+void storm_init_test_client(void)
+{
+	storm_test_client.tso_init     = storm_client_init;
+	storm_test_client.tso_fini     = ping_client_fini;
+	storm_test_client.tso_prep_rpc = storm_client_prep_rpc;
+	storm_test_client.tso_done_rpc = ping_client_done_rpc;
+}
+
+srpc_service_t storm_test_service;
+void storm_init_test_service(void)
+{
+	storm_test_service.sv_id       = SRPC_SERVICE_STORM;
+	storm_test_service.sv_name     = "storm_test";
+	storm_test_service.sv_handler  = ping_server_handle;
+	storm_test_service.sv_wi_total = ping_srv_workitems;
+}
@@ -63,6 +63,8 @@ typedef enum {
         SRPC_MSG_PING_REPLY     = 15,
         SRPC_MSG_JOIN_REQST     = 16,
         SRPC_MSG_JOIN_REPLY     = 17,
+        SRPC_MSG_LAT_REQST      = 18,
+        SRPC_MSG_LAT_REPLY      = 19,
 } srpc_msg_type_t;
 
 #include <libcfs/libcfs_pack.h>
@@ -170,6 +172,21 @@ typedef struct {
         lnet_counters_t         str_lnet;
 } WIRE_ATTR srpc_stat_reply_t;
 
+typedef struct {
+        __u64                   lar_rpyid;      /* reply buffer matchbits */
+        lst_sid_t               lar_sid;        /* session id */
+        __u32                   lar_idx;        /* peer index or LST_LAT_IDX_ALL */
+        __u32                   lar_flags;      /* LST_LAT_* */
+} WIRE_ATTR srpc_lat_reqst_t;
+
+typedef struct {
+        __u32                   lar_status;
+        lst_sid_t               lar_sid;
+        __u32                   lar_npeers;     /* # of peers being tracked */
+        lnet_process_id_packed_t lar_peer;      /* peer of lar_hist */
+        lst_lat_hist_t          lar_hist;
+} WIRE_ATTR srpc_lat_reply_t;
+
 typedef struct {
         __u32                   blk_opc;        /* bulk operation code */
         __u32                   blk_npg;        /* # of pages */
@@ -272,6 +289,8 @@ typedef struct srpc_msg {
                 srpc_batch_reply_t   bat_reply;
                 srpc_stat_reqst_t    stat_reqst;
                 srpc_stat_reply_t    stat_reply;
+                srpc_lat_reqst_t     lat_reqst;
+                srpc_lat_reply_t     lat_reply;
                 srpc_test_reqst_t    tes_reqst;
                 srpc_test_reply_t    tes_reply;
                 srpc_join_reqst_t    join_reqst;
@@ -90,11 +90,13 @@ struct sfw_test_instance;
 #define SRPC_SERVICE_TEST               4
 #define SRPC_SERVICE_QUERY_STAT         5
 #define SRPC_SERVICE_JOIN               6
+#define SRPC_SERVICE_QUERY_LAT          7
 #define SRPC_FRAMEWORK_SERVICE_MAX_ID   10
 /* other services start from SRPC_FRAMEWORK_SERVICE_MAX_ID+1 */
 #define SRPC_SERVICE_BRW                11
 #define SRPC_SERVICE_PING               12
-#define SRPC_SERVICE_MAX_ID             12
+#define SRPC_SERVICE_STORM              13
+#define SRPC_SERVICE_MAX_ID             13
 
 #define SRPC_REQUEST_PORTAL             50
 /* a lazy portal for framework RPC requests */
@@ -126,10 +128,14 @@ srpc_service2request (int service)
         case SRPC_SERVICE_QUERY_STAT:
                 return SRPC_MSG_STAT_REQST;
 
+        case SRPC_SERVICE_QUERY_LAT:
+                return SRPC_MSG_LAT_REQST;
+
         case SRPC_SERVICE_BRW:
                 return SRPC_MSG_BRW_REQST;
 
         case SRPC_SERVICE_PING:
+        case SRPC_SERVICE_STORM: /* storm test talks ping on the wire */
                 return SRPC_MSG_PING_REQST;
 
         case SRPC_SERVICE_JOIN:
@@ -228,6 +234,7 @@ typedef struct srpc_client_rpc {
         void               (*crpc_fini)(struct srpc_client_rpc *);
         int                  crpc_status;    /* completion status */
         void                *crpc_priv;      /* caller data */
+        struct timeval       crpc_sent;      /* when the request was posted */
 
         /* state flags */
         unsigned int         crpc_aborted:1; /* being given up */
@@ -335,6 +342,16 @@ typedef struct srpc_service {
         int              (*sv_bulk_ready) (srpc_server_rpc_t *, int);
 } srpc_service_t;
 
+#define SFW_LAT_HASH_SIZE       64
+
+/* round trip latency of test RPCs to one peer */
+typedef struct {
+	cfs_list_t		lp_list;	/* chain on sn_lat_peers */
+	cfs_list_t		lp_hash;	/* chain on sn_lat_hash */
+	lnet_process_id_t	lp_id;		/* id of the peer */
+	lst_lat_hist_t		lp_hist;	/* latency histogram */
+} sfw_lat_peer_t;
+
 typedef struct {
         cfs_list_t        sn_list;    /* chain on fw_zombie_sessions */
         lst_sid_t         sn_id;      /* unique identifier */
@@ -348,6 +365,11 @@ typedef struct {
         cfs_atomic_t      sn_brw_errors;
         cfs_atomic_t      sn_ping_errors;
         cfs_time_t        sn_started;
+	spinlock_t	  sn_lat_lock;	/* serialize latency histograms */
+	int		  sn_lat_npeers;
+	cfs_list_t	  sn_lat_peers;	/* peers in order of creation */
+	cfs_list_t	  sn_lat_hash[SFW_LAT_HASH_SIZE]; /* peers by nid */
+	lst_lat_hist_t	  sn_lat_total;	/* all peers */
 } sfw_session_t;
 
 #define sfw_sid_equal(sid0, sid1)     ((sid0).ses_nid == (sid1).ses_nid && \
@@ -342,6 +342,8 @@ lst_test_type2name(int type)
                 return "ping";
         if (type == LST_TEST_BULK)
                 return "brw";
+        if (type == LST_TEST_STORM)
+                return "storm";
 
         return "unknown";
 }
@@ -353,6 +355,8 @@ lst_test_name2type(char *name)
                 return LST_TEST_PING;
         if (strcasecmp(name, "brw") == 0)
                 return LST_TEST_BULK;
+        if (strcasecmp(name, "storm") == 0)
+                return LST_TEST_STORM;
 
         return -1;
 }
@@ -2129,6 +2133,229 @@ out:
         return rc;
 }
 
+int
+lst_lat_ioctl(char *name, int count, lnet_process_id_t *idsp,
+              int idx, int flags, int timeout, cfs_list_t *resultp)
+{
+        lstio_lat_args_t args = {0};
+
+        args.lstio_lat_key     = session_key;
+        args.lstio_lat_timeout = timeout;
+        args.lstio_lat_nmlen   = strlen(name);
+        args.lstio_lat_namep   = name;
+        args.lstio_lat_count   = count;
+        args.lstio_lat_idsp    = idsp;
+        args.lstio_lat_idx     = idx;
+        args.lstio_lat_flags   = flags;
+        args.lstio_lat_resultp = resultp;
+
+        return lst_ioctl (LSTIO_LAT_QUERY, &args, sizeof(args));
+}
+
+/* upper bound (usec) of the bucket holding the permille-th round trip */
+static unsigned int
+lst_lat_percentile(lst_lat_hist_t *hist, __u64 total, int permille)
+{
+        __u64 sum = 0;
+        int   i;
+
+        for (i = 0; i < LST_LAT_BUCKETS - 1; i++) {
+                sum += hist->lat_buckets[i];
+                if (sum * 1000 >= total * permille)
+                        break;
+        }
+
+        if (i == LST_LAT_BUCKETS - 1 || (1U << i) > hist->lat_max)
+                return hist->lat_max;
+
+        return 1U << i;
+}
+
+static void
+lst_print_lat_hist(char *src, char *dst, lst_lat_hist_t *hist)
+{
+        __u64 total = 0;
+        int   i;
+
+        for (i = 0; i < LST_LAT_BUCKETS; i++)
+                total += hist->lat_buckets[i];
+
+        fprintf(stdout, "%s%s%s: ", src, dst != NULL ? " -> " : "",
+                dst != NULL ? dst : "");
+
+        if (total == 0) {
+                fprintf(stdout, "no samples\n");
+                return;
+        }
+
+        fprintf(stdout, "rpcs %llu, p50 %u, p90 %u, p99 %u, p99.9 %u, "
+                "max %u usec\n", (unsigned long long)total,
+                lst_lat_percentile(hist, total, 500),
+                lst_lat_percentile(hist, total, 900),
+                lst_lat_percentile(hist, total, 990),
+                lst_lat_percentile(hist, total, 999), hist->lat_max);
+}
+
+int
+jt_lst_latency(int argc, char **argv)
+{
+        cfs_list_t            head;
+        lstcon_rpc_ent_t     *ent;
+        lstcon_lat_ent_t     *lat;
+        lnet_process_id_t    *ids = NULL;
+        char                 *name;
+        char                  src[LNET_NIDSTR_SIZE * 2];
+        int                   optidx  = 0;
+        int                   timeout = 5; /* default timeout, 5 sec */
+        int                   peers   = 0;
+        int                   flags   = 0;
+        int                   npeers;
+        int                   count;
+        int                   idx;
+        int                   rc = 0;
+        int                   c;
+
+        static struct option  lat_opts[] =
+        {
+                {"timeout", required_argument, 0, 't' },
+                {"peers",   no_argument,       0, 'p' },
+                {"reset",   no_argument,       0, 'r' },
+                {0,         0,                 0,  0  }
+        };
+
+        if (session_key == 0) {
+                fprintf(stderr,
+                        "Can't find env LST_SESSION or value is not valid\n");
+                return -1;
+        }
+
+        while (1) {
+                c = getopt_long(argc, argv, "t:pr", lat_opts, &optidx);
+
+                if (c == -1)
+                        break;
+
+                switch (c) {
+                case 't':
+                        timeout = atoi(optarg);
+                        break;
+                case 'p':
+                        peers = 1;
+                        break;
+                case 'r':
+                        flags |= LST_LAT_RESET;
+                        break;
+                default:
+                        lst_print_usage(argv[0]);
+                        return -1;
+                }
+        }
+
+        if (optind == argc) {
+                lst_print_usage(argv[0]);
+                return -1;
+        }
+
+        CFS_INIT_LIST_HEAD(&head);
+
+        for (; optind < argc; optind++) {
+                name = argv[optind];
+
+                rc = lst_get_node_count(LST_OPC_GROUP, name, &count, NULL);
+                if (rc != 0 && errno == ENOENT)
+                        rc = lst_get_node_count(LST_OPC_NODES, name,
+                                                &count, &ids);
+                if (rc != 0) {
+                        fprintf(stderr,
+                                "Failed to get count of nodes from %s: %s\n",
+                                name, strerror(errno));
+                        break;
+                }
+
+                rc = lst_alloc_rpcent(&head, count, sizeof(lstcon_lat_ent_t));
+                if (rc != 0) {
+                        fprintf(stderr, "Out of memory\n");
+                        break;
+                }
+
+                fprintf(stdout, "%s:\n", name);
+
+                /* aggregate of each node first, then its peers one by one */
+                npeers = 0;
+                for (idx = LST_LAT_IDX_ALL; idx < npeers; idx++) {
+                        rc = lst_lat_ioctl(name, count, ids, idx, flags,
+                                           timeout, &head);
+                        if (rc == -1) {
+                                lst_print_error("latency",
+                                                "Failed to query latency of "
+                                                "%s: %s\n",
+                                                name, strerror(errno));
+                                break;
+                        }
+
+                        cfs_list_for_each_entry_typed(ent, &head,
+                                                      lstcon_rpc_ent_t,
+                                                      rpe_link) {
+                                if (ent->rpe_rpc_errno != 0) {
+                                        if (idx == LST_LAT_IDX_ALL)
+                                                fprintf(stderr, "RPC failure, "
+                                                        "can't get latency of "
+                                                        "%s: %s\n",
+                                                        libcfs_id2str(ent->rpe_peer),
+                                                        strerror(ent->rpe_rpc_errno));
+                                        continue;
+                                }
+
+                                /* nodes with fewer peers return ENOENT */
+                                if (ent->rpe_fwk_errno != 0) {
+                                        if (idx == LST_LAT_IDX_ALL)
+                                                fprintf(stderr, "Framework "
+                                                        "failure, can't get "
+                                                        "latency of %s: %s\n",
+                                                        libcfs_id2str(ent->rpe_peer),
+                                                        strerror(ent->rpe_fwk_errno));
+                                        continue;
+                                }
+
+                                lat = (lstcon_lat_ent_t *)&ent->rpe_payload[0];
+                                snprintf(src, sizeof(src), "%s",
+                                         libcfs_id2str(ent->rpe_peer));
+
+                                if (idx == LST_LAT_IDX_ALL) {
+                                        lst_print_lat_hist(src, NULL,
+                                                           &lat->lte_hist);
+                                        if (peers &&
+                                            lat->lte_npeers > npeers)
+                                                npeers = lat->lte_npeers;
+                                        continue;
+                                }
+
+                                lst_print_lat_hist(src,
+                                                   libcfs_id2str(lat->lte_peer),
+                                                   &lat->lte_hist);
+                        }
+
+                        lst_reset_rpcent(&head);
+                }
+
+                lst_free_rpcent(&head);
+                if (ids != NULL) {
+                        free(ids);
+                        ids = NULL;
+                }
+
+                if (rc == -1)
+                        break;
+                rc = 0;
+        }
+
+        lst_free_rpcent(&head);
+        if (ids != NULL)
+                free(ids);
+
+        return rc;
+}
+
 int
 lst_add_batch_ioctl (char *name)
 {
@@ -2972,6 +3199,7 @@ lst_get_test_param(char *test, int argc, char **argv, void **param, int *plen)
 
         switch (type) {
         case LST_TEST_PING:
+        case LST_TEST_STORM:
                 break;
 
         case LST_TEST_BULK:
@@ -3208,6 +3436,8 @@ static command_t lst_cmdlist[] = {
 	 " [--timeout #] [--delay #] [--count #] GROUP [GROUP]"                         },
         {"show_error",          jt_lst_show_error,      NULL,
          "Usage: lst show_error NAME | IDS ..."                                         },
+        {"latency",             jt_lst_latency,         NULL,
+         "Usage: lst latency [--peers] [--reset] [--timeout #] NAME | IDS ..."          },
         {"add_batch",           jt_lst_add_batch,       NULL,
          "Usage: lst add_batch NAME"                                                    },
         {"run",                 jt_lst_start_batch,     NULL,
@@ -2334,6 +2334,9 @@ struct cl_io {
                         struct cl_io_rw_common wr;
                         int                    wr_append;
 			int                    wr_sync;
+			/* written pages are dropped from the cache once the
+			 * transfer completes */
+			int                    wr_stream;
                 } ci_wr;
                 struct cl_io_rw_common ci_rw;
                 struct cl_setattr_io {
@@ -3083,6 +3086,14 @@ static inline int cl_io_is_sync_write(const struct cl_io *io)
 	return io->ci_type == CIT_WRITE && io->u.ci_wr.wr_sync;
 }
 
+/**
+ * True, iff \a io is a streaming write(2) whose pages need not be cached.
+ */
+static inline int cl_io_is_stream_write(const struct cl_io *io)
+{
+	return io->ci_type == CIT_WRITE && io->u.ci_wr.wr_stream;
+}
+
 static inline int cl_io_is_mkwrite(const struct cl_io *io)
 {
 	return io->ci_type == CIT_FAULT && io->u.ci_fault.ft_mkwrite;
@@ -90,6 +90,9 @@ struct dt_device_param {
         /* per-fragment grant overhead to be used by client for grant
          * calculation */
         int                ddp_grant_frag;
+	/* OBD_INCOMPAT_* flags the on-disk format of the OSD requires from
+	 * the target, so that older versions refuse to mount it */
+	__u32              ddp_incompat;
 };
 
 /**
@@ -94,6 +94,10 @@ enum {
          LPROC_LL_LISTXATTR,
          LPROC_LL_REMOVEXATTR,
          LPROC_LL_INODE_PERM,
+         LPROC_LL_XATTR_HITS,
+         LPROC_LL_XATTR_MISSES,
+         LPROC_LL_LAZY_SIZE,
+         LPROC_LL_GLIMPSE_CACHED,
          LPROC_LL_FILE_OPCODES
 };
 
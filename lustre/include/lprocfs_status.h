@@ -130,12 +130,18 @@ struct rename_stats {
  * squares (for multi-valued counter samples only). This allows
  * external computation of standard deviation, but involves a 64-bit
  * multiply per counter increment.
+ *
+ * LPROCFS_CNTR_HISTOGRAM indicates that the counter samples should also
+ * be tallied in a per-cpu log2 histogram, so that percentiles (e.g. the
+ * tail latency of an RPC opcode) can be reported in "<stats>_latency"
+ * next to the stats file.
  */
 
 enum {
         LPROCFS_CNTR_EXTERNALLOCK = 0x0001,
         LPROCFS_CNTR_AVGMINMAX    = 0x0002,
         LPROCFS_CNTR_STDDEV       = 0x0004,
+        LPROCFS_CNTR_HISTOGRAM    = 0x0008,
 
         /* counter data type */
         LPROCFS_TYPE_REGS         = 0x0100,
@@ -146,6 +152,9 @@ enum {
 
 #define LC_MIN_INIT ((~(__u64)0) >> 1)
 
+/* # of log2 buckets of a counter histogram */
+#define LPROCFS_HIST_MAX	32
+
 struct lprocfs_counter_header {
 	unsigned int		lc_config;
 	const char		*lc_name;   /* must be static */
@@ -207,6 +216,9 @@ struct lprocfs_stats {
 
 	/* has ls_num of counter headers */
 	struct lprocfs_counter_header	*ls_cnt_header;
+	/* per-cpu histograms of LPROCFS_CNTR_HISTOGRAM counters, each has
+	 * LPROCFS_HIST_MAX buckets for every counter */
+	__u32				**ls_hist;
 	struct lprocfs_percpu		*ls_percpu[0];
 };
 
@@ -338,6 +338,25 @@ extern void lustre_som_swab(struct som_attrs *attrs);
 
 #define SOM_INCOMPAT_SUPP 0x0
 
+/**
+ * Lazy size-on-MDT attributes stored in a separate xattr.  They are saved
+ * by the last writer's close and are not kept consistent with the OST
+ * objects, so they may only be used as a hint (see OBD_MD_FLLAZYSIZE).
+ */
+struct lsom_attrs {
+	/** Bitfield for supported data in this structure. For future use. */
+	__u32	lsa_compat;
+	/** Incompat feature list, see LSOM_INCOMPAT_SUPP */
+	__u32	lsa_incompat;
+	/** file size at the last close for write */
+	__u64	lsa_size;
+	/** fs blocks at the last close for write */
+	__u64	lsa_blocks;
+};
+extern void lustre_lsom_swab(struct lsom_attrs *attrs);
+
+#define LSOM_INCOMPAT_SUPP 0x0
+
 /**
  * HSM on-disk attributes stored in a separate xattr.
  */
@@ -1187,6 +1206,7 @@ extern void lustre_swab_ptlrpc_body(struct ptlrpc_body *pb);
 #define OBD_CONNECT_LIGHTWEIGHT 0x1000000000000ULL/* lightweight connection */
 #define OBD_CONNECT_SHORTIO     0x2000000000000ULL/* short io */
 #define OBD_CONNECT_PINGLESS	0x4000000000000ULL/* pings not required */
+#define OBD_CONNECT_XATTR_ALL	0x8000000000000ULL/* getxattr of all xattrs */
 /* XXX README XXX:
  * Please DO NOT add flag values here before first ensuring that this same
  * flag value is not in use on some other branch.  Please clear any such
@@ -1227,7 +1247,7 @@ extern void lustre_swab_ptlrpc_body(struct ptlrpc_body *pb);
 				OBD_CONNECT_EINPROGRESS | \
 				OBD_CONNECT_LIGHTWEIGHT | OBD_CONNECT_UMASK | \
 				OBD_CONNECT_LVB_TYPE | OBD_CONNECT_LAYOUTLOCK |\
-				OBD_CONNECT_PINGLESS)
+				OBD_CONNECT_PINGLESS | OBD_CONNECT_XATTR_ALL)
 #define OST_CONNECT_SUPPORTED  (OBD_CONNECT_SRVLOCK | OBD_CONNECT_GRANT | \
                                 OBD_CONNECT_REQPORTAL | OBD_CONNECT_VERSION | \
                                 OBD_CONNECT_TRUNCLOCK | OBD_CONNECT_INDEX | \
@@ -1244,7 +1264,7 @@ extern void lustre_swab_ptlrpc_body(struct ptlrpc_body *pb);
 				OBD_CONNECT_JOBSTATS | \
 				OBD_CONNECT_LIGHTWEIGHT | OBD_CONNECT_LVB_TYPE|\
 				OBD_CONNECT_LAYOUTLOCK | OBD_CONNECT_FID | \
-				OBD_CONNECT_PINGLESS)
+				OBD_CONNECT_PINGLESS | OBD_CONNECT_SHORTIO)
 #define ECHO_CONNECT_SUPPORTED (0)
 #define MGS_CONNECT_SUPPORTED  (OBD_CONNECT_VERSION | OBD_CONNECT_AT | \
 				OBD_CONNECT_FULL20 | OBD_CONNECT_IMP_RECOV | \
@@ -1396,6 +1416,8 @@ enum obdo_flags {
                                            * clients prior than 2.2 */
         OBD_FL_RECOV_RESEND = 0x00080000, /* recoverable resent */
         OBD_FL_NOSPC_BLK    = 0x00100000, /* no more block space on OST */
+	OBD_FL_SHORT_IO     = 0x00200000, /* BRW data is carried inline in
+					   * RMF_SHORT_IO, not by bulk */
 
         /* Note that while these checksum values are currently separate bits,
          * in 2.x we can actually allow all values from 1-31 if we wanted. */
@@ -1406,6 +1428,9 @@ enum obdo_flags {
         OBD_FL_LOCAL_MASK   = 0xF0000000,
 };
 
+/* largest BRW whose data may travel in the RPC itself, see OBD_FL_SHORT_IO */
+#define OBD_MAX_SHORT_IO_BYTES	(16 * 1024)
+
 #define LOV_MAGIC_V1      0x0BD10BD0
 #define LOV_MAGIC         LOV_MAGIC_V1
 #define LOV_MAGIC_JOIN_V1 0x0BD20BD0
@@ -1471,9 +1496,22 @@ struct lov_mds_md_v1 {            /* LOV EA mds/wire data (little-endian) */
 #define XATTR_NAME_FID          "trusted.fid"
 #define XATTR_NAME_VERSION      "trusted.version"
 #define XATTR_NAME_SOM		"trusted.som"
+#define XATTR_NAME_LSOM		"trusted.lsom"
 #define XATTR_NAME_HSM		"trusted.hsm"
 #define XATTR_NAME_LFSCK_NAMESPACE "trusted.lfsck_namespace"
 
+/* xattrs the MDT changes without revoking the UPDATE lock (linkEA on
+ * rename/link, HSM state, SOM and lazy SOM on close), so a client can't
+ * keep them in its xattr cache; the MDT only lists them by name in the
+ * reply to OBD_MD_FLXATTRALL */
+static inline int xattr_is_uncached(const char *name)
+{
+	return strcmp(name, XATTR_NAME_LINK) == 0 ||
+	       strcmp(name, XATTR_NAME_HSM) == 0 ||
+	       strcmp(name, XATTR_NAME_SOM) == 0 ||
+	       strcmp(name, XATTR_NAME_LSOM) == 0;
+}
+
 
 struct lov_mds_md_v3 {            /* LOV EA mds/wire data (little-endian) */
         __u32 lmm_magic;          /* magic number = LOV_MAGIC_V3 */
@@ -1542,6 +1580,10 @@ struct lov_mds_md_v3 {            /* LOV EA mds/wire data (little-endian) */
 #define OBD_MD_FLGETATTRLOCK (0x0000200000000000ULL) /* Get IOEpoch attributes
                                                       * under lock */
 #define OBD_MD_FLOBJCOUNT    (0x0000400000000000ULL) /* for multiple destroy */
+/* all xattr names and values in one MDS_GETXATTR reply. RMF_EADATA holds
+ * back-to-back entries of a NUL-terminated name, a __u32 little-endian
+ * value length and the value itself, with no padding */
+#define OBD_MD_FLXATTRALL    (0x0000800000000000ULL)
 
 #define OBD_MD_FLRMTLSETFACL (0x0001000000000000ULL) /* lfs lsetfacl case */
 #define OBD_MD_FLRMTLGETFACL (0x0002000000000000ULL) /* lfs lgetfacl case */
@@ -1549,6 +1591,9 @@ struct lov_mds_md_v3 {            /* LOV EA mds/wire data (little-endian) */
 #define OBD_MD_FLRMTRGETFACL (0x0008000000000000ULL) /* lfs rgetfacl case */
 
 #define OBD_MD_FLDATAVERSION (0x0010000000000000ULL) /* iversion sum */
+/* in a getattr request: the client accepts a lazy size; in the reply: size
+ * and blocks hold the lazy size-on-MDT, which may be stale */
+#define OBD_MD_FLLAZYSIZE    (0x0020000000000000ULL)
 
 #define OBD_MD_FLGETATTR (OBD_MD_FLID    | OBD_MD_FLATIME | OBD_MD_FLMTIME | \
                           OBD_MD_FLCTIME | OBD_MD_FLSIZE  | OBD_MD_FLBLKSZ | \
@@ -2201,6 +2246,8 @@ enum {
 	MDS_DATA_MODIFIED	= 1 << 9,
 	MDS_CREATE_VOLATILE	= 1 << 10,
 	MDS_OWNEROVERRIDE	= 1 << 11,
+	MDS_LAZY_SIZE		= 1 << 12, /* close has size and blocks
+					    * the client holds locks for */
 };
 
 /* instance of mdt_reint_rec */
@@ -238,6 +238,7 @@ typedef struct lu_fid lustre_fid;
 #define LL_FILE_LOCKED_DIRECTIO 0x00000008 /* client-side locks with dio */
 #define LL_FILE_LOCKLESS_IO     0x00000010 /* server-side locks with cio */
 #define LL_FILE_RMTACL          0x00000020
+#define LL_FILE_STREAM          0x00000040 /* drop written pages after I/O */
 
 #define LOV_USER_MAGIC_V1 0x0BD10BD0
 #define LOV_USER_MAGIC    LOV_USER_MAGIC_V1
@@ -355,6 +355,11 @@ static inline int exp_connect_layout(struct obd_export *exp)
 	return !!(exp_connect_flags(exp) & OBD_CONNECT_LAYOUTLOCK);
 }
 
+static inline int exp_connect_xattr_all(struct obd_export *exp)
+{
+	return !!(exp_connect_flags(exp) & OBD_CONNECT_XATTR_ALL);
+}
+
 static inline bool exp_connect_lvb_type(struct obd_export *exp)
 {
 	LASSERT(exp != NULL);
@@ -71,6 +71,7 @@ struct adaptive_timeout {
 };
 
 struct ptlrpc_at_array {
+	spinlock_t	  paa_lock;	  /** serialize the array */
         cfs_list_t       *paa_reqs_array; /** array to hold requests */
         __u32             paa_size;       /** the size of array */
         __u32             paa_count;      /** the total count of reqs */
@@ -135,6 +135,16 @@ int llog_open(const struct lu_env *env, struct llog_ctxt *ctxt,
 	      char *name, enum llog_open_param open_param);
 int llog_close(const struct lu_env *env, struct llog_handle *cathandle);
 int llog_get_size(struct llog_handle *loghandle);
+int llog_chunk_cache_init(struct llog_ctxt *ctxt);
+void llog_chunk_cache_fini(struct llog_ctxt *ctxt);
+int llog_chunk_cache_stats(struct llog_ctxt *ctxt, char *page, int count);
+int llog_chunk_cache_lookup(struct llog_ctxt *ctxt, struct llog_logid *logid,
+			    int *cur_idx, int next_idx, __u64 *cur_offset,
+			    void *buf, int *gen);
+void llog_chunk_cache_insert(struct llog_ctxt *ctxt, struct llog_logid *logid,
+			     __u64 offset, int cur_idx, int next_idx,
+			     __u64 end_offset, int end_idx, void *buf, int gen);
+void llog_chunk_cache_forget(struct llog_ctxt *ctxt, struct llog_logid *logid);
 
 /* llog_process flags */
 #define LLOG_FLAG_NODEAMON 0x0001
@@ -393,6 +403,8 @@ struct llog_ctxt {
         void                    *llog_proc_cb;
         long                     loc_flags; /* flags, see above defines */
 	struct dt_object	*loc_dir;
+	/* chunks shared by remote readers, see llog_chunk_cache_init() */
+	struct llog_chunk_cache	*loc_chunk_cache;
 };
 
 #define LCM_NAME_SIZE 64
@@ -646,6 +658,9 @@ static inline int llog_destroy(const struct lu_env *env,
 		RETURN(-EOPNOTSUPP);
 
 	rc = lop->lop_destroy(env, handle);
+	if (rc == 0 && handle->lgh_ctxt != NULL &&
+	    handle->lgh_ctxt->loc_chunk_cache != NULL)
+		llog_chunk_cache_forget(handle->lgh_ctxt, &handle->lgh_id);
 	RETURN(rc);
 }
 
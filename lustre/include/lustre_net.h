@@ -390,6 +390,21 @@
 #define OST_MAXREQSIZE  (5 * 1024)
 #define OST_MAXREPSIZE  (9 * 1024)
 
+/**
+ * The OST_IO portal also receives and answers short I/O carrying its data.
+ *
+ * - OST_IO_BUFSIZE must exceed OST_IO_MAXREQSIZE, LNet unlinks a buffer once
+ *   less than that is left in it, so only about 11KB of a 32KB buffer can
+ *   be filled after its first request and a 16KB short write takes a whole
+ *   buffer
+ * - OST_IO_NBUFS therefore stays OST_NBUFS, so that bursts of small writes
+ *   find at least as many posted buffers as with OST_BUFSIZE
+ */
+#define OST_IO_MAXREQSIZE	(OST_MAXREQSIZE + OBD_MAX_SHORT_IO_BYTES)
+#define OST_IO_MAXREPSIZE	(OST_MAXREPSIZE + OBD_MAX_SHORT_IO_BYTES)
+#define OST_IO_BUFSIZE		(32 * 1024)
+#define OST_IO_NBUFS		OST_NBUFS
+
 /* Macro to hide a typecast. */
 #define ptlrpc_req_async_args(req) ((void *)&req->rq_async_args)
 
@@ -1353,6 +1368,8 @@ struct ptlrpc_request {
 	/** @} nrs */
         /** the index of service's srv_at_array into which request is linked */
         time_t rq_at_index;
+	/** which of the partition's AT arrays the request is linked into */
+	__u32 rq_at_array;
         /** Lock to protect request flags and some other important bits, like
          * rq_list
          */
@@ -2036,6 +2053,9 @@ struct ptlrpc_service {
 	int				srv_nthrs_cpt_init;
 	/** limit of threads number for each partition */
 	int				srv_nthrs_cpt_limit;
+	/** seconds a thread above srv_nthrs_cpt_init may stay idle before
+	 * it exits, 0 to never shrink the thread pool */
+	int				srv_nthrs_idle_timeout;
         /** Root of /proc dir tree for this service */
         cfs_proc_dir_entry_t           *srv_procroot;
         /** Pointer to statistic data for this service */
@@ -2091,7 +2111,8 @@ struct ptlrpc_service {
  * \a scp_req_lock
  *    serialize operations active requests sent to this portal
  * \a scp_at_lock
- *    serialize adaptive timeout stuff
+ *    serialize arming of the early reply timer, each of the AT arrays
+ *    has its own lock (ptlrpc_at_array::paa_lock)
  * \a scp_rep_lock
  *    serialize operations on RS list (reply states)
  *
@@ -2113,6 +2134,10 @@ struct ptlrpc_service_part {
 	int				scp_nthrs_running;
 	/** service threads list */
 	cfs_list_t			scp_threads;
+	/** moving average of the time requests wait in queue (usec) */
+	long				scp_wait_avg;
+	/** histogram of the time requests wait in queue (log2 usec) */
+	struct obd_histogram		scp_wait_hist;
 
 	/**
 	 * serialize the following fields, used for protecting
@@ -2136,6 +2161,19 @@ struct ptlrpc_service_part {
 	cfs_list_t			scp_req_incoming;
 	/** timeout before re-posting reqs, in tick */
 	cfs_duration_t			scp_rqbd_timeout;
+	/** # posted request buffers the pool is currently sized for */
+	int				scp_rqbd_target;
+	/** measured request arrival rate, reqs/sec */
+	int				scp_rqbd_rate;
+	/** average size of incoming requests, in bytes */
+	int				scp_rqbd_msgsize;
+	/** # reqs and bytes arrived since scp_rqbd_sampled */
+	int				scp_rqbd_arrivals;
+	long				scp_rqbd_bytes;
+	/** last time the arrival rate was sampled, in seconds */
+	time_t				scp_rqbd_sampled;
+	/** last time we failed to allocate a request buffer, in seconds */
+	time_t				scp_rqbd_squeezed;
 	/**
 	 * all threads sleep on this. This wait-queue is signalled when new
 	 * incoming request arrives and when difficult reply has to be handled.
@@ -2175,14 +2213,20 @@ struct ptlrpc_service_part {
 	/** AT stuff */
 	/** @{ */
 	/**
-	 * serialize the following fields, used for changes on
-	 * adaptive timeout
+	 * serialize the following fields, used for arming the
+	 * early reply timer
 	 */
 	spinlock_t			scp_at_lock __cfs_cacheline_aligned;
 	/** estimated rpc service time */
 	struct adaptive_timeout		scp_at_estimate;
-	/** reqs waiting for replies */
-	struct ptlrpc_at_array		scp_at_array;
+	/** reqs waiting for replies, one timing wheel per CPU */
+	struct ptlrpc_at_array	       *scp_at_arrays;
+	/** # of timing wheels in scp_at_arrays */
+	int				scp_at_narrays;
+	/** timing wheel of each CPU, NULL if there is only one */
+	__u8			       *scp_at_cpu_index;
+	/** deadline the early reply timer is armed for, -1 if none */
+	time_t				scp_at_armed;
 	/** early reply timer */
 	cfs_timer_t			scp_at_timer;
 	/** debug */
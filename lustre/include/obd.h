@@ -422,6 +422,13 @@ enum {
 
 struct mdc_rpc_lock;
 struct obd_import;
+/* one part of the cached page LRU of an OSC, per CPU partition */
+struct cl_lru_shard {
+	client_obd_lock_t	 cls_lock;
+	cfs_list_t		 cls_list;
+	cfs_list_t		 cls_stream; /* clean pages of stream writes */
+};
+
 struct client_obd {
 	struct rw_semaphore  cl_sem;
         struct obd_uuid          cl_target_uuid;
@@ -496,6 +503,18 @@ struct client_obd {
 	cfs_atomic_t             cl_pending_r_pages;
 	int                      cl_max_pages_per_rpc;
         int                      cl_max_rpcs_in_flight;
+	/* adapt cl_max_rpcs_in_flight to the BRW RPC time between the
+	 * bounds below, see osc_rif_update() */
+	int                      cl_rif_auto;
+	int                      cl_rif_min;
+	int                      cl_rif_max;
+	int                      cl_rif_samples; /* RPCs in this window */
+	long                     cl_rif_rtt;     /* smoothed, usec */
+	long                     cl_rif_base_rtt; /* uncongested, usec */
+	unsigned int             cl_rif_srv_est; /* server AT estimate */
+	/* BRWs up to this many bytes carry their data in the RPC itself
+	 * when the OST supports OBD_CONNECT_SHORTIO, 0 disables it */
+	int                      cl_short_io_bytes;
         struct obd_histogram     cl_read_rpc_hist;
         struct obd_histogram     cl_write_rpc_hist;
         struct obd_histogram     cl_read_page_hist;
@@ -510,8 +529,11 @@ struct client_obd {
 	cfs_atomic_t		 cl_lru_busy;
 	cfs_atomic_t		 cl_lru_shrinkers;
 	cfs_atomic_t		 cl_lru_in_list;
-	cfs_list_t		 cl_lru_list; /* lru page list */
-	client_obd_lock_t	 cl_lru_list_lock; /* page list protector */
+	/* clean streamed pages on the cls_stream lists, to be dropped */
+	cfs_atomic_t		 cl_lru_stream;
+	struct cl_lru_shard	**cl_lru_shards; /* per-CPT lru page lists */
+	cfs_atomic_t		 cl_lru_scanned; /* pages looked at by shrink */
+	cfs_atomic_t		 cl_lru_reclaimed; /* pages dropped by shrink */
 
         /* number of in flight destroy rpcs is limited to max_rpcs_in_flight */
         cfs_atomic_t             cl_destroy_in_flight;
@@ -705,6 +727,9 @@ struct lov_obd {
 
 	/* Cached LRU pages from upper layer */
 	void		       *lov_cache;
+	/* # of stripe chunks one read/write iteration may span, 0 means
+	 * a full stripe width */
+	int			lov_rw_stripes;
 };
 
 struct lmv_tgt_desc {
@@ -713,12 +738,15 @@ struct lmv_tgt_desc {
 	int			ltd_idx;
 	struct mutex		ltd_fid_mutex;
 	unsigned long		ltd_active:1; /* target up for requests */
+	__u64			ltd_qos_weight; /* from the cached statfs */
+	__u32			ltd_qos_creates; /* recent QoS placements */
 };
 
 enum placement_policy {
         PLACEMENT_CHAR_POLICY   = 0,
         PLACEMENT_NID_POLICY    = 1,
-        PLACEMENT_INVAL_POLICY  = 2,
+	PLACEMENT_QOS_POLICY	= 2,
+	PLACEMENT_INVAL_POLICY	= 3,
         PLACEMENT_MAX_POLICY
 };
 
@@ -729,6 +757,7 @@ struct lmv_obd {
 	struct lu_client_fld	lmv_fld;
 	spinlock_t		lmv_lock;
 	placement_policy_t	lmv_placement;
+	cfs_time_t		lmv_qos_age; /* last decay of ltd_qos_creates */
 	struct lmv_desc		desc;
 	struct obd_uuid		cluuid;
 	struct obd_export	*exp;
@@ -1274,6 +1303,8 @@ struct md_op_data {
 enum op_cli_flags {
 	CLI_SET_MEA	= 1 << 0,
 	CLI_RM_ENTRY	= 1 << 1,
+	CLI_LAZY_SIZE	= 1 << 2, /* getattr may return the lazy size */
+	CLI_QOS_MDT	= 1 << 3, /* remote dir MDT picked by QoS placement */
 };
 
 struct md_enqueue_info;
@@ -356,6 +356,14 @@ int client_obd_setup(struct obd_device *obddev, struct lustre_cfg *lcfg)
 	cli->cl_r_in_flight = 0;
 	cli->cl_w_in_flight = 0;
 
+	cli->cl_rif_auto = 0;
+	cli->cl_rif_samples = 0;
+	cli->cl_rif_rtt = 0;
+	cli->cl_rif_base_rtt = 0;
+	cli->cl_rif_srv_est = 0;
+	cli->cl_short_io_bytes = min_t(int, CFS_PAGE_SIZE,
+				       OBD_MAX_SHORT_IO_BYTES);
+
 	spin_lock_init(&cli->cl_read_rpc_hist.oh_lock);
 	spin_lock_init(&cli->cl_write_rpc_hist.oh_lock);
 	spin_lock_init(&cli->cl_read_page_hist.oh_lock);
@@ -368,8 +376,10 @@ int client_obd_setup(struct obd_device *obddev, struct lustre_cfg *lcfg)
 	cfs_atomic_set(&cli->cl_lru_shrinkers, 0);
 	cfs_atomic_set(&cli->cl_lru_busy, 0);
 	cfs_atomic_set(&cli->cl_lru_in_list, 0);
-	CFS_INIT_LIST_HEAD(&cli->cl_lru_list);
-	client_obd_list_lock_init(&cli->cl_lru_list_lock);
+	cfs_atomic_set(&cli->cl_lru_stream, 0);
+	cli->cl_lru_shards = NULL;
+	cfs_atomic_set(&cli->cl_lru_scanned, 0);
+	cfs_atomic_set(&cli->cl_lru_reclaimed, 0);
 
         cfs_waitq_init(&cli->cl_destroy_waitq);
         cfs_atomic_set(&cli->cl_destroy_in_flight, 0);
@@ -404,6 +414,8 @@ int client_obd_setup(struct obd_device *obddev, struct lustre_cfg *lcfg)
 		else
 			cli->cl_max_rpcs_in_flight = OSC_MAX_RIF_DEFAULT;
         }
+	cli->cl_rif_min = 1;
+	cli->cl_rif_max = min(cli->cl_max_rpcs_in_flight * 4, OSC_MAX_RIF_MAX);
         rc = ldlm_get_ref();
         if (rc) {
                 CERROR("ldlm_get_ref failed: %d\n", rc);
@@ -1965,7 +1965,7 @@ llu_fsswop_mount(const char *source,
                                 OBD_CONNECT_VERSION | OBD_CONNECT_TRUNCLOCK |
                                 OBD_CONNECT_FID | OBD_CONNECT_AT |
 				OBD_CONNECT_FULL20 | OBD_CONNECT_EINPROGRESS |
-				OBD_CONNECT_LVB_TYPE;
+				OBD_CONNECT_LVB_TYPE | OBD_CONNECT_SHORTIO;
 
         ocd.ocd_version = LUSTRE_VERSION_CODE;
         err = obd_connect(NULL, &sbi->ll_dt_exp, obd, &sbi->ll_sb_uuid, &ocd, NULL);
@@ -86,6 +86,26 @@ void ll_pack_inode2opdata(struct inode *inode, struct md_op_data *op_data,
 		op_data->op_bias |= MDS_DATA_MODIFIED;
 }
 
+/**
+ * Let the MDT save the size and blocks of this close as the lazy size only
+ * if they are current: this client must hold locks covering the whole file
+ * and have no dirty pages, whose blocks the OSTs don't count yet.
+ * cl_local_size() also refreshes i_size and i_blocks from those locks.
+ */
+static void ll_lazy_size_close(struct inode *inode, struct md_op_data *op_data)
+{
+	struct ll_inode_info *lli = ll_i2info(inode);
+	struct ccc_object *club = cl2ccc(lli->lli_clob);
+	int dirty;
+
+	spin_lock(&lli->lli_lock);
+	dirty = !cfs_list_empty(&club->cob_pending_list);
+	spin_unlock(&lli->lli_lock);
+
+	if (!dirty && cl_local_size(inode) == 0)
+		op_data->op_bias |= MDS_LAZY_SIZE;
+}
+
 /**
  * Closes the IO epoch and packs all the attributes into @op_data for
  * the CLOSE rpc.
@@ -101,9 +121,11 @@ static void ll_prepare_close(struct inode *inode, struct md_op_data *op_data,
         if (!(och->och_flags & FMODE_WRITE))
                 goto out;
 
-        if (!exp_connect_som(ll_i2mdexp(inode)) || !S_ISREG(inode->i_mode))
+        if (!exp_connect_som(ll_i2mdexp(inode)) || !S_ISREG(inode->i_mode)) {
                 op_data->op_attr.ia_valid |= ATTR_SIZE | ATTR_BLOCKS;
-        else
+		if (S_ISREG(inode->i_mode))
+			ll_lazy_size_close(inode, op_data);
+	} else
                 ll_ioepoch_close(inode, op_data, &och, 0);
 
 out:
@@ -526,6 +548,10 @@ int ll_file_open(struct inode *inode, struct file *file)
                 GOTO(out_och_free, rc = -ENOMEM);
 
         fd->fd_file = file;
+	if (file->f_mode & FMODE_WRITE) {
+		ll_lazy_size_forget(inode);
+		ll_glimpse_forget(inode);
+	}
         if (S_ISDIR(inode->i_mode)) {
 		spin_lock(&lli->lli_sa_lock);
 		if (lli->lli_opendir_key == NULL && lli->lli_sai == NULL &&
@@ -839,6 +865,9 @@ void ll_io_init(struct cl_io *io, const struct file *file, int write)
 		io->u.ci_wr.wr_sync = file->f_flags & O_SYNC ||
 				      file->f_flags & O_DIRECT ||
 				      IS_SYNC(inode);
+		io->u.ci_wr.wr_stream =
+			!!(LUSTRE_FPRIVATE(file)->fd_flags & LL_FILE_STREAM) ||
+			!!(ll_i2sbi(inode)->ll_flags & LL_SBI_STREAM_WRITE);
 	}
         io->ci_obj     = ll_i2info(inode)->lli_clob;
         io->ci_lockreq = CILR_MAYBE;
@@ -2701,10 +2730,29 @@ out:
         return rc;
 }
 
+static int ll_inode_revalidate_size(struct inode *inode)
+{
+	/* if object isn't regular file, don't validate size */
+	if (!S_ISREG(inode->i_mode)) {
+		LTIME_S(inode->i_atime) = ll_i2info(inode)->lli_lvb.lvb_atime;
+		LTIME_S(inode->i_mtime) = ll_i2info(inode)->lli_lvb.lvb_mtime;
+		LTIME_S(inode->i_ctime) = ll_i2info(inode)->lli_lvb.lvb_ctime;
+		return 0;
+	}
+
+	/* the size, blocks and times merged into the inode by a recent
+	 * glimpse are still there, don't glimpse every stripe again */
+	if (ll_glimpse_cached(inode)) {
+		ll_stats_ops_tally(ll_i2sbi(inode), LPROC_LL_GLIMPSE_CACHED, 1);
+		return 0;
+	}
+
+	return ll_glimpse_size(inode);
+}
+
 int ll_inode_revalidate_it(struct dentry *dentry, struct lookup_intent *it,
                            __u64 ibits)
 {
-        struct inode *inode = dentry->d_inode;
         int rc;
         ENTRY;
 
@@ -2712,27 +2760,54 @@ int ll_inode_revalidate_it(struct dentry *dentry, struct lookup_intent *it,
 	if (rc != 0)
 		RETURN(rc);
 
-	/* if object isn't regular file, don't validate size */
-	if (!S_ISREG(inode->i_mode)) {
-		LTIME_S(inode->i_atime) = ll_i2info(inode)->lli_lvb.lvb_atime;
-		LTIME_S(inode->i_mtime) = ll_i2info(inode)->lli_lvb.lvb_mtime;
-		LTIME_S(inode->i_ctime) = ll_i2info(inode)->lli_lvb.lvb_ctime;
-	} else {
-		rc = ll_glimpse_size(inode);
-	}
+	rc = ll_inode_revalidate_size(dentry->d_inode);
         RETURN(rc);
 }
 
+/**
+ * Get the lazy size-on-MDT of a regular file if it is recent enough and the
+ * file is not open for write on this client, in which case the OSTs need
+ * not be glimpsed for stat().  The result may be stale.
+ */
+static int ll_lazy_size_get(struct inode *inode, __u64 *size, __u64 *blocks)
+{
+	struct ll_inode_info *lli = ll_i2info(inode);
+	unsigned int age = ll_i2sbi(inode)->ll_lazy_size_age;
+	int rc = 0;
+
+	if (age == 0 || !S_ISREG(inode->i_mode))
+		return 0;
+
+	spin_lock(&lli->lli_lock);
+	if (lli->lli_lazy_time != 0 && lli->lli_open_fd_write_count == 0 &&
+	    cfs_time_before(cfs_time_current(),
+			    cfs_time_add(lli->lli_lazy_time,
+					 cfs_time_seconds(age)))) {
+		*size = lli->lli_lazy_size;
+		*blocks = lli->lli_lazy_blocks;
+		rc = 1;
+	}
+	spin_unlock(&lli->lli_lock);
+
+	return rc;
+}
+
 int ll_getattr_it(struct vfsmount *mnt, struct dentry *de,
                   struct lookup_intent *it, struct kstat *stat)
 {
         struct inode *inode = de->d_inode;
         struct ll_sb_info *sbi = ll_i2sbi(inode);
         struct ll_inode_info *lli = ll_i2info(inode);
+	__u64 lazy_size = 0;
+	__u64 lazy_blocks = 0;
+	int lazy;
         int res = 0;
 
-        res = ll_inode_revalidate_it(de, it, MDS_INODELOCK_UPDATE |
-                                             MDS_INODELOCK_LOOKUP);
+	res = __ll_inode_revalidate_it(de, it, MDS_INODELOCK_UPDATE |
+					       MDS_INODELOCK_LOOKUP);
+	lazy = res == 0 && ll_lazy_size_get(inode, &lazy_size, &lazy_blocks);
+	if (res == 0 && !lazy)
+		res = ll_inode_revalidate_size(inode);
         ll_stats_ops_tally(sbi, LPROC_LL_GETATTR, 1);
 
         if (res)
@@ -2753,8 +2828,14 @@ int ll_getattr_it(struct vfsmount *mnt, struct dentry *de,
         stat->ctime = inode->i_ctime;
 	stat->blksize = 1 << inode->i_blkbits;
 
-        stat->size = i_size_read(inode);
-        stat->blocks = inode->i_blocks;
+	if (lazy) {
+		ll_stats_ops_tally(sbi, LPROC_LL_LAZY_SIZE, 1);
+		stat->size = lazy_size;
+		stat->blocks = lazy_blocks;
+	} else {
+		stat->size = i_size_read(inode);
+		stat->blocks = inode->i_blocks;
+	}
 
         return 0;
 }
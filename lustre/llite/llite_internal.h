@@ -126,6 +126,8 @@ enum lli_flags {
         LLIF_SRVLOCK            = (1 << 5),
 	/* File data is modified. */
 	LLIF_DATA_MODIFIED      = (1 << 6),
+	/* Xattrs don't fit in the xattr cache, don't try to fill it. */
+	LLIF_XATTR_NOCACHE      = (1 << 7),
 };
 
 struct ll_inode_info {
@@ -135,6 +137,11 @@ struct ll_inode_info {
 
 	spinlock_t			lli_lock;
 	struct posix_acl		*lli_posix_acl;
+	/* packed xattrs (see OBD_MD_FLXATTRALL), valid while an UPDATE
+	 * lock is held; protected by lli_lock */
+	char				*lli_xattrs;
+	int				 lli_xattrs_size; /* -1: not cached */
+	__u32				 lli_xattrs_gen;
 
 	cfs_hlist_head_t		*lli_remote_perms;
 	struct mutex				lli_rmtperm_mutex;
@@ -223,6 +230,14 @@ struct ll_inode_info {
 
 			struct rw_semaphore		f_glimpse_sem;
 			cfs_time_t			f_glimpse_time;
+			/* when the last successful glimpse merged the size,
+			 * blocks and times into the inode, 0 if not valid */
+			cfs_time_t			f_glimpse_valid_time;
+			/* lazy size-on-MDT from the last getattr reply,
+			 * protected by lli_lock, f_lazy_time 0 if none */
+			__u64				f_lazy_size;
+			__u64				f_lazy_blocks;
+			cfs_time_t			f_lazy_time;
 			cfs_list_t			f_agl_list;
 			__u64				f_agl_index;
 
@@ -253,6 +268,10 @@ struct ll_inode_info {
 #define lli_write_mutex         u.f.f_write_mutex
 #define lli_glimpse_sem 	u.f.f_glimpse_sem
 #define lli_glimpse_time	u.f.f_glimpse_time
+#define lli_glimpse_valid_time	u.f.f_glimpse_valid_time
+#define lli_lazy_size		u.f.f_lazy_size
+#define lli_lazy_blocks		u.f.f_lazy_blocks
+#define lli_lazy_time		u.f.f_lazy_time
 #define lli_agl_list		u.f.f_agl_list
 #define lli_agl_index		u.f.f_agl_index
 #define lli_async_rc		u.f.f_async_rc
@@ -401,6 +420,8 @@ enum stats_track_type {
 #define LL_SBI_VERBOSE        0x10000 /* verbose mount/umount */
 #define LL_SBI_LAYOUT_LOCK    0x20000 /* layout lock support */
 #define LL_SBI_USER_FID2PATH  0x40000 /* allow fid2path by unprivileged users */
+#define LL_SBI_XATTR_CACHE    0x80000 /* cache xattrs under UPDATE lock */
+#define LL_SBI_STREAM_WRITE  0x100000 /* drop written pages after I/O */
 
 #define LL_SBI_FLAGS { 	\
 	"nolck",	\
@@ -408,6 +429,7 @@ enum stats_track_type {
 	"flock",	\
 	"xattr",	\
 	"acl",		\
+	"???",		\
 	"rmt_client",	\
 	"mds_capa",	\
 	"oss_capa",	\
@@ -420,7 +442,9 @@ enum stats_track_type {
 	"agl",		\
 	"verbose",	\
 	"layout",	\
-	"user_fid2path" }
+	"user_fid2path",\
+	"xattr_cache",	\
+	"stream_write" }
 
 /* default value for ll_sb_info->contention_time */
 #define SBI_DEFAULT_CONTENTION_SECONDS     60
@@ -510,6 +534,13 @@ struct ll_sb_info {
                                                   * low hit ratio */
         atomic_t                  ll_agl_total;  /* AGL thread started count */
 
+	/* seconds the lazy size-on-MDT is used by stat() instead of
+	 * glimpsing the OSTs, 0 to always glimpse */
+	unsigned int		  ll_lazy_size_age;
+	/* milliseconds a glimpse result is reused by stat() without
+	 * holding an extent lock, 0 to always glimpse */
+	unsigned int		  ll_glimpse_cache_age;
+
         dev_t                     ll_sdev_orig; /* save s_dev before assign for
                                                  * clustred nfs */
         struct rmtacl_ctl_table   ll_rct;
@@ -1169,6 +1200,7 @@ ssize_t ll_getxattr(struct dentry *dentry, const char *name,
                     void *buffer, size_t size);
 ssize_t ll_listxattr(struct dentry *dentry, char *buffer, size_t size);
 int ll_removexattr(struct dentry *dentry, const char *name);
+void ll_xattr_cache_destroy(struct inode *inode);
 
 /* llite/remote_perm.c */
 extern cfs_mem_cache_t *ll_remote_perm_cachep;
@@ -1292,6 +1324,26 @@ int do_statahead_enter(struct inode *dir, struct dentry **dentry,
                        int only_unplug);
 void ll_stop_statahead(struct inode *dir, void *key);
 
+/* The lazy size-on-MDT can't be trusted once this client changes the size */
+static inline void ll_lazy_size_forget(struct inode *inode)
+{
+	struct ll_inode_info *lli = ll_i2info(inode);
+
+	if (!S_ISREG(inode->i_mode))
+		return;
+
+	spin_lock(&lli->lli_lock);
+	lli->lli_lazy_time = 0;
+	spin_unlock(&lli->lli_lock);
+}
+
+/* Nor can the attributes merged by the last glimpse, see ll_glimpse_cached() */
+static inline void ll_glimpse_forget(struct inode *inode)
+{
+	if (S_ISREG(inode->i_mode))
+		ll_i2info(inode)->lli_glimpse_valid_time = 0;
+}
+
 static inline int ll_glimpse_size(struct inode *inode)
 {
 	struct ll_inode_info *lli = ll_i2info(inode);
@@ -1300,10 +1352,24 @@ static inline int ll_glimpse_size(struct inode *inode)
 	down_read(&lli->lli_glimpse_sem);
 	rc = cl_glimpse_size(inode);
 	lli->lli_glimpse_time = cfs_time_current();
+	lli->lli_glimpse_valid_time = rc == 0 ? lli->lli_glimpse_time : 0;
 	up_read(&lli->lli_glimpse_sem);
 	return rc;
 }
 
+/* Whether the attributes merged by the last glimpse are recent enough to
+ * be returned by stat() again without glimpsing the OSTs. */
+static inline int ll_glimpse_cached(struct inode *inode)
+{
+	struct ll_inode_info *lli = ll_i2info(inode);
+	unsigned int age = ll_i2sbi(inode)->ll_glimpse_cache_age;
+	cfs_time_t valid = lli->lli_glimpse_valid_time;
+
+	return age != 0 && valid != 0 &&
+	       cfs_time_before(cfs_time_current(),
+			       cfs_time_add(valid, msecs_to_jiffies(age)));
+}
+
 static inline void
 ll_statahead_mark(struct inode *dir, struct dentry *dentry)
 {
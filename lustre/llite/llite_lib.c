@@ -144,6 +144,7 @@ static struct ll_sb_info *ll_init_sbi(void)
         cfs_atomic_set(&sbi->ll_sa_wrong, 0);
         cfs_atomic_set(&sbi->ll_agl_total, 0);
         sbi->ll_flags |= LL_SBI_AGL_ENABLED;
+	sbi->ll_flags |= LL_SBI_XATTR_CACHE;
 
         RETURN(sbi);
 }
@@ -218,7 +219,8 @@ static int client_common_fill_super(struct super_block *sb, char *md, char *dt,
                                   OBD_CONNECT_FULL20   | OBD_CONNECT_64BITHASH|
 				  OBD_CONNECT_EINPROGRESS |
 				  OBD_CONNECT_JOBSTATS | OBD_CONNECT_LVB_TYPE |
-				  OBD_CONNECT_LAYOUTLOCK | OBD_CONNECT_PINGLESS;
+				  OBD_CONNECT_LAYOUTLOCK | OBD_CONNECT_PINGLESS |
+				  OBD_CONNECT_XATTR_ALL;
 
         if (sbi->ll_flags & LL_SBI_SOM_PREVIEW)
                 data->ocd_connect_flags |= OBD_CONNECT_SOM;
@@ -386,6 +388,9 @@ static int client_common_fill_super(struct super_block *sb, char *md, char *dt,
 		sbi->ll_flags |= LL_SBI_LAYOUT_LOCK;
 	}
 
+	if (!(data->ocd_connect_flags & OBD_CONNECT_XATTR_ALL))
+		sbi->ll_flags &= ~LL_SBI_XATTR_CACHE;
+
 	obd = class_name2obd(dt);
 	if (!obd) {
 		CERROR("DT %s: not setup or attached\n", dt);
@@ -402,7 +407,8 @@ static int client_common_fill_super(struct super_block *sb, char *md, char *dt,
                                   OBD_CONNECT_MAXBYTES |
 				  OBD_CONNECT_EINPROGRESS |
 				  OBD_CONNECT_JOBSTATS | OBD_CONNECT_LVB_TYPE |
-				  OBD_CONNECT_LAYOUTLOCK | OBD_CONNECT_PINGLESS;
+				  OBD_CONNECT_LAYOUTLOCK | OBD_CONNECT_PINGLESS |
+				  OBD_CONNECT_SHORTIO;
 
         if (sbi->ll_flags & LL_SBI_SOM_PREVIEW)
                 data->ocd_connect_flags |= OBD_CONNECT_SOM;
@@ -875,6 +881,16 @@ static int ll_options(char *options, int *flags)
                         *flags &= ~tmp;
                         goto next;
                 }
+		tmp = ll_set_opt("stream_write", s1, LL_SBI_STREAM_WRITE);
+		if (tmp) {
+			*flags |= tmp;
+			goto next;
+		}
+		tmp = ll_set_opt("nostream_write", s1, LL_SBI_STREAM_WRITE);
+		if (tmp) {
+			*flags &= ~tmp;
+			goto next;
+		}
                 LCONSOLE_ERROR_MSG(0x152, "Unknown option '%s', won't mount.\n",
                                    s1);
                 RETURN(-EINVAL);
@@ -897,6 +913,9 @@ void ll_lli_init(struct ll_inode_info *lli)
 	lli->lli_maxbytes = MAX_LFS_FILESIZE;
 	spin_lock_init(&lli->lli_lock);
 	lli->lli_posix_acl = NULL;
+	lli->lli_xattrs = NULL;
+	lli->lli_xattrs_size = -1;
+	lli->lli_xattrs_gen = 0;
 	lli->lli_remote_perms = NULL;
 	mutex_init(&lli->lli_rmtperm_mutex);
         /* Do not set lli_fid, it has been initialized already. */
@@ -935,6 +954,8 @@ void ll_lli_init(struct ll_inode_info *lli)
 		mutex_init(&lli->lli_write_mutex);
 		init_rwsem(&lli->lli_glimpse_sem);
 		lli->lli_glimpse_time = 0;
+		lli->lli_lazy_time = 0;
+		lli->lli_glimpse_valid_time = 0;
 		CFS_INIT_LIST_HEAD(&lli->lli_agl_list);
 		lli->lli_agl_index = 0;
 		lli->lli_async_rc = 0;
@@ -1210,6 +1231,8 @@ void ll_clear_inode(struct inode *inode)
                 lli->lli_posix_acl = NULL;
         }
 #endif
+	ll_xattr_cache_destroy(inode);
+
         lli->lli_inode_magic = LLI_INODE_DEAD;
 
         ll_clear_inode_capas(inode);
@@ -1432,6 +1455,8 @@ int ll_setattr_raw(struct dentry *dentry, struct iattr *attr)
                 }
 
                 attr->ia_valid |= ATTR_MTIME | ATTR_CTIME;
+		ll_lazy_size_forget(inode);
+		ll_glimpse_forget(inode);
         }
 
         /* POSIX: check before ATTR_*TIME_SET set (from inode_change_ok) */
@@ -1813,6 +1838,17 @@ void ll_update_inode(struct inode *inode, struct lustre_md *md)
                         inode->i_blocks = body->blocks;
         }
 
+	/* The lazy size may be stale, keep it apart from i_size and let
+	 * ll_getattr_it() decide whether it can be used. */
+	if ((body->valid & (OBD_MD_FLLAZYSIZE | OBD_MD_FLSIZE)) ==
+	    OBD_MD_FLLAZYSIZE && S_ISREG(inode->i_mode)) {
+		spin_lock(&lli->lli_lock);
+		lli->lli_lazy_size = body->size;
+		lli->lli_lazy_blocks = body->blocks;
+		lli->lli_lazy_time = cfs_time_current();
+		spin_unlock(&lli->lli_lock);
+	}
+
         if (body->valid & OBD_MD_FLMDSCAPA) {
                 LASSERT(md->mds_capa);
                 ll_add_capa(inode, md->mds_capa);
@@ -2307,6 +2343,8 @@ struct md_op_data * ll_prep_md_op_data(struct md_op_data *op_data,
 	op_data->op_cap = cfs_curproc_cap_pack();
 	op_data->op_bias = 0;
 	op_data->op_cli_flags = 0;
+	if (ll_i2sbi(i1)->ll_lazy_size_age > 0)
+		op_data->op_cli_flags |= CLI_LAZY_SIZE;
 	if ((opc == LUSTRE_OPC_CREATE) && (name != NULL) &&
 	     filename_is_volatile(name, namelen, NULL))
 		op_data->op_bias |= MDS_CREATE_VOLATILE;
@@ -2376,6 +2414,9 @@ int ll_show_options(struct seq_file *seq, struct vfsmount *vfs)
 	if (sbi->ll_flags & LL_SBI_USER_FID2PATH)
 		seq_puts(seq, ",user_fid2path");
 
+	if (sbi->ll_flags & LL_SBI_STREAM_WRITE)
+		seq_puts(seq, ",stream_write");
+
         RETURN(0);
 }
 
@@ -699,6 +699,93 @@ static int ll_wr_lazystatfs(struct file *file, const char *buffer,
         return count;
 }
 
+static int ll_rd_xattr_cache(char *page, char **start, off_t off,
+			     int count, int *eof, void *data)
+{
+	struct super_block *sb = data;
+	struct ll_sb_info *sbi = ll_s2sbi(sb);
+
+	return snprintf(page, count, "%u\n",
+			(sbi->ll_flags & LL_SBI_XATTR_CACHE) ? 1 : 0);
+}
+
+static int ll_wr_xattr_cache(struct file *file, const char *buffer,
+			     unsigned long count, void *data)
+{
+	struct super_block *sb = data;
+	struct ll_sb_info *sbi = ll_s2sbi(sb);
+	int val, rc;
+
+	rc = lprocfs_write_helper(buffer, count, &val);
+	if (rc)
+		return rc;
+
+	if (val && !exp_connect_xattr_all(sbi->ll_md_exp))
+		return -EOPNOTSUPP;
+
+	if (val)
+		sbi->ll_flags |= LL_SBI_XATTR_CACHE;
+	else
+		sbi->ll_flags &= ~LL_SBI_XATTR_CACHE;
+
+	return count;
+}
+
+static int ll_rd_lazy_size_max_age(char *page, char **start, off_t off,
+				   int count, int *eof, void *data)
+{
+	struct super_block *sb = data;
+	struct ll_sb_info *sbi = ll_s2sbi(sb);
+
+	return snprintf(page, count, "%u\n", sbi->ll_lazy_size_age);
+}
+
+static int ll_wr_lazy_size_max_age(struct file *file, const char *buffer,
+				   unsigned long count, void *data)
+{
+	struct super_block *sb = data;
+	struct ll_sb_info *sbi = ll_s2sbi(sb);
+	int val, rc;
+
+	rc = lprocfs_write_helper(buffer, count, &val);
+	if (rc)
+		return rc;
+
+	if (val < 0)
+		return -ERANGE;
+
+	sbi->ll_lazy_size_age = val;
+	return count;
+}
+
+static int ll_rd_glimpse_cache_max_age_ms(char *page, char **start, off_t off,
+					  int count, int *eof, void *data)
+{
+	struct super_block *sb = data;
+	struct ll_sb_info *sbi = ll_s2sbi(sb);
+
+	return snprintf(page, count, "%u\n", sbi->ll_glimpse_cache_age);
+}
+
+static int ll_wr_glimpse_cache_max_age_ms(struct file *file,
+					  const char *buffer,
+					  unsigned long count, void *data)
+{
+	struct super_block *sb = data;
+	struct ll_sb_info *sbi = ll_s2sbi(sb);
+	int val, rc;
+
+	rc = lprocfs_write_helper(buffer, count, &val);
+	if (rc)
+		return rc;
+
+	if (val < 0)
+		return -ERANGE;
+
+	sbi->ll_glimpse_cache_age = val;
+	return count;
+}
+
 static int ll_rd_maxea_size(char *page, char **start, off_t off,
                             int count, int *eof, void *data)
 {
@@ -769,6 +856,11 @@ static struct lprocfs_vars lprocfs_llite_obd_vars[] = {
         { "statahead_agl",    ll_rd_statahead_agl, ll_wr_statahead_agl, 0 },
         { "statahead_stats",  ll_rd_statahead_stats, 0, 0 },
         { "lazystatfs",       ll_rd_lazystatfs, ll_wr_lazystatfs, 0 },
+	{ "xattr_cache",      ll_rd_xattr_cache, ll_wr_xattr_cache, 0 },
+	{ "lazy_size_max_age", ll_rd_lazy_size_max_age,
+			       ll_wr_lazy_size_max_age, 0 },
+	{ "glimpse_cache_max_age_ms", ll_rd_glimpse_cache_max_age_ms,
+				      ll_wr_glimpse_cache_max_age_ms, 0 },
         { "max_easize",       ll_rd_maxea_size, 0, 0 },
 	{ "sbi_flags",        ll_rd_sbi_flags, 0, 0 },
         { 0 }
@@ -825,6 +917,10 @@ struct llite_file_opcode {
         { LPROC_LL_LISTXATTR,      LPROCFS_TYPE_REGS, "listxattr" },
         { LPROC_LL_REMOVEXATTR,    LPROCFS_TYPE_REGS, "removexattr" },
         { LPROC_LL_INODE_PERM,     LPROCFS_TYPE_REGS, "inode_permission" },
+        { LPROC_LL_XATTR_HITS,     LPROCFS_TYPE_REGS, "getxattr_hits" },
+        { LPROC_LL_XATTR_MISSES,   LPROCFS_TYPE_REGS, "getxattr_misses" },
+        { LPROC_LL_LAZY_SIZE,      LPROCFS_TYPE_REGS, "getattr_lazy_size" },
+        { LPROC_LL_GLIMPSE_CACHED, LPROCFS_TYPE_REGS, "getattr_glimpse_cached" },
 };
 
 void ll_stats_ops_tally(struct ll_sb_info *sbi, int op, int count)
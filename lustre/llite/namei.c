@@ -271,8 +271,10 @@ int ll_md_blocking_ast(struct ldlm_lock *lock, struct ldlm_lock_desc *desc,
 				CDEBUG(D_INODE, "invaliding layout %d.\n", rc);
 		}
 
-                if (bits & MDS_INODELOCK_UPDATE)
+                if (bits & MDS_INODELOCK_UPDATE) {
                         lli->lli_flags &= ~LLIF_MDS_SIZE_LOCK;
+			ll_xattr_cache_destroy(inode);
+		}
 
                 if (S_ISDIR(inode->i_mode) &&
                      (bits & MDS_INODELOCK_UPDATE)) {
@@ -189,6 +189,12 @@ int ll_setxattr_common(struct inode *inode, const char *name,
                          valid, name, pv, size, 0, flags, ll_i2suppgid(inode),
                          &req);
         capa_put(oc);
+	/* the MDS revokes our UPDATE lock anyway, don't wait for that */
+	ll_xattr_cache_destroy(inode);
+	/* a smaller or removed xattr may let the rest fit in the cache */
+	spin_lock(&ll_i2info(inode)->lli_lock);
+	ll_i2info(inode)->lli_flags &= ~LLIF_XATTR_NOCACHE;
+	spin_unlock(&ll_i2info(inode)->lli_lock);
 #ifdef CONFIG_FS_POSIX_ACL
         if (new_value != NULL)
                 lustre_posix_acl_xattr_free(new_value, size);
@@ -274,6 +280,226 @@ int ll_removexattr(struct dentry *dentry, const char *name)
                                   OBD_MD_FLXATTRRM);
 }
 
+/*
+ * xattr cache
+ *
+ * All xattrs of an inode are fetched with a single OBD_MD_FLXATTRALL
+ * getxattr RPC and kept packed in ll_inode_info::lli_xattrs.  The cache
+ * is only filled while the client holds an UPDATE inodebits lock, which
+ * the MDS revokes before it changes any xattr; ll_md_blocking_ast() drops
+ * the cache when that lock is cancelled.  The xattrs of
+ * xattr_is_uncached(), e.g. the linkEA changed by rename under LOOKUP only
+ * or the HSM and SOM states, are the exception: the MDS sends no value for
+ * them and they are always fetched from the MDS.
+ */
+#define LL_XATTR_CACHE_MAX	(16 * 1024)
+
+void ll_xattr_cache_destroy(struct inode *inode)
+{
+	struct ll_inode_info	*lli = ll_i2info(inode);
+	char			*xattrs;
+	int			 size;
+
+	spin_lock(&lli->lli_lock);
+	xattrs = lli->lli_xattrs;
+	size = lli->lli_xattrs_size;
+	lli->lli_xattrs = NULL;
+	lli->lli_xattrs_size = -1;
+	lli->lli_xattrs_gen++;
+	spin_unlock(&lli->lli_lock);
+
+	if (xattrs != NULL)
+		OBD_FREE_LARGE(xattrs, size);
+}
+
+/* Is there an UPDATE lock that isn't already being cancelled? */
+static int ll_xattr_cache_covered(struct inode *inode)
+{
+	ldlm_policy_data_t	policy = {
+		.l_inodebits = { MDS_INODELOCK_UPDATE } };
+	struct lustre_handle	lockh;
+
+	return md_lock_match(ll_i2mdexp(inode),
+			     LDLM_FL_BLOCK_GRANTED | LDLM_FL_TEST_LOCK,
+			     ll_inode2fid(inode), LDLM_IBITS, &policy,
+			     LCK_CR | LCK_CW | LCK_PR | LCK_PW, &lockh) != 0;
+}
+
+/* Walk packed xattrs, return the next entry's name length including the
+ * NUL and its value, or 0 at the end, -EPROTO if the entry is corrupt */
+static int ll_xattr_cache_next(const char *p, const char *end,
+			       const char **value, __u32 *vlen)
+{
+	int	namelen;
+	__u32	len;
+
+	if (p >= end)
+		return 0;
+
+	namelen = strnlen(p, end - p) + 1;
+	if (namelen > end - p || end - p - namelen < sizeof(len))
+		return -EPROTO;
+
+	memcpy(&len, p + namelen, sizeof(len));
+	len = le32_to_cpu(len);
+	if (len > end - p - namelen - sizeof(len))
+		return -EPROTO;
+
+	*value = p + namelen + sizeof(len);
+	*vlen = len;
+	return namelen;
+}
+
+static int ll_xattr_cache_fill(struct inode *inode)
+{
+	struct ll_sb_info	*sbi = ll_i2sbi(inode);
+	struct ll_inode_info	*lli = ll_i2info(inode);
+	struct ptlrpc_request	*req = NULL;
+	struct mdt_body		*body;
+	struct obd_capa		*oc;
+	const char		*p;
+	const char		*value;
+	char			*xdata;
+	char			*xattrs = NULL;
+	__u32			 vlen;
+	__u32			 gen;
+	int			 size;
+	int			 rc;
+	ENTRY;
+
+	spin_lock(&lli->lli_lock);
+	gen = lli->lli_xattrs_gen;
+	spin_unlock(&lli->lli_lock);
+
+	if (!ll_xattr_cache_covered(inode))
+		RETURN(-ENOLCK);
+
+	oc = ll_mdscapa_get(inode);
+	rc = md_getxattr(sbi->ll_md_exp, ll_inode2fid(inode), oc,
+			 OBD_MD_FLXATTRALL, NULL, NULL, 0, LL_XATTR_CACHE_MAX,
+			 0, &req);
+	capa_put(oc);
+	if (rc == -ERANGE) {
+		/* too many xattrs, don't retry on every getxattr */
+		CDEBUG(D_INODE, "%s: xattrs of "DFID" exceed %d bytes\n",
+		       ll_get_fsname(inode->i_sb, NULL, 0),
+		       PFID(ll_inode2fid(inode)), LL_XATTR_CACHE_MAX);
+		spin_lock(&lli->lli_lock);
+		lli->lli_flags |= LLIF_XATTR_NOCACHE;
+		spin_unlock(&lli->lli_lock);
+	}
+	if (rc != 0)
+		RETURN(rc);
+
+	body = req_capsule_server_get(&req->rq_pill, &RMF_MDT_BODY);
+	LASSERT(body);
+
+	size = body->eadatasize;
+	if (size > 0) {
+		xdata = req_capsule_server_sized_get(&req->rq_pill,
+						     &RMF_EADATA, size);
+		if (xdata == NULL)
+			GOTO(out, rc = -EPROTO);
+
+		p = xdata;
+		while ((rc = ll_xattr_cache_next(p, xdata + size,
+						 &value, &vlen)) > 0)
+			p = value + vlen;
+		if (rc < 0)
+			GOTO(out, rc);
+
+		OBD_ALLOC_LARGE(xattrs, size);
+		if (xattrs == NULL)
+			GOTO(out, rc = -ENOMEM);
+		memcpy(xattrs, xdata, size);
+	}
+
+	spin_lock(&lli->lli_lock);
+	if (lli->lli_xattrs_gen == gen && lli->lli_xattrs_size < 0) {
+		lli->lli_xattrs = xattrs;
+		lli->lli_xattrs_size = size;
+		xattrs = NULL;
+	}
+	spin_unlock(&lli->lli_lock);
+
+	if (xattrs != NULL)
+		OBD_FREE_LARGE(xattrs, size);
+	rc = 0;
+	EXIT;
+out:
+	ptlrpc_req_finished(req);
+	return rc;
+}
+
+/* Look @name up in the cache, or list all names if it's NULL. Semantics
+ * match the uncached path below. Returns -EAGAIN if the cache can't
+ * answer, the caller then asks the MDS directly. */
+static int ll_xattr_cache_get(struct inode *inode, const char *name,
+			      char *buffer, size_t size)
+{
+	struct ll_sb_info	*sbi = ll_i2sbi(inode);
+	struct ll_inode_info	*lli = ll_i2info(inode);
+	const char		*p;
+	const char		*end;
+	const char		*value;
+	__u32			 vlen;
+	int			 namelen;
+	int			 filled = 0;
+	int			 rc;
+
+	if (name != NULL && xattr_is_uncached(name))
+		return -EAGAIN;
+
+again:
+	spin_lock(&lli->lli_lock);
+	if (lli->lli_flags & LLIF_XATTR_NOCACHE) {
+		spin_unlock(&lli->lli_lock);
+		return -EAGAIN;
+	}
+	if (lli->lli_xattrs_size < 0) {
+		spin_unlock(&lli->lli_lock);
+		if (filled)
+			return -EAGAIN;
+
+		ll_stats_ops_tally(sbi, LPROC_LL_XATTR_MISSES, 1);
+		if (ll_xattr_cache_fill(inode) != 0)
+			return -EAGAIN;
+		filled = 1;
+		goto again;
+	}
+
+	p = lli->lli_xattrs;
+	end = p + lli->lli_xattrs_size;
+	rc = name != NULL ? -ENODATA : 0;
+	while ((namelen = ll_xattr_cache_next(p, end, &value, &vlen)) > 0) {
+		if (name == NULL) {
+			if (size != 0 && rc + namelen <= size)
+				memcpy(buffer + rc, p, namelen);
+			rc += namelen;
+		} else if (strcmp(p, name) == 0) {
+			if (size == 0)
+				rc = vlen;
+			else if (size < vlen)
+				rc = -ERANGE;
+			else if (vlen == 0)
+				rc = -ENODATA;
+			else {
+				memcpy(buffer, value, vlen);
+				rc = vlen;
+			}
+			break;
+		}
+		p = value + vlen;
+	}
+	if (name == NULL && size != 0 && rc > size)
+		rc = -ERANGE;
+	spin_unlock(&lli->lli_lock);
+
+	if (!filled)
+		ll_stats_ops_tally(sbi, LPROC_LL_XATTR_HITS, 1);
+	return rc;
+}
+
 static
 int ll_getxattr_common(struct inode *inode, const char *name,
                        void *buffer, size_t size, __u64 valid)
@@ -352,6 +578,13 @@ int ll_getxattr_common(struct inode *inode, const char *name,
 #endif
 
 do_getxattr:
+	if ((sbi->ll_flags & LL_SBI_XATTR_CACHE) &&
+	    !(sbi->ll_flags & LL_SBI_RMT_CLIENT)) {
+		rc = ll_xattr_cache_get(inode, name, buffer, size);
+		if (rc != -EAGAIN)
+			RETURN(rc);
+	}
+
         oc = ll_mdscapa_get(inode);
         rc = md_getxattr(sbi->ll_md_exp, ll_inode2fid(inode), oc,
                          valid | (rce ? rce_ops2valid(rce->rce_ops) : 0),
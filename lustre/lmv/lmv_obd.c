@@ -955,6 +955,141 @@ static int lmv_choose_mds(struct lmv_obd *lmv, struct md_op_data *op_data,
 }
 #endif
 
+/* statfs results older than this are refreshed, and placements made since
+ * the previous refresh are aged out at the same pace */
+#define LMV_QOS_MAXAGE	5
+
+/* MDT weight = free inodes * free space, both scaled so the product of
+ * large targets fits in 64 bits; an MDT out of either gets no weight */
+static __u64 lmv_qos_statfs_weight(struct obd_statfs *osfs)
+{
+	__u64 ffree = osfs->os_ffree >> 8;
+	__u64 bavail = (osfs->os_bavail * osfs->os_bsize) >> 20;
+
+	if (osfs->os_ffree == 0 || osfs->os_bavail == 0)
+		return 0;
+
+	return (ffree + 1) * (bavail + 1);
+}
+
+/* statfs weight of \a tgt penalized by its recent placements, called with
+ * lmv_lock held */
+static __u64 lmv_qos_tgt_weight(struct lmv_tgt_desc *tgt)
+{
+	__u64 weight = tgt->ltd_qos_weight;
+
+	do_div(weight, tgt->ltd_qos_creates + 1);
+	return weight;
+}
+
+/**
+ * Pick an MDT for a new directory weighted by its free inodes and space,
+ * as reported by the (cached) MDT statfs, penalized by the number of
+ * directories placed there since the statfs was last refreshed.
+ *
+ * ltd_qos_weight keeps the statfs weight, the penalized one is computed
+ * when needed; both are only accessed under lmv_lock.
+ */
+static int lmv_qos_policy(struct obd_device *obd, mdsno_t *mds)
+{
+	struct lmv_obd		*lmv = &obd->u.lmv;
+	struct lmv_tgt_desc	*tgt;
+	struct obd_statfs	*osfs;
+	__u64			 max_age;
+	__u64			 total_weight = 0;
+	__u64			 weight;
+	__u64			 rand;
+	int			 i;
+	int			 rc = -EAGAIN;
+	ENTRY;
+
+	OBD_ALLOC_PTR(osfs);
+	if (osfs == NULL)
+		RETURN(-ENOMEM);
+
+	max_age = cfs_time_shift_64(-LMV_QOS_MAXAGE);
+	for (i = 0; i < lmv->desc.ld_tgt_count; i++) {
+		tgt = lmv->tgts[i];
+		if (tgt == NULL)
+			continue;
+
+		weight = 0;
+		if (tgt->ltd_active && tgt->ltd_exp != NULL &&
+		    obd_statfs(NULL, tgt->ltd_exp, osfs, max_age, 0) == 0)
+			weight = lmv_qos_statfs_weight(osfs);
+
+		spin_lock(&lmv->lmv_lock);
+		tgt->ltd_qos_weight = weight;
+		spin_unlock(&lmv->lmv_lock);
+	}
+
+	spin_lock(&lmv->lmv_lock);
+	if (cfs_time_aftereq(cfs_time_current(),
+			     cfs_time_add(lmv->lmv_qos_age,
+				cfs_time_seconds(LMV_QOS_MAXAGE)))) {
+		for (i = 0; i < lmv->desc.ld_tgt_count; i++)
+			if (lmv->tgts[i] != NULL)
+				lmv->tgts[i]->ltd_qos_creates >>= 1;
+		lmv->lmv_qos_age = cfs_time_current();
+	}
+
+	for (i = 0; i < lmv->desc.ld_tgt_count; i++) {
+		tgt = lmv->tgts[i];
+		if (tgt == NULL)
+			continue;
+		total_weight += lmv_qos_tgt_weight(tgt);
+	}
+
+	if (total_weight == 0)
+		GOTO(out, rc);
+
+#if BITS_PER_LONG == 32
+	/* If total_weight > 32-bit, first generate the high 32 bits of the
+	 * random number, then add in the low 32 bits (truncated to the upper
+	 * limit, if needed), as lod_alloc_qos() does */
+	if (total_weight > 0xffffffffULL)
+		rand = (__u64)(cfs_rand() %
+			       (unsigned)(total_weight >> 32)) << 32;
+	else
+		rand = 0;
+
+	if (rand == (total_weight & 0xffffffff00000000ULL))
+		rand |= cfs_rand() % (unsigned)total_weight;
+	else
+		rand |= cfs_rand();
+#else
+	rand = ((__u64)cfs_rand() << 32 | cfs_rand()) % total_weight;
+#endif
+
+	weight = 0;
+	for (i = 0; i < lmv->desc.ld_tgt_count; i++) {
+		__u64 tgt_weight;
+
+		tgt = lmv->tgts[i];
+		if (tgt == NULL)
+			continue;
+		tgt_weight = lmv_qos_tgt_weight(tgt);
+		if (tgt_weight == 0)
+			continue;
+		weight += tgt_weight;
+		if (weight <= rand)
+			continue;
+
+		tgt->ltd_qos_creates++;
+		*mds = tgt->ltd_idx;
+		rc = 0;
+		break;
+	}
+	EXIT;
+out:
+	spin_unlock(&lmv->lmv_lock);
+	OBD_FREE_PTR(osfs);
+
+	CDEBUG(D_INODE, "%s: QoS placement on mds #%d: rc = %d\n",
+	       obd->obd_name, rc == 0 ? (int)*mds : -1, rc);
+	return rc;
+}
+
 /**
  * This is _inode_ placement policy function (not name).
  */
@@ -992,6 +1127,19 @@ static int lmv_placement_policy(struct obd_device *obd,
 			*mds = lum->lum_stripe_offset;
 			RETURN(0);
 		}
+
+		/* No MDT given (setdirstripe -i -1), balance new remote
+		 * directories over the MDTs if QoS placement is enabled,
+		 * otherwise keep them on the parent MDT.  Only administrators
+		 * may create remote directories, see mdt_md_create(). */
+		if (lum->lum_type == LMV_STRIPE_TYPE &&
+		    lmv->lmv_placement == PLACEMENT_QOS_POLICY &&
+		    cfs_capable(CFS_CAP_SYS_ADMIN) &&
+		    lmv_qos_policy(obd, mds) == 0) {
+			if (*mds != op_data->op_mds)
+				op_data->op_cli_flags |= CLI_QOS_MDT;
+			RETURN(0);
+		}
 	}
 
 	/* Allocate new fid on target according to operation type and parent
@@ -1093,6 +1241,7 @@ static int lmv_setup(struct obd_device *obd, struct lustre_cfg *lcfg)
 	lmv->max_def_easize = 0;
 	lmv->max_easize = 0;
 	lmv->lmv_placement = PLACEMENT_CHAR_POLICY;
+	lmv->lmv_qos_age = cfs_time_current();
 
 	spin_lock_init(&lmv->lmv_lock);
 	mutex_init(&lmv->init_mutex);
@@ -1173,59 +1322,124 @@ out:
 	RETURN(rc);
 }
 
+struct lmv_statfs_req {
+	struct obd_info		lsr_oi;
+	struct obd_statfs	lsr_osfs;
+	int			lsr_rc;
+};
+
+static int lmv_statfs_update(void *cookie, int rc)
+{
+	struct obd_info *oinfo = cookie;
+
+	container_of(oinfo, struct lmv_statfs_req, lsr_oi)->lsr_rc = rc;
+	return 0;
+}
+
+/**
+ * Collect statfs from all MDTs at once: the MDS_STATFS requests of every
+ * target whose cached statfs is older than \a max_age are sent in a single
+ * request set.  Inactive targets and targets which fail are left out of
+ * the sum, statfs only fails when no MDT answered.
+ */
 static int lmv_statfs(const struct lu_env *env, struct obd_export *exp,
                       struct obd_statfs *osfs, __u64 max_age, __u32 flags)
 {
-        struct obd_device     *obd = class_exp2obd(exp);
-        struct lmv_obd        *lmv = &obd->u.lmv;
-        struct obd_statfs     *temp;
-        int                    rc = 0;
-        int                    i;
-        ENTRY;
+	struct obd_device		*obd = class_exp2obd(exp);
+	struct lmv_obd			*lmv = &obd->u.lmv;
+	struct ptlrpc_request_set	*set;
+	struct lmv_statfs_req		*reqs;
+	struct lmv_statfs_req		*lsr;
+	struct obd_device		*tgt_obd;
+	int				 count;
+	int				 success = 0;
+	int				 rc = 0;
+	int				 i;
+	ENTRY;
 
-        rc = lmv_check_connect(obd);
-        if (rc)
-                RETURN(rc);
+	rc = lmv_check_connect(obd);
+	if (rc)
+		RETURN(rc);
 
-        OBD_ALLOC(temp, sizeof(*temp));
-        if (temp == NULL)
-                RETURN(-ENOMEM);
+	/* If the statfs is from mount, it only needs to retrieve the
+	 * necessary information from MDT0, i.e. mount does not need the
+	 * merged osfs from all of MDT. And also clients can be mounted as
+	 * long as MDT0 is in service. */
+	count = lmv->desc.ld_tgt_count;
+	if (flags & OBD_STATFS_FOR_MDT0)
+		count = 1;
 
-        for (i = 0; i < lmv->desc.ld_tgt_count; i++) {
+	OBD_ALLOC(reqs, sizeof(*reqs) * count);
+	if (reqs == NULL)
+		RETURN(-ENOMEM);
+
+	set = ptlrpc_prep_set();
+	if (set == NULL)
+		GOTO(out_free, rc = -ENOMEM);
+
+	for (i = 0; i < count; i++) {
+		lsr = &reqs[i];
+		lsr->lsr_rc = -ENODEV;
 		if (lmv->tgts[i] == NULL || lmv->tgts[i]->ltd_exp == NULL)
 			continue;
+		if (!lmv->tgts[i]->ltd_active && i != 0) {
+			CDEBUG(D_HA, "%s: MDT #%d inactive\n",
+			       obd->obd_name, i);
+			continue;
+		}
 
-		rc = obd_statfs(env, lmv->tgts[i]->ltd_exp, temp,
-				max_age, flags);
-		if (rc) {
-			CERROR("can't stat MDS #%d (%s), error %d\n", i,
-			       lmv->tgts[i]->ltd_exp->exp_obd->obd_name,
-			       rc);
-			GOTO(out_free_temp, rc);
+		lsr->lsr_oi.oi_osfs = &lsr->lsr_osfs;
+		lsr->lsr_oi.oi_flags = flags;
+		lsr->lsr_oi.oi_cb_up = lmv_statfs_update;
+		rc = obd_statfs_async(lmv->tgts[i]->ltd_exp, &lsr->lsr_oi,
+				      max_age, set);
+		if (rc)
+			lsr->lsr_rc = rc;
+	}
+
+	/* per-target results are collected by lmv_statfs_update() */
+	if (!cfs_list_empty(&set->set_requests))
+		ptlrpc_set_wait(set);
+	ptlrpc_set_destroy(set);
+
+	rc = 0;
+	for (i = 0; i < count; i++) {
+		lsr = &reqs[i];
+		if (lsr->lsr_rc != 0) {
+			if (lsr->lsr_rc != -ENODEV)
+				CERROR("%s: can't stat MDS #%d: rc = %d\n",
+				       obd->obd_name, i, lsr->lsr_rc);
+			if (rc == 0)
+				rc = lsr->lsr_rc;
+			continue;
 		}
 
-		if (i == 0) {
-			*osfs = *temp;
-			/* If the statfs is from mount, it will needs
-			 * retrieve necessary information from MDT0.
-			 * i.e. mount does not need the merged osfs
-			 * from all of MDT.
-			 * And also clients can be mounted as long as
-			 * MDT0 is in service*/
-			if (flags & OBD_STATFS_FOR_MDT0)
-				GOTO(out_free_temp, rc);
-                } else {
-                        osfs->os_bavail += temp->os_bavail;
-                        osfs->os_blocks += temp->os_blocks;
-                        osfs->os_ffree += temp->os_ffree;
-                        osfs->os_files += temp->os_files;
-                }
-        }
+		/* cache the fresh result in the MDC, as obd_statfs() does */
+		if (!(lsr->lsr_oi.oi_flags & OBD_STATFS_FROM_CACHE)) {
+			tgt_obd = class_exp2obd(lmv->tgts[i]->ltd_exp);
+			spin_lock(&tgt_obd->obd_osfs_lock);
+			memcpy(&tgt_obd->obd_osfs, &lsr->lsr_osfs,
+			       sizeof(tgt_obd->obd_osfs));
+			tgt_obd->obd_osfs_age = cfs_time_current_64();
+			spin_unlock(&tgt_obd->obd_osfs_lock);
+		}
 
-        EXIT;
-out_free_temp:
-        OBD_FREE(temp, sizeof(*temp));
-        return rc;
+		if (success++ == 0) {
+			*osfs = lsr->lsr_osfs;
+		} else {
+			osfs->os_bavail += lsr->lsr_osfs.os_bavail;
+			osfs->os_blocks += lsr->lsr_osfs.os_blocks;
+			osfs->os_ffree += lsr->lsr_osfs.os_ffree;
+			osfs->os_files += lsr->lsr_osfs.os_files;
+		}
+	}
+
+	if (success > 0)
+		rc = 0;
+	EXIT;
+out_free:
+	OBD_FREE(reqs, sizeof(*reqs) * count);
+	return rc;
 }
 
 static int lmv_getstatus(struct obd_export *exp,
@@ -1453,6 +1667,23 @@ int lmv_create(struct obd_export *exp, struct md_op_data *op_data,
 	rc = md_create(tgt->ltd_exp, op_data, data, datalen, mode, uid, gid,
 		       cap_effective, rdev, request);
 
+	/* The parent MDT may not allow a remote directory there, e.g. if it
+	 * is not MDT0 and enable_remote_dir is off.  A directory placed by
+	 * QoS rather than by the user is then created on the parent MDT,
+	 * as it was without QoS. */
+	if (rc == -EPERM && (op_data->op_cli_flags & CLI_QOS_MDT)) {
+		CDEBUG(D_INODE, "%s: remote dir refused, use mds #%x\n",
+		       obd->obd_name, op_data->op_mds);
+		op_data->op_cli_flags &= ~CLI_QOS_MDT;
+		ptlrpc_req_finished(*request);
+		*request = NULL;
+		rc = __lmv_fid_alloc(lmv, &op_data->op_fid2, op_data->op_mds);
+		if (rc)
+			RETURN(rc);
+		rc = md_create(tgt->ltd_exp, op_data, data, datalen, mode, uid,
+			       gid, cap_effective, rdev, request);
+	}
+
 	if (rc == 0) {
 		if (*request == NULL)
 			RETURN(rc);
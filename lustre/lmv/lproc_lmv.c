@@ -61,14 +61,15 @@ static int lmv_rd_numobd(char *page, char **start, off_t off, int count,
 
 static const char *placement_name[] = {
         [PLACEMENT_CHAR_POLICY] = "CHAR",
-        [PLACEMENT_NID_POLICY]  = "NID"
+        [PLACEMENT_NID_POLICY]  = "NID",
+	[PLACEMENT_QOS_POLICY]	= "QOS"
 };
 
 static placement_policy_t placement_name2policy(char *name, int len)
 {
         int                     i;
 
-        for (i = 0; i < PLACEMENT_MAX_POLICY; i++) {
+        for (i = 0; i < PLACEMENT_INVAL_POLICY; i++) {
                 if (!strncmp(placement_name[i], name, len))
                         return i;
         }
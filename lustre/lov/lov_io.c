@@ -121,6 +121,7 @@ static void lov_io_sub_inherit(struct cl_io *io, struct lov_io *lio,
 	case CIT_READ:
 	case CIT_WRITE: {
 		io->u.ci_wr.wr_sync = cl_io_is_sync_write(parent);
+		io->u.ci_wr.wr_stream = cl_io_is_stream_write(parent);
                 if (cl_io_is_append(parent)) {
                         io->u.ci_wr.wr_append = 1;
                 } else {
@@ -430,18 +431,31 @@ static int lov_io_rw_iter_init(const struct lu_env *env,
 	struct lov_io        *lio = cl2lov_io(env, ios);
 	struct cl_io         *io  = ios->cis_io;
 	struct lov_stripe_md *lsm = lio->lis_object->lo_lsm;
+	struct lov_device    *ld;
         loff_t start = io->u.ci_rw.crw_pos;
         loff_t next;
         unsigned long ssize = lsm->lsm_stripe_size;
+	int nchunks;
 
         LASSERT(io->ci_type == CIT_READ || io->ci_type == CIT_WRITE);
         ENTRY;
 
         /* fast path for common case. */
         if (lio->lis_nr_subios != 1 && !cl_io_is_append(io)) {
+		/*
+		 * Let one iteration cover up to a full stripe width, so the
+		 * lock, readahead window and RPCs of all stripes touched by
+		 * the syscall are set up together rather than one OST after
+		 * another. The window ends on a chunk boundary no more than
+		 * a stripe width away, so it never covers a stripe twice.
+		 */
+		ld = lu2lov_dev(lov2cl(lio->lis_object)->co_lu.lo_dev);
+		nchunks = ld->ld_lov->lov_rw_stripes;
+		if (nchunks <= 0 || nchunks > lio->lis_stripe_count)
+			nchunks = lio->lis_stripe_count;
 
 		lov_do_div64(start, ssize);
-		next = (start + 1) * ssize;
+		next = (start + nchunks) * ssize;
 		if (next <= start * ssize)
 			next = ~0ull;
 
@@ -454,10 +468,6 @@ static int lov_io_rw_iter_init(const struct lu_env *env,
 		       LPU64"\n", (__u64)start, lio->lis_pos, lio->lis_endpos,
 		       (__u64)lio->lis_io_endpos);
 	}
-	/*
-	 * XXX The following call should be optimized: we know, that
-	 * [lio->lis_pos, lio->lis_endpos) intersects with exactly one stripe.
-	 */
 	RETURN(lov_io_iter_init(env, ios));
 }
 
@@ -805,6 +805,7 @@ int lov_setup(struct obd_device *obd, struct lustre_cfg *lcfg)
 	mutex_init(&lov->lov_lock);
         cfs_atomic_set(&lov->lov_refcount, 0);
         lov->lov_sp_me = LUSTRE_SP_CLI;
+	lov->lov_rw_stripes = 0;
 
         lov->lov_pools_hash_body = cfs_hash_create("POOLS", HASH_POOLS_CUR_BITS,
                                                    HASH_POOLS_MAX_BITS,
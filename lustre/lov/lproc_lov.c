@@ -165,6 +165,34 @@ static int lov_wr_stripecount(struct file *file, const char *buffer,
         return count;
 }
 
+static int lov_rd_rw_stripes(char *page, char **start, off_t off, int count,
+			     int *eof, void *data)
+{
+	struct obd_device *dev = (struct obd_device *)data;
+
+	LASSERT(dev != NULL);
+	*eof = 1;
+	return snprintf(page, count, "%d\n", dev->u.lov.lov_rw_stripes);
+}
+
+static int lov_wr_rw_stripes(struct file *file, const char *buffer,
+			     unsigned long count, void *data)
+{
+	struct obd_device *dev = (struct obd_device *)data;
+	int val, rc;
+
+	LASSERT(dev != NULL);
+	rc = lprocfs_write_helper(buffer, count, &val);
+	if (rc)
+		return rc;
+
+	if (val < 0 || val > LOV_MAX_STRIPE_COUNT)
+		return -ERANGE;
+
+	dev->u.lov.lov_rw_stripes = val;
+	return count;
+}
+
 static int lov_rd_numobd(char *page, char **start, off_t off, int count,
                          int *eof, void *data)
 {
@@ -270,6 +298,7 @@ struct lprocfs_vars lprocfs_lov_obd_vars[] = {
         { "stripeoffset", lov_rd_stripeoffset,    lov_wr_stripeoffset, 0 },
         { "stripecount",  lov_rd_stripecount,     lov_wr_stripecount, 0 },
         { "stripetype",   lov_rd_stripetype,      lov_wr_stripetype, 0 },
+	{ "rw_stripes",   lov_rd_rw_stripes,      lov_wr_rw_stripes, 0 },
         { "numobd",       lov_rd_numobd,          0, 0 },
         { "activeobd",    lov_rd_activeobd,       0, 0 },
         { "filestotal",   lprocfs_rd_filestotal,  0, 0 },
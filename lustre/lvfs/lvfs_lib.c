@@ -115,6 +115,21 @@ void lprocfs_counter_add(struct lprocfs_stats *stats, int idx, long amount)
 		if (amount > percpu_cntr->lc_max)
 			percpu_cntr->lc_max = amount;
 	}
+
+	if ((header->lc_config & LPROCFS_CNTR_HISTOGRAM) &&
+	    stats->ls_hist != NULL) {
+		int bucket;
+
+		/* same buckets as lprocfs_oh_tally_log2() */
+		if (amount <= 1)
+			bucket = 0;
+		else if (amount > (1UL << (LPROCFS_HIST_MAX - 2)))
+			bucket = LPROCFS_HIST_MAX - 1;
+		else
+			bucket = fls(amount - 1);
+
+		stats->ls_hist[smp_id][idx * LPROCFS_HIST_MAX + bucket]++;
+	}
 	lprocfs_stats_unlock(stats, LPROCFS_GET_SMP_ID, &flags);
 }
 EXPORT_SYMBOL(lprocfs_counter_add);
@@ -485,6 +485,8 @@ void mdc_getattr_pack(struct ptlrpc_request *req, __u64 valid, int flags,
                 b->valid |= OBD_MD_FLCKSPLIT;
         if (op_data->op_bias & MDS_CROSS_REF)
                 b->valid |= OBD_MD_FLCROSSREF;
+	if (op_data->op_cli_flags & CLI_LAZY_SIZE)
+		b->valid |= OBD_MD_FLLAZYSIZE;
         b->eadatasize = ea_size;
         b->flags = flags;
         __mdc_pack_body(b, op_data->op_suppgids[0]);
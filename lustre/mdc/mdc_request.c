@@ -62,6 +62,10 @@ struct mdc_renew_capa_args {
         renew_capa_cb_t         ra_cb;
 };
 
+struct mdc_statfs_args {
+	struct obd_info		*sa_oi;
+};
+
 static int mdc_cleanup(struct obd_device *obd);
 
 int mdc_unpack_capa(struct obd_export *exp, struct ptlrpc_request *req,
@@ -1152,6 +1156,76 @@ output:
         return rc;
 }
 
+static int mdc_statfs_interpret(const struct lu_env *env,
+				struct ptlrpc_request *req,
+				struct mdc_statfs_args *sa, int rc)
+{
+	struct obd_statfs *msfs;
+	ENTRY;
+
+	if ((rc == -ENOTCONN || rc == -EAGAIN) &&
+	    (sa->sa_oi->oi_flags & OBD_STATFS_NODELAY))
+		GOTO(out, rc);
+
+	if (rc != 0) {
+		/* check connection error first */
+		if (req->rq_import->imp_connect_error)
+			rc = req->rq_import->imp_connect_error;
+		GOTO(out, rc);
+	}
+
+	msfs = req_capsule_server_get(&req->rq_pill, &RMF_OBD_STATFS);
+	if (msfs == NULL)
+		GOTO(out, rc = -EPROTO);
+
+	*sa->sa_oi->oi_osfs = *msfs;
+	EXIT;
+out:
+	return sa->sa_oi->oi_cb_up(sa->sa_oi, rc);
+}
+
+/* Queue an MDS_STATFS request on \a rqset, \a oinfo->oi_cb_up is called
+ * with the result once the reply has arrived. */
+static int mdc_statfs_async(struct obd_export *exp, struct obd_info *oinfo,
+			    __u64 max_age, struct ptlrpc_request_set *rqset)
+{
+	struct obd_device	*obd = class_exp2obd(exp);
+	struct ptlrpc_request	*req;
+	struct mdc_statfs_args	*sa;
+	struct obd_import	*imp = NULL;
+	ENTRY;
+
+	/* see mdc_statfs() */
+	down_read(&obd->u.cli.cl_sem);
+	if (obd->u.cli.cl_import)
+		imp = class_import_get(obd->u.cli.cl_import);
+	up_read(&obd->u.cli.cl_sem);
+	if (imp == NULL)
+		RETURN(-ENODEV);
+
+	req = ptlrpc_request_alloc_pack(imp, &RQF_MDS_STATFS,
+					LUSTRE_MDS_VERSION, MDS_STATFS);
+	class_import_put(imp);
+	if (req == NULL)
+		RETURN(-ENOMEM);
+
+	ptlrpc_request_set_replen(req);
+
+	if (oinfo->oi_flags & OBD_STATFS_NODELAY) {
+		/* procfs requests not want stay in wait for avoid deadlock */
+		req->rq_no_resend = 1;
+		req->rq_no_delay = 1;
+	}
+
+	req->rq_interpret_reply = (ptlrpc_interpterer_t)mdc_statfs_interpret;
+	CLASSERT(sizeof(*sa) <= sizeof(req->rq_async_args));
+	sa = ptlrpc_req_async_args(req);
+	sa->sa_oi = oinfo;
+
+	ptlrpc_set_add_req(rqset, req);
+	RETURN(0);
+}
+
 static int mdc_ioc_fid2path(struct obd_export *exp, struct getinfo_fid2path *gf)
 {
         __u32 keylen, vallen;
@@ -2682,6 +2756,7 @@ struct obd_ops mdc_obd_ops = {
         .o_iocontrol        = mdc_iocontrol,
         .o_set_info_async   = mdc_set_info_async,
         .o_statfs           = mdc_statfs,
+	.o_statfs_async     = mdc_statfs_async,
         .o_pin              = mdc_pin,
         .o_unpin            = mdc_unpin,
 	.o_fid_init	    = client_fid_init,
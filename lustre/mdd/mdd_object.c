@@ -1084,6 +1084,12 @@ static int mdd_declare_attr_set(const struct lu_env *env,
         if (rc)
                 return rc;
 
+	if ((attr->la_valid & LA_SIZE) && S_ISREG(mdd_object_type(obj))) {
+		rc = mdo_declare_xattr_del(env, obj, XATTR_NAME_LSOM, handle);
+		if (rc)
+			return rc;
+	}
+
 #ifdef CONFIG_FS_POSIX_ACL
 	if (attr->la_valid & LA_MODE) {
                 mdd_read_lock(env, obj, MOR_TGT_CHILD);
@@ -1164,6 +1170,17 @@ int mdd_attr_set(const struct lu_env *env, struct md_object *obj,
 		rc = mdd_attr_set_internal(env, mdd_obj, la_copy, handle, 1);
         }
 
+	/* truncate makes the lazy Size-on-MDT stale */
+	if (rc == 0 && (la->la_valid & LA_SIZE) &&
+	    S_ISREG(mdd_object_type(mdd_obj))) {
+		mdd_write_lock(env, mdd_obj, MOR_TGT_CHILD);
+		rc = mdo_xattr_del(env, mdd_obj, XATTR_NAME_LSOM, handle,
+				   mdd_object_capa(env, mdd_obj));
+		mdd_write_unlock(env, mdd_obj);
+		if (rc == -ENODATA)
+			rc = 0;
+	}
+
         if (rc == 0)
                 rc = mdd_attr_set_changelog(env, obj, handle,
 					    la->la_valid);
@@ -360,6 +360,41 @@ static void mdt_pack_size2body(struct mdt_thread_info *info,
         b->blocks = ma->ma_som->msd_blocks;
 }
 
+/**
+ * Pack the lazy Size-on-MDT attributes into the reply if the client asked
+ * for them and the MDT does not know the exact size, flagged with
+ * OBD_MD_FLLAZYSIZE as they may be stale.  Nothing is returned while the
+ * file is open for write, as its size is then changing.
+ */
+static void mdt_pack_lsom2body(struct mdt_thread_info *info,
+			       struct mdt_object *mo, struct mdt_body *b)
+{
+	struct lsom_attrs	*attrs;
+	struct lu_buf		 buf;
+	int			 rc;
+
+	if (!S_ISREG(b->mode) || (b->valid & OBD_MD_FLSIZE) ||
+	    mdt_write_read(mo) > 0)
+		return;
+
+	attrs = (struct lsom_attrs *)info->mti_xattr_buf;
+	CLASSERT(sizeof(info->mti_xattr_buf) >= sizeof(*attrs));
+	buf.lb_buf = attrs;
+	buf.lb_len = sizeof(*attrs);
+	rc = mo_xattr_get(info->mti_env, mdt_object_child(mo), &buf,
+			  XATTR_NAME_LSOM);
+	if (rc != sizeof(*attrs))
+		return;
+
+	lustre_lsom_swab(attrs);
+	if (attrs->lsa_incompat & ~LSOM_INCOMPAT_SUPP)
+		return;
+
+	b->size = attrs->lsa_size;
+	b->blocks = attrs->lsa_blocks;
+	b->valid |= OBD_MD_FLLAZYSIZE;
+}
+
 void mdt_pack_attr2body(struct mdt_thread_info *info, struct mdt_body *b,
                         const struct lu_attr *attr, const struct lu_fid *fid)
 {
@@ -757,6 +792,9 @@ static int mdt_getattr_internal(struct mdt_thread_info *info,
         else
                 RETURN(-EFAULT);
 
+	if (reqbody->valid & OBD_MD_FLLAZYSIZE)
+		mdt_pack_lsom2body(info, o, repbody);
+
         if (mdt_body_has_lov(la, reqbody)) {
                 if (ma->ma_valid & MA_LOV) {
                         LASSERT(ma->ma_lmm_size);
@@ -2169,10 +2207,18 @@ static int mdt_llog_ctxt_clone(const struct lu_env *env, struct mdt_device *mdt,
         }
 
         rc = llog_group_set_ctxt(&mdt2obd_dev(mdt)->obd_olg, ctxt, idx);
-        if (rc)
+        if (rc) {
                 CERROR("Can't set mdt ctxt %d\n", rc);
+		return rc;
+	}
 
-        return rc;
+	/* all changelog consumers read the same blocks, share them */
+	if (idx == LLOG_CHANGELOG_ORIG_CTXT &&
+	    llog_chunk_cache_init(ctxt) != 0)
+		CWARN("%s: can't set up changelog chunk cache\n",
+		      mdt2obd_dev(mdt)->obd_name);
+
+	return 0;
 }
 
 static int mdt_llog_ctxt_unclone(const struct lu_env *env,
@@ -844,6 +844,11 @@ static int mdt_setattr_unpack_rec(struct mdt_thread_info *info)
 	else
 		ma->ma_attr_flags &= ~MDS_DATA_MODIFIED;
 
+	if (rec->sa_bias & MDS_LAZY_SIZE)
+		ma->ma_attr_flags |= MDS_LAZY_SIZE;
+	else
+		ma->ma_attr_flags &= ~MDS_LAZY_SIZE;
+
         if (req_capsule_get_size(pill, &RMF_CAPA1, RCL_CLIENT))
                 mdt_set_capainfo(info, 0, rr->rr_fid1,
                                  req_capsule_client_get(pill, &RMF_CAPA1));
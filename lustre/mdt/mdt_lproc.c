@@ -657,6 +657,23 @@ static int lprocfs_wr_sec_level(struct file *file, const char *buffer,
         return count;
 }
 
+static int lprocfs_rd_changelog_cache(char *page, char **start, off_t off,
+				      int count, int *eof, void *data)
+{
+	struct obd_device	*obd = data;
+	struct llog_ctxt	*ctxt;
+	int			 rc;
+
+	*eof = 1;
+	ctxt = llog_get_context(obd, LLOG_CHANGELOG_ORIG_CTXT);
+	if (ctxt == NULL)
+		return snprintf(page, count, "disabled\n");
+
+	rc = llog_chunk_cache_stats(ctxt, page, count);
+	llog_ctxt_put(ctxt);
+	return rc;
+}
+
 static int lprocfs_rd_cos(char *page, char **start, off_t off,
                               int count, int *eof, void *data)
 {
@@ -1015,6 +1032,7 @@ static struct lprocfs_vars lprocfs_mdt_obd_vars[] = {
 					lprocfs_wr_job_interval, 0 },
 	{ "enable_remote_dir",		lprocfs_rd_enable_remote_dir,
 					lprocfs_wr_enable_remote_dir,	    0},
+	{ "changelog_cache",		lprocfs_rd_changelog_cache, 0,	    0},
         { 0 }
 };
 
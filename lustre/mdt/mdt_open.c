@@ -263,6 +263,90 @@ static int mdt_som_attr_set(struct mdt_thread_info *info,
         RETURN(rc);
 }
 
+/**
+ * Drop the lazy Size-on-MDT attributes of \a o, so that clients go to the
+ * OSTs for the size until the next close for write.  Truncate drops them
+ * in its own transaction, see mdd_attr_set().
+ */
+static void mdt_lsom_invalidate(struct mdt_thread_info *info,
+				struct mdt_object *o)
+{
+	int rc;
+
+	if (!S_ISREG(lu_object_attr(&o->mot_obj.mo_lu)))
+		return;
+
+	/* don't start a transaction on every close if there is none */
+	rc = mo_xattr_get(info->mti_env, mdt_object_child(o), &LU_BUF_NULL,
+			  XATTR_NAME_LSOM);
+	if (rc <= 0)
+		return;
+
+	rc = mo_xattr_del(info->mti_env, mdt_object_child(o), XATTR_NAME_LSOM);
+	if (rc != 0 && rc != -ENODATA)
+		CDEBUG(D_INODE, "%s: can't drop lazy size of "DFID": rc = %d\n",
+		       mdt_obd_name(info->mti_mdt), PFID(mdt_object_fid(o)),
+		       rc);
+}
+
+/**
+ * Save the size and blocks a client sends on its last close for write as
+ * the lazy Size-on-MDT attributes of \a o.  They are only a hint for
+ * getattr and are not kept consistent with the OST objects otherwise.
+ *
+ * The client sets MDS_LAZY_SIZE only if it holds locks covering the whole
+ * file and has no dirty pages left, so that its size is current and its
+ * blocks include all the data.  Any other close for write may have changed
+ * the file behind the saved values, so they are dropped instead.
+ */
+static int mdt_lsom_update(struct mdt_thread_info *info, struct mdt_object *o)
+{
+	struct md_object	*next = mdt_object_child(o);
+	struct lu_attr		*la = &info->mti_attr.ma_attr;
+	struct lu_buf		*buf = &info->mti_buf;
+	struct lsom_attrs	*attrs;
+	int			 rc;
+	ENTRY;
+
+	if (!S_ISREG(lu_object_attr(&o->mot_obj.mo_lu)))
+		RETURN(0);
+
+	/* the remaining writers will update it on their close */
+	if (mdt_write_read(o) > 0)
+		RETURN(0);
+
+	if (!(info->mti_attr.ma_attr_flags & MDS_LAZY_SIZE) ||
+	    (la->la_valid & (LA_SIZE | LA_BLOCKS)) != (LA_SIZE | LA_BLOCKS)) {
+		mdt_lsom_invalidate(info, o);
+		RETURN(0);
+	}
+
+	attrs = (struct lsom_attrs *)info->mti_xattr_buf;
+	CLASSERT(sizeof(info->mti_xattr_buf) >= sizeof(*attrs));
+
+	/* skip the transaction if nothing changed since the last close */
+	buf->lb_buf = attrs;
+	buf->lb_len = sizeof(*attrs);
+	rc = mo_xattr_get(info->mti_env, next, buf, XATTR_NAME_LSOM);
+	if (rc == sizeof(*attrs)) {
+		lustre_lsom_swab(attrs);
+		if (attrs->lsa_incompat == 0 &&
+		    attrs->lsa_size == la->la_size &&
+		    attrs->lsa_blocks == la->la_blocks)
+			RETURN(0);
+	}
+
+	memset(attrs, 0, sizeof(*attrs));
+	attrs->lsa_size = la->la_size;
+	attrs->lsa_blocks = la->la_blocks;
+	lustre_lsom_swab(attrs);
+
+	rc = mo_xattr_set(info->mti_env, next, buf, XATTR_NAME_LSOM, 0);
+	CDEBUG(D_INODE, "lazy size "LPU64"/"LPU64" on "DFID": rc = %d\n",
+	       la->la_size, la->la_blocks, PFID(mdt_object_fid(o)), rc);
+	RETURN(rc);
+}
+
 /** Perform the eviction specific actions on ioepoch close. */
 static inline int mdt_ioepoch_close_on_eviction(struct mdt_thread_info *info,
                                                 struct mdt_object *o)
@@ -1710,6 +1794,11 @@ int mdt_mfd_close(struct mdt_thread_info *info, struct mdt_file_data *mfd)
         if ((mode & FMODE_WRITE) || (mode & MDS_FMODE_TRUNC)) {
                 mdt_write_put(o);
                 ret = mdt_ioepoch_close(info, o);
+		/* only a client close carries the file size */
+		if (mdt_info_req(info) != NULL &&
+		    lustre_msg_get_opc(mdt_info_req(info)->rq_reqmsg) ==
+		    MDS_CLOSE)
+			mdt_lsom_update(info, o);
         } else if (mode & MDS_FMODE_EXEC) {
                 mdt_write_allow(o);
         } else if (mode & MDS_FMODE_EPOCH) {
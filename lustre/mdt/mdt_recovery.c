@@ -182,6 +182,7 @@ static int mdt_server_data_init(const struct lu_env *env,
         struct mdt_thread_info *mti;
         struct dt_object       *obj;
         struct lu_attr         *la;
+	struct dt_device_param	param;
         unsigned long last_rcvd_size;
 	__u32			index;
         __u64 mount_count;
@@ -256,6 +257,10 @@ static int mdt_server_data_init(const struct lu_env *env,
 	}
         mount_count = lsd->lsd_mount_count;
 
+	/* make older versions refuse the on-disk format of the OSD */
+	dt_conf_get(env, mdt->mdt_bottom, &param);
+	lsd->lsd_feature_incompat |= param.ddp_incompat;
+
         if (lsd->lsd_feature_incompat & ~MDT_INCOMPAT_SUPP) {
                 CERROR("%s: unsupported incompat filesystem feature(s) %x\n",
                        obd->obd_name,
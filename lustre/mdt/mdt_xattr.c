@@ -49,6 +49,91 @@
 #include "mdt_internal.h"
 
 
+/* Pack every xattr of @next into @buf as OBD_MD_FLXATTRALL describes, or
+ * just return the size needed if @buf has no buffer.
+ *
+ * The xattrs of xattr_is_uncached() are listed without their value: they
+ * are rewritten without revoking the UPDATE lock (e.g. the linkEA by rename
+ * under LOOKUP only, SOM on close), so a client can't cache them under
+ * UPDATE and has to fetch them separately. */
+static int mdt_getxattr_all(struct mdt_thread_info *info,
+			    struct md_object *next, struct lu_buf *buf)
+{
+	const struct lu_env	*env = info->mti_env;
+	struct lu_buf		 names;
+	struct lu_buf		 value;
+	char			*name;
+	char			*p = buf->lb_buf;
+	int			 rem;
+	int			 namelen;
+	int			 size = 0;
+	__u32			 len;
+	int			 rc;
+	ENTRY;
+
+	rc = mo_xattr_list(env, next, &LU_BUF_NULL);
+	if (rc <= 0)
+		RETURN(rc == -ENODATA ? 0 : rc);
+
+	names.lb_len = rc;
+	OBD_ALLOC_LARGE(names.lb_buf, names.lb_len);
+	if (names.lb_buf == NULL)
+		RETURN(-ENOMEM);
+
+	rc = mo_xattr_list(env, next, &names);
+	if (rc < 0)
+		GOTO(out, rc);
+
+	for (name = names.lb_buf, rem = rc; rem > 0;
+	     name += namelen, rem -= namelen) {
+		namelen = strnlen(name, rem) + 1;
+		if (namelen > rem)
+			break;
+
+		if (xattr_is_uncached(name)) {
+			if (p != NULL) {
+				if (size + namelen + sizeof(len) > buf->lb_len)
+					GOTO(out, rc = -ERANGE);
+
+				memcpy(p, name, namelen);
+				len = 0;
+				memcpy(p + namelen, &len, sizeof(len));
+				p += namelen + sizeof(len);
+			}
+			size += namelen + sizeof(len);
+			continue;
+		}
+
+		rc = mo_xattr_get(env, next, &LU_BUF_NULL, name);
+		if (rc == -ENODATA) /* removed since listed */
+			continue;
+		if (rc < 0)
+			GOTO(out, rc);
+
+		if (p != NULL) {
+			if (size + namelen + sizeof(len) + rc > buf->lb_len)
+				GOTO(out, rc = -ERANGE);
+
+			value.lb_buf = p + namelen + sizeof(len);
+			value.lb_len = rc;
+			rc = mo_xattr_get(env, next, &value, name);
+			if (rc < 0)
+				GOTO(out, rc);
+
+			memcpy(p, name, namelen);
+			len = cpu_to_le32(rc);
+			memcpy(p + namelen, &len, sizeof(len));
+			p += namelen + sizeof(len) + rc;
+		}
+		size += namelen + sizeof(len) + rc;
+	}
+	rc = size;
+	EXIT;
+out:
+	OBD_FREE_LARGE(names.lb_buf, names.lb_len);
+	return rc;
+}
+
 /* return EADATA length to the caller. negative value means error */
 static int mdt_getxattr_pack_reply(struct mdt_thread_info * info)
 {
@@ -80,6 +165,10 @@ static int mdt_getxattr_pack_reply(struct mdt_thread_info * info)
                 size = mo_xattr_list(info->mti_env,
                                      mdt_object_child(info->mti_object),
                                      &LU_BUF_NULL);
+	} else if (valid & OBD_MD_FLXATTRALL) {
+		size = mdt_getxattr_all(info,
+					mdt_object_child(info->mti_object),
+					&LU_BUF_NULL);
         } else {
                 CDEBUG(D_INFO, "Valid bits: "LPX64"\n", info->mti_body->valid);
                 RETURN(-EINVAL);
@@ -204,6 +293,12 @@ int mdt_getxattr(struct mdt_thread_info *info)
                 rc = mo_xattr_list(info->mti_env, next, buf);
                 if (rc < 0)
                         CDEBUG(D_INFO, "listxattr failed: %d\n", rc);
+	} else if (info->mti_body->valid & OBD_MD_FLXATTRALL) {
+		CDEBUG(D_INODE, "getxattr all\n");
+
+		rc = mdt_getxattr_all(info, next, buf);
+		if (rc < 0)
+			CDEBUG(D_INFO, "getxattr all failed: %d\n", rc);
         } else
                 LBUG();
 
@@ -976,3 +976,213 @@ out:
 	RETURN(rc);
 }
 EXPORT_SYMBOL(llog_close);
+
+/*
+ * Chunk cache for remote llog readers.
+ *
+ * Every remote reader of a context (e.g. each changelog consumer) walks the
+ * same plain logs with the same sequence of LLOG_ORIGIN_HANDLE_NEXT_BLOCK
+ * requests, so the result of llog_next_block() for a given (logid, offset,
+ * index) tuple is shared between them.  Only chunks which are completely
+ * written are cached: records are never modified in place, cancellation
+ * only touches the header bitmap, so such chunks can not become stale
+ * until the log is destroyed, see llog_chunk_cache_forget().
+ */
+#define LLOG_CHUNK_CACHE_BITS	6
+#define LLOG_CHUNK_CACHE_SLOTS	(1 << LLOG_CHUNK_CACHE_BITS)
+
+struct llog_chunk_slot {
+	spinlock_t		 lcs_lock;
+	int			 lcs_valid;
+	struct llog_logid	 lcs_logid;
+	/* request: position to search from and wanted index */
+	__u64			 lcs_offset;
+	int			 lcs_cur_idx;
+	int			 lcs_next_idx;
+	/* reply: position after the chunk and its last index */
+	__u64			 lcs_end_offset;
+	int			 lcs_end_idx;
+	char			*lcs_buf;
+};
+
+struct llog_chunk_cache {
+	struct llog_chunk_slot	 lcc_slots[LLOG_CHUNK_CACHE_SLOTS];
+	/* bumped by each destroy, chunks read before are not inserted */
+	cfs_atomic_t		 lcc_gen;
+	cfs_atomic_t		 lcc_hits;
+	cfs_atomic_t		 lcc_misses;
+};
+
+static struct llog_chunk_slot *
+llog_chunk_slot(struct llog_chunk_cache *lcc, struct llog_logid *logid,
+		__u64 offset)
+{
+	unsigned long key;
+
+	key = (unsigned long)(logid->lgl_oid ^ logid->lgl_ogen) ^
+	      (unsigned long)(offset / LLOG_CHUNK_SIZE);
+	return &lcc->lcc_slots[cfs_hash_long(key, LLOG_CHUNK_CACHE_BITS)];
+}
+
+static inline int llog_chunk_slot_match(struct llog_chunk_slot *lcs,
+					struct llog_logid *logid,
+					__u64 offset, int cur_idx,
+					int next_idx)
+{
+	return lcs->lcs_valid && lcs->lcs_offset == offset &&
+	       lcs->lcs_cur_idx == cur_idx && lcs->lcs_next_idx == next_idx &&
+	       memcmp(&lcs->lcs_logid, logid, sizeof(*logid)) == 0;
+}
+
+/**
+ * Look up the chunk llog_next_block() would return for these arguments.
+ * On a miss, \a gen is set for the llog_chunk_cache_insert() of the chunk
+ * read instead.
+ *
+ * \retval 1 if found, \a buf, \a cur_idx and \a cur_offset are filled in
+ */
+int llog_chunk_cache_lookup(struct llog_ctxt *ctxt, struct llog_logid *logid,
+			    int *cur_idx, int next_idx, __u64 *cur_offset,
+			    void *buf, int *gen)
+{
+	struct llog_chunk_cache	*lcc = ctxt->loc_chunk_cache;
+	struct llog_chunk_slot	*lcs;
+	int			 found = 0;
+
+	*gen = cfs_atomic_read(&lcc->lcc_gen);
+	lcs = llog_chunk_slot(lcc, logid, *cur_offset);
+	spin_lock(&lcs->lcs_lock);
+	if (llog_chunk_slot_match(lcs, logid, *cur_offset, *cur_idx,
+				  next_idx)) {
+		memcpy(buf, lcs->lcs_buf, LLOG_CHUNK_SIZE);
+		*cur_idx = lcs->lcs_end_idx;
+		*cur_offset = lcs->lcs_end_offset;
+		found = 1;
+	}
+	spin_unlock(&lcs->lcs_lock);
+
+	if (found)
+		cfs_atomic_inc(&lcc->lcc_hits);
+	else
+		cfs_atomic_inc(&lcc->lcc_misses);
+	return found;
+}
+EXPORT_SYMBOL(llog_chunk_cache_lookup);
+
+void llog_chunk_cache_insert(struct llog_ctxt *ctxt, struct llog_logid *logid,
+			     __u64 offset, int cur_idx, int next_idx,
+			     __u64 end_offset, int end_idx, void *buf, int gen)
+{
+	struct llog_chunk_cache	*lcc = ctxt->loc_chunk_cache;
+	struct llog_chunk_slot	*lcs;
+
+	/* the last chunk of a log may still be appended to */
+	if (end_offset & (LLOG_CHUNK_SIZE - 1))
+		return;
+
+	lcs = llog_chunk_slot(lcc, logid, offset);
+	spin_lock(&lcs->lcs_lock);
+	/* the log may have been destroyed since it was read */
+	if (cfs_atomic_read(&lcc->lcc_gen) == gen) {
+		lcs->lcs_logid = *logid;
+		lcs->lcs_offset = offset;
+		lcs->lcs_cur_idx = cur_idx;
+		lcs->lcs_next_idx = next_idx;
+		lcs->lcs_end_offset = end_offset;
+		lcs->lcs_end_idx = end_idx;
+		memcpy(lcs->lcs_buf, buf, LLOG_CHUNK_SIZE);
+		lcs->lcs_valid = 1;
+	}
+	spin_unlock(&lcs->lcs_lock);
+}
+EXPORT_SYMBOL(llog_chunk_cache_insert);
+
+/**
+ * Drop the cached chunks of a destroyed log, so that its readers get
+ * -ENOENT from llog_open() as without the cache.
+ */
+void llog_chunk_cache_forget(struct llog_ctxt *ctxt, struct llog_logid *logid)
+{
+	struct llog_chunk_cache	*lcc = ctxt->loc_chunk_cache;
+	struct llog_chunk_slot	*lcs;
+	int			 i;
+
+	cfs_atomic_inc(&lcc->lcc_gen);
+	for (i = 0; i < LLOG_CHUNK_CACHE_SLOTS; i++) {
+		lcs = &lcc->lcc_slots[i];
+		spin_lock(&lcs->lcs_lock);
+		if (lcs->lcs_valid &&
+		    memcmp(&lcs->lcs_logid, logid, sizeof(*logid)) == 0)
+			lcs->lcs_valid = 0;
+		spin_unlock(&lcs->lcs_lock);
+	}
+}
+EXPORT_SYMBOL(llog_chunk_cache_forget);
+
+/**
+ * Enable sharing of llog chunks read on behalf of remote readers of \a ctxt.
+ * Used for the changelog context, where each registered consumer otherwise
+ * causes its own read of every llog block.
+ */
+int llog_chunk_cache_init(struct llog_ctxt *ctxt)
+{
+	struct llog_chunk_cache *lcc;
+	int			 i;
+	ENTRY;
+
+	if (ctxt->loc_chunk_cache != NULL)
+		RETURN(0);
+
+	OBD_ALLOC_PTR(lcc);
+	if (lcc == NULL)
+		RETURN(-ENOMEM);
+
+	for (i = 0; i < LLOG_CHUNK_CACHE_SLOTS; i++) {
+		spin_lock_init(&lcc->lcc_slots[i].lcs_lock);
+		OBD_ALLOC_LARGE(lcc->lcc_slots[i].lcs_buf, LLOG_CHUNK_SIZE);
+		if (lcc->lcc_slots[i].lcs_buf == NULL)
+			GOTO(out_free, -ENOMEM);
+	}
+	cfs_atomic_set(&lcc->lcc_gen, 0);
+	cfs_atomic_set(&lcc->lcc_hits, 0);
+	cfs_atomic_set(&lcc->lcc_misses, 0);
+	ctxt->loc_chunk_cache = lcc;
+	RETURN(0);
+
+out_free:
+	while (i-- > 0)
+		OBD_FREE_LARGE(lcc->lcc_slots[i].lcs_buf, LLOG_CHUNK_SIZE);
+	OBD_FREE_PTR(lcc);
+	RETURN(-ENOMEM);
+}
+EXPORT_SYMBOL(llog_chunk_cache_init);
+
+/* Called when the last reference on \a ctxt is dropped, so that no remote
+ * reader can still use the cache */
+void llog_chunk_cache_fini(struct llog_ctxt *ctxt)
+{
+	struct llog_chunk_cache *lcc = ctxt->loc_chunk_cache;
+	int			 i;
+
+	if (lcc == NULL)
+		return;
+
+	ctxt->loc_chunk_cache = NULL;
+	for (i = 0; i < LLOG_CHUNK_CACHE_SLOTS; i++)
+		OBD_FREE_LARGE(lcc->lcc_slots[i].lcs_buf, LLOG_CHUNK_SIZE);
+	OBD_FREE_PTR(lcc);
+}
+
+int llog_chunk_cache_stats(struct llog_ctxt *ctxt, char *page, int count)
+{
+	struct llog_chunk_cache *lcc = ctxt->loc_chunk_cache;
+
+	if (lcc == NULL)
+		return snprintf(page, count, "disabled\n");
+
+	return snprintf(page, count, "slots: %d\nhits: %d\nmisses: %d\n",
+			LLOG_CHUNK_CACHE_SLOTS,
+			cfs_atomic_read(&lcc->lcc_hits),
+			cfs_atomic_read(&lcc->lcc_misses));
+}
+EXPORT_SYMBOL(llog_chunk_cache_stats);
@@ -70,6 +70,7 @@ static void llog_ctxt_destroy(struct llog_ctxt *ctxt)
                 ctxt->loc_imp = NULL;
         }
         LASSERT(ctxt->loc_llcd == NULL);
+	llog_chunk_cache_fini(ctxt);
         OBD_FREE_PTR(ctxt);
 }
 
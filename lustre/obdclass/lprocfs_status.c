@@ -975,6 +975,7 @@ static const char *obd_connect_names[] = {
 	"lightweight_conn",
 	"short_io",
 	"pingless",
+	"xattr_all",
 	"unknown",
         NULL
 };
@@ -1438,6 +1439,13 @@ void lprocfs_free_stats(struct lprocfs_stats **statsh)
 	for (i = 0; i < num_entry; i++)
 		if (stats->ls_percpu[i] != NULL)
 			LIBCFS_FREE(stats->ls_percpu[i], percpusize);
+	if (stats->ls_hist != NULL) {
+		for (i = 0; i < num_entry; i++)
+			if (stats->ls_hist[i] != NULL)
+				LIBCFS_FREE(stats->ls_hist[i], stats->ls_num *
+					    LPROCFS_HIST_MAX * sizeof(__u32));
+		LIBCFS_FREE(stats->ls_hist, num_entry * sizeof(__u32 *));
+	}
 	if (stats->ls_cnt_header != NULL)
 		LIBCFS_FREE(stats->ls_cnt_header, stats->ls_num *
 					sizeof(struct lprocfs_counter_header));
@@ -1470,6 +1478,9 @@ void lprocfs_clear_stats(struct lprocfs_stats *stats)
 			if (stats->ls_flags & LPROCFS_STATS_FLAG_IRQ_SAFE)
 				percpu_cntr->lc_sum_irq	= 0;
 		}
+		if (stats->ls_hist != NULL && stats->ls_hist[i] != NULL)
+			memset(stats->ls_hist[i], 0, stats->ls_num *
+			       LPROCFS_HIST_MAX * sizeof(__u32));
 	}
 
 	lprocfs_stats_unlock(stats, LPROCFS_GET_NUM_CPU, &flags);
@@ -1507,6 +1518,18 @@ static void *lprocfs_stats_seq_next(struct seq_file *p, void *v, loff_t *pos)
 		lprocfs_stats_counter_get(stats, 0, *pos);
 }
 
+/* index of the counter \a cntr of the first cpu area */
+static int lprocfs_stats_seq_idx(struct lprocfs_stats *stats,
+				 struct lprocfs_counter *cntr)
+{
+	int	entry_size = sizeof(*cntr);
+
+	if (stats->ls_flags & LPROCFS_STATS_FLAG_IRQ_SAFE)
+		entry_size += sizeof(__s64);
+	return ((void *)cntr - (void *)&(stats->ls_percpu[0])->lp_cntr[0]) /
+	       entry_size;
+}
+
 /* seq file export of one lprocfs counter */
 static int lprocfs_stats_seq_show(struct seq_file *p, void *v)
 {
@@ -1514,7 +1537,6 @@ static int lprocfs_stats_seq_show(struct seq_file *p, void *v)
 	struct lprocfs_counter		*cntr	= v;
 	struct lprocfs_counter		ret;
 	struct lprocfs_counter_header	*header;
-	int				entry_size;
 	int				idx;
 	int				rc	= 0;
 
@@ -1526,11 +1548,7 @@ static int lprocfs_stats_seq_show(struct seq_file *p, void *v)
 		if (rc < 0)
 			return rc;
 	}
-	entry_size = sizeof(*cntr);
-	if (stats->ls_flags & LPROCFS_STATS_FLAG_IRQ_SAFE)
-		entry_size += sizeof(__s64);
-	idx = ((void *)cntr - (void *)&(stats->ls_percpu[0])->lp_cntr[0]) /
-		entry_size;
+	idx = lprocfs_stats_seq_idx(stats, cntr);
 
 	header = &stats->ls_cnt_header[idx];
 	lprocfs_stats_collect(stats, idx, &ret);
@@ -1595,10 +1613,122 @@ struct file_operations lprocfs_stats_seq_fops = {
         .release = lprocfs_seq_release,
 };
 
+/* percentiles reported for histogram counters, in 1/1000 */
+static const struct {
+	const char	*name;
+	int		 permille;
+} lprocfs_stats_pcts[] = {
+	{ "p50",	500 },
+	{ "p90",	900 },
+	{ "p99",	990 },
+	{ "p99.9",	999 },
+};
+
+/* seq file export of the histogram of one lprocfs counter */
+static int lprocfs_stats_latency_seq_show(struct seq_file *p, void *v)
+{
+	struct lprocfs_stats		*stats	= p->private;
+	struct lprocfs_counter_header	*header;
+	struct lprocfs_counter		ret;
+	unsigned long			flags	= 0;
+	__u64				buckets[LPROCFS_HIST_MAX] = { 0 };
+	__u64				total	= 0;
+	__u64				cum	= 0;
+	unsigned int			num_cpu;
+	int				idx;
+	int				rc	= 0;
+	int				i;
+	int				j;
+
+	idx = lprocfs_stats_seq_idx(stats, v);
+	if (idx == 0) {
+		struct timeval now;
+		cfs_gettimeofday(&now);
+		rc = seq_printf(p, "%-25s %lu.%lu secs.usecs\n",
+				"snapshot_time", now.tv_sec, now.tv_usec);
+		if (rc < 0)
+			return rc;
+	}
+
+	header = &stats->ls_cnt_header[idx];
+	if ((header->lc_config & LPROCFS_CNTR_HISTOGRAM) == 0)
+		return 0;
+
+	num_cpu = lprocfs_stats_lock(stats, LPROCFS_GET_NUM_CPU, &flags);
+	for (i = 0; i < num_cpu; i++) {
+		if (stats->ls_hist[i] == NULL)
+			continue;
+		for (j = 0; j < LPROCFS_HIST_MAX; j++)
+			buckets[j] += stats->ls_hist[i][idx * LPROCFS_HIST_MAX +
+							j];
+	}
+	lprocfs_stats_unlock(stats, LPROCFS_GET_NUM_CPU, &flags);
+
+	for (j = 0; j < LPROCFS_HIST_MAX; j++)
+		total += buckets[j];
+	if (total == 0)
+		return 0;
+
+	lprocfs_stats_collect(stats, idx, &ret);
+	rc = seq_printf(p, "%-25s "LPU64" samples [%s]", header->lc_name,
+			total, header->lc_units);
+
+	/* each percentile is reported as the upper bound of its bucket */
+	for (i = j = 0; i < ARRAY_SIZE(lprocfs_stats_pcts) && rc >= 0; i++) {
+		while (j < LPROCFS_HIST_MAX - 1 &&
+		       (cum + buckets[j]) * 1000 <
+		       total * lprocfs_stats_pcts[i].permille)
+			cum += buckets[j++];
+		rc = seq_printf(p, " %s: "LPU64, lprocfs_stats_pcts[i].name,
+				min_t(__u64, 1ULL << j, ret.lc_max));
+	}
+	if (rc >= 0)
+		rc = seq_printf(p, " max: "LPD64"\n", ret.lc_max);
+
+	return (rc < 0) ? rc : 0;
+}
+
+struct seq_operations lprocfs_stats_latency_seq_sops = {
+	start: lprocfs_stats_seq_start,
+	stop:  lprocfs_stats_seq_stop,
+	next:  lprocfs_stats_seq_next,
+	show:  lprocfs_stats_latency_seq_show,
+};
+
+static int lprocfs_stats_latency_seq_open(struct inode *inode,
+					  struct file *file)
+{
+	struct proc_dir_entry	*dp = PDE(inode);
+	struct seq_file		*seq;
+	int			 rc;
+
+	if (LPROCFS_ENTRY_AND_CHECK(dp))
+		return -ENOENT;
+
+	rc = seq_open(file, &lprocfs_stats_latency_seq_sops);
+	if (rc) {
+		LPROCFS_EXIT();
+		return rc;
+	}
+	seq = file->private_data;
+	seq->private = dp->data;
+	return 0;
+}
+
+struct file_operations lprocfs_stats_latency_seq_fops = {
+	.owner   = THIS_MODULE,
+	.open    = lprocfs_stats_latency_seq_open,
+	.read    = seq_read,
+	.write   = lprocfs_stats_seq_write,
+	.llseek  = seq_lseek,
+	.release = lprocfs_seq_release,
+};
+
 int lprocfs_register_stats(struct proc_dir_entry *root, const char *name,
                            struct lprocfs_stats *stats)
 {
         struct proc_dir_entry *entry;
+        char                   latency[MAX_STRING_SIZE];
         LASSERT(root != NULL);
 
         LPROCFS_WRITE_ENTRY();
@@ -1608,6 +1738,16 @@ int lprocfs_register_stats(struct proc_dir_entry *root, const char *name,
                 entry->data = stats;
         }
 
+        /* histograms of the counters go next to the stats */
+        if (entry != NULL && stats->ls_hist != NULL) {
+                snprintf(latency, sizeof(latency), "%s_latency", name);
+                entry = create_proc_entry(latency, 0644, root);
+                if (entry) {
+                        entry->proc_fops = &lprocfs_stats_latency_seq_fops;
+                        entry->data = stats;
+                }
+        }
+
         LPROCFS_WRITE_EXIT();
 
         if (entry == NULL)
@@ -1617,6 +1757,40 @@ int lprocfs_register_stats(struct proc_dir_entry *root, const char *name,
 }
 EXPORT_SYMBOL(lprocfs_register_stats);
 
+/*
+ * Allocate the histograms of all CPUs the first time a counter of \a stats
+ * asks for one, lprocfs_counter_add() may run in atomic context and only
+ * tallies into them.
+ */
+static int lprocfs_stats_alloc_hist(struct lprocfs_stats *stats)
+{
+	__u32		**hist;
+	unsigned int	  num_cpu;
+	unsigned int	  i;
+
+	num_cpu = (stats->ls_flags & LPROCFS_STATS_FLAG_NOPERCPU) ?
+		  1 : cfs_num_possible_cpus();
+	LIBCFS_ALLOC(hist, num_cpu * sizeof(__u32 *));
+	if (hist == NULL)
+		return -ENOMEM;
+
+	for (i = 0; i < num_cpu; i++) {
+		LIBCFS_ALLOC(hist[i], stats->ls_num * LPROCFS_HIST_MAX *
+				      sizeof(__u32));
+		if (hist[i] == NULL)
+			goto out_free;
+	}
+	stats->ls_hist = hist;
+	return 0;
+
+out_free:
+	while (i-- > 0)
+		LIBCFS_FREE(hist[i], stats->ls_num * LPROCFS_HIST_MAX *
+				     sizeof(__u32));
+	LIBCFS_FREE(hist, num_cpu * sizeof(__u32 *));
+	return -ENOMEM;
+}
+
 void lprocfs_counter_init(struct lprocfs_stats *stats, int index,
 			  unsigned conf, const char *name, const char *units)
 {
@@ -1632,6 +1806,10 @@ void lprocfs_counter_init(struct lprocfs_stats *stats, int index,
 	LASSERTF(header != NULL, "Failed to allocate stats header:[%d]%s/%s\n",
 		 index, name, units);
 
+	if ((conf & LPROCFS_CNTR_HISTOGRAM) && stats->ls_hist == NULL &&
+	    lprocfs_stats_alloc_hist(stats) != 0)
+		conf &= ~LPROCFS_CNTR_HISTOGRAM;
+
 	header->lc_config = conf;
 	header->lc_name   = name;
 	header->lc_units  = units;
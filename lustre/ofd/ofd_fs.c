@@ -577,6 +577,9 @@ int ofd_server_data_init(const struct lu_env *env, struct ofd_device *ofd)
 	obd->u.obt.obt_instance = (__u32)obd->u.obt.obt_mount_count;
 	ofd->ofd_subdir_count = lsd->lsd_subdir_count;
 
+	/* make older versions refuse the on-disk format of the OSD */
+	lsd->lsd_feature_incompat |= ofd->ofd_dt_conf.ddp_incompat;
+
 	if (lsd->lsd_feature_incompat & ~OFD_INCOMPAT_SUPP) {
 		CERROR("%s: unsupported incompat filesystem feature(s) %x\n",
 		       obd->obd_name,
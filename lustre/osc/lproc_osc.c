@@ -119,6 +119,128 @@ static int osc_wr_max_rpcs_in_flight(struct file *file, const char *buffer,
         return count;
 }
 
+static int osc_rd_max_rpcs_in_flight_auto(char *page, char **start, off_t off,
+					  int count, int *eof, void *data)
+{
+	struct obd_device *dev = data;
+	struct client_obd *cli = &dev->u.cli;
+	int rc;
+
+	client_obd_list_lock(&cli->cl_loi_list_lock);
+	rc = snprintf(page, count,
+		      "enabled: %d\n"
+		      "rpc_time_usec: %ld\n"
+		      "base_rpc_time_usec: %ld\n"
+		      "server_estimate_sec: %u\n",
+		      cli->cl_rif_auto, cli->cl_rif_rtt, cli->cl_rif_base_rtt,
+		      cli->cl_rif_srv_est);
+	client_obd_list_unlock(&cli->cl_loi_list_lock);
+	return rc;
+}
+
+static int osc_wr_max_rpcs_in_flight_auto(struct file *file,
+					  const char *buffer,
+					  unsigned long count, void *data)
+{
+	struct obd_device *dev = data;
+	struct client_obd *cli = &dev->u.cli;
+	struct ptlrpc_request_pool *pool;
+	int val, rc;
+
+	buffer = lprocfs_find_named_value(buffer, "enabled:", &count);
+	rc = lprocfs_write_helper(buffer, count, &val);
+	if (rc)
+		return rc;
+
+	LPROCFS_CLIMP_CHECK(dev);
+	/* the request pool covers the most RPCs the adaption can allow */
+	pool = cli->cl_import->imp_rq_pool;
+	if (pool && val && !cli->cl_rif_auto &&
+	    cli->cl_rif_max > cli->cl_max_rpcs_in_flight)
+		pool->prp_populate(pool,
+				   cli->cl_rif_max - cli->cl_max_rpcs_in_flight);
+
+	client_obd_list_lock(&cli->cl_loi_list_lock);
+	cli->cl_rif_auto = !!val;
+	cli->cl_rif_samples = 0;
+	cli->cl_rif_rtt = 0;
+	cli->cl_rif_base_rtt = 0;
+	cli->cl_rif_srv_est = 0;
+	client_obd_list_unlock(&cli->cl_loi_list_lock);
+
+	LPROCFS_CLIMP_EXIT(dev);
+	return count;
+}
+
+static int osc_rd_max_rpcs_in_flight_min(char *page, char **start, off_t off,
+					 int count, int *eof, void *data)
+{
+	struct obd_device *dev = data;
+	struct client_obd *cli = &dev->u.cli;
+
+	return snprintf(page, count, "%d\n", cli->cl_rif_min);
+}
+
+static int osc_wr_max_rpcs_in_flight_min(struct file *file,
+					 const char *buffer,
+					 unsigned long count, void *data)
+{
+	struct obd_device *dev = data;
+	struct client_obd *cli = &dev->u.cli;
+	int val, rc;
+
+	rc = lprocfs_write_helper(buffer, count, &val);
+	if (rc)
+		return rc;
+
+	client_obd_list_lock(&cli->cl_loi_list_lock);
+	if (val < 1 || val > cli->cl_rif_max) {
+		client_obd_list_unlock(&cli->cl_loi_list_lock);
+		return -ERANGE;
+	}
+	cli->cl_rif_min = val;
+	client_obd_list_unlock(&cli->cl_loi_list_lock);
+	return count;
+}
+
+static int osc_rd_max_rpcs_in_flight_max(char *page, char **start, off_t off,
+					 int count, int *eof, void *data)
+{
+	struct obd_device *dev = data;
+	struct client_obd *cli = &dev->u.cli;
+
+	return snprintf(page, count, "%d\n", cli->cl_rif_max);
+}
+
+static int osc_wr_max_rpcs_in_flight_max(struct file *file,
+					 const char *buffer,
+					 unsigned long count, void *data)
+{
+	struct obd_device *dev = data;
+	struct client_obd *cli = &dev->u.cli;
+	struct ptlrpc_request_pool *pool;
+	int val, rc;
+
+	rc = lprocfs_write_helper(buffer, count, &val);
+	if (rc)
+		return rc;
+
+	if (val < cli->cl_rif_min || val > OSC_MAX_RIF_MAX)
+		return -ERANGE;
+
+	LPROCFS_CLIMP_CHECK(dev);
+	pool = cli->cl_import->imp_rq_pool;
+	if (pool && cli->cl_rif_auto && val > cli->cl_rif_max)
+		pool->prp_populate(pool, val - cli->cl_rif_max);
+
+	client_obd_list_lock(&cli->cl_loi_list_lock);
+	cli->cl_rif_max = val;
+	client_obd_list_unlock(&cli->cl_loi_list_lock);
+
+	LPROCFS_CLIMP_EXIT(dev);
+	return count;
+}
+
 static int osc_rd_max_dirty_mb(char *page, char **start, off_t off, int count,
                                int *eof, void *data)
 {
@@ -170,10 +292,17 @@ static int osc_rd_cached_mb(char *page, char **start, off_t off, int count,
 
 	rc = snprintf(page, count,
 		      "used_mb: %d\n"
-		      "busy_cnt: %d\n",
+		      "busy_cnt: %d\n"
+		      "lru_shards: %d\n"
+		      "lru_scanned: %d\n"
+		      "lru_reclaimed: %d\n",
 		      (cfs_atomic_read(&cli->cl_lru_in_list) +
 			cfs_atomic_read(&cli->cl_lru_busy)) >> shift,
-		      cfs_atomic_read(&cli->cl_lru_busy));
+		      cfs_atomic_read(&cli->cl_lru_busy),
+		      cli->cl_lru_shards == NULL ? 0 :
+			cfs_percpt_number(cli->cl_lru_shards),
+		      cfs_atomic_read(&cli->cl_lru_scanned),
+		      cfs_atomic_read(&cli->cl_lru_reclaimed));
 
 	return rc;
 }
@@ -418,6 +547,31 @@ static int osc_wr_resend_count(struct file *file, const char *buffer,
         return count;
 }
 
+static int osc_rd_short_io_bytes(char *page, char **start, off_t off,
+				 int count, int *eof, void *data)
+{
+	struct obd_device *dev = data;
+
+	return snprintf(page, count, "%d\n", dev->u.cli.cl_short_io_bytes);
+}
+
+static int osc_wr_short_io_bytes(struct file *file, const char *buffer,
+				 unsigned long count, void *data)
+{
+	struct obd_device *dev = data;
+	int val, rc;
+
+	rc = lprocfs_write_helper(buffer, count, &val);
+	if (rc)
+		return rc;
+
+	if (val < 0 || val > OBD_MAX_SHORT_IO_BYTES)
+		return -ERANGE;
+
+	dev->u.cli.cl_short_io_bytes = val;
+	return count;
+}
+
 static int osc_rd_contention_seconds(char *page, char **start, off_t off,
                                      int count, int *eof, void *data)
 {
@@ -487,6 +641,10 @@ static int lprocfs_osc_wr_max_pages_per_rpc(struct file *file,
 	}
 	client_obd_list_lock(&cli->cl_loi_list_lock);
 	cli->cl_max_pages_per_rpc = val;
+	/* RPC times sampled for the old size don't apply any more */
+	cli->cl_rif_samples = 0;
+	cli->cl_rif_rtt = 0;
+	cli->cl_rif_base_rtt = 0;
 	client_obd_list_unlock(&cli->cl_loi_list_lock);
 
 	LPROCFS_CLIMP_EXIT(dev);
@@ -512,6 +670,12 @@ static struct lprocfs_vars lprocfs_osc_obd_vars[] = {
 			       lprocfs_osc_wr_max_pages_per_rpc, 0 },
         { "max_rpcs_in_flight", osc_rd_max_rpcs_in_flight,
                                 osc_wr_max_rpcs_in_flight, 0 },
+	{ "max_rpcs_in_flight_auto", osc_rd_max_rpcs_in_flight_auto,
+				     osc_wr_max_rpcs_in_flight_auto, 0 },
+	{ "max_rpcs_in_flight_min", osc_rd_max_rpcs_in_flight_min,
+				    osc_wr_max_rpcs_in_flight_min, 0 },
+	{ "max_rpcs_in_flight_max", osc_rd_max_rpcs_in_flight_max,
+				    osc_wr_max_rpcs_in_flight_max, 0 },
         { "destroys_in_flight", osc_rd_destroys_in_flight, 0, 0 },
         { "max_dirty_mb",    osc_rd_max_dirty_mb, osc_wr_max_dirty_mb, 0 },
 	{ "osc_cached_mb",   osc_rd_cached_mb,     osc_wr_cached_mb, 0 },
@@ -524,6 +688,7 @@ static struct lprocfs_vars lprocfs_osc_obd_vars[] = {
         { "checksums",       osc_rd_checksum, osc_wr_checksum, 0 },
         { "checksum_type",   osc_rd_checksum_type, osc_wd_checksum_type, 0 },
         { "resend_count",    osc_rd_resend_count, osc_wr_resend_count, 0},
+	{ "short_io_bytes",  osc_rd_short_io_bytes, osc_wr_short_io_bytes, 0 },
         { "timeouts",        lprocfs_rd_timeouts,      0, 0 },
         { "contention_seconds", osc_rd_contention_seconds,
                                 osc_wr_contention_seconds, 0 },
@@ -675,6 +840,10 @@ static int osc_stats_seq_show(struct seq_file *seq, void *v)
                    stats->os_lockless_reads);
         seq_printf(seq, "lockless_truncate\t\t"LPU64"\n",
                    stats->os_lockless_truncates);
+	seq_printf(seq, "short_io_write_rpcs\t\t"LPU64"\n",
+		   stats->os_short_io_writes);
+	seq_printf(seq, "short_io_read_rpcs\t\t"LPU64"\n",
+		   stats->os_short_io_reads);
         return 0;
 }
 
@@ -370,7 +370,12 @@ struct osc_page {
 	/**
          * Set if the page must be transferred with OBD_BRW_SRVLOCK.
          */
-                              ops_srvlock:1;
+                              ops_srvlock:1,
+	/**
+	 * Set if the page was written by a streaming write and is to be
+	 * dropped from the cache soon after its transfer completes.
+	 */
+			      ops_stream:1;
 	union {
 		/**
 		 * lru page list. ops_inflight and ops_lru are exclusive so
@@ -383,6 +388,16 @@ struct osc_page {
 		 */
 		cfs_list_t            ops_inflight;
 	};
+	/**
+	 * CPU partition of the client_obd::cl_lru_shards list holding this
+	 * page while it is in LRU, chosen once in osc_lru_reserve().
+	 */
+	int                   ops_lru_cpt;
+	/**
+	 * True iff the page is on cl_lru_shard::cls_stream and counted in
+	 * client_obd::cl_lru_stream. Protected by cl_lru_shard::cls_lock.
+	 */
+	int                   ops_lru_stream;
         /**
          * Thread that submitted this page for transfer. For debugging.
          */
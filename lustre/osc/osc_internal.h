@@ -129,7 +129,10 @@ int osc_sync_base(struct obd_export *exp, struct obd_info *oinfo,
 int osc_process_config_base(struct obd_device *obd, struct lustre_cfg *cfg);
 int osc_build_rpc(const struct lu_env *env, struct client_obd *cli,
 		  cfs_list_t *ext_list, int cmd, pdl_policy_t p);
+int osc_lru_setup(struct client_obd *cli);
+void osc_lru_cleanup(struct client_obd *cli);
 int osc_lru_shrink(struct client_obd *cli, int target);
+int osc_lru_shrink_stream(struct client_obd *cli);
 
 extern spinlock_t osc_ast_guard;
 
@@ -174,6 +177,8 @@ struct osc_device {
                 uint64_t     os_lockless_writes;          /* by bytes */
                 uint64_t     os_lockless_reads;           /* by bytes */
                 uint64_t     os_lockless_truncates;       /* by times */
+		uint64_t     os_short_io_writes;          /* by RPCs */
+		uint64_t     os_short_io_reads;           /* by RPCs */
         } od_stats;
 
         /* configuration item(s) */
@@ -659,6 +659,8 @@ static void osc_io_fsync_end(const struct lu_env *env,
 		if (result == 0)
 			result = cbargs->opc_rc;
 	}
+	/* the pages of streaming writes are clean now */
+	osc_lru_shrink_stream(osc_cli(cl2osc(obj)));
 	slice->cis_io->ci_result = result;
 }
 
@@ -223,6 +223,7 @@ static int osc_page_cache_add(const struct lu_env *env,
 
 	LINVRNT(osc_page_protected(env, opg, CLM_WRITE, 0));
 
+	opg->ops_stream = cl_io_is_stream_write(io);
 	osc_page_transfer_get(opg, "transfer\0cache");
 	result = osc_queue_async_io(env, io, opg);
 	if (result != 0)
@@ -654,21 +655,74 @@ static int discard_pagevec(const struct lu_env *env, struct cl_io *io,
 	return max_index - count;
 }
 
+int osc_lru_setup(struct client_obd *cli)
+{
+	struct cl_lru_shard *shard;
+	int i;
+
+	cli->cl_lru_shards = cfs_percpt_alloc(cfs_cpt_table, sizeof(*shard));
+	if (cli->cl_lru_shards == NULL)
+		return -ENOMEM;
+
+	cfs_percpt_for_each(shard, i, cli->cl_lru_shards) {
+		client_obd_list_lock_init(&shard->cls_lock);
+		CFS_INIT_LIST_HEAD(&shard->cls_list);
+		CFS_INIT_LIST_HEAD(&shard->cls_stream);
+	}
+	return 0;
+}
+
+void osc_lru_cleanup(struct client_obd *cli)
+{
+	struct cl_lru_shard *shard;
+	int i;
+
+	if (cli->cl_lru_shards == NULL)
+		return;
+
+	cfs_percpt_for_each(shard, i, cli->cl_lru_shards) {
+		LASSERT(cfs_list_empty(&shard->cls_list));
+		LASSERT(cfs_list_empty(&shard->cls_stream));
+		client_obd_list_lock_done(&shard->cls_lock);
+	}
+	cfs_percpt_free(cli->cl_lru_shards);
+	cli->cl_lru_shards = NULL;
+}
+
+/* take a page off the stream list accounting, called with cls_lock held */
+static void osc_lru_unstream(struct client_obd *cli, struct osc_page *opg)
+{
+	if (opg->ops_lru_stream) {
+		opg->ops_lru_stream = 0;
+		cfs_atomic_dec(&cli->cl_lru_stream);
+	}
+}
+
 /**
  * Drop @target of pages from LRU at most.
+ *
+ * The LRU lists of all CPU partitions are scanned, starting with the one of
+ * the current CPU, so that concurrent shrinkers mostly take different locks.
+ * Clean pages of streaming writes are dropped first, and if @stream is set
+ * they are the only ones dropped.
  */
-int osc_lru_shrink(struct client_obd *cli, int target)
+static int __osc_lru_shrink(struct client_obd *cli, int target, bool stream)
 {
 	struct cl_env_nest nest;
 	struct lu_env *env;
 	struct cl_io *io;
 	struct cl_object *clobj = NULL;
 	struct cl_page **pvec;
+	struct cl_lru_shard *shard;
 	struct osc_page *opg;
+	int ncpt = cfs_percpt_number(cli->cl_lru_shards);
+	int cpt = cfs_cpt_current(cfs_cpt_table, 1);
 	int maxscan = 0;
+	int scanned = 0;
 	int count = 0;
 	int index = 0;
 	int rc = 0;
+	int i;
 	ENTRY;
 
 	LASSERT(cfs_atomic_read(&cli->cl_lru_in_list) >= 0);
@@ -682,73 +736,95 @@ int osc_lru_shrink(struct client_obd *cli, int target)
 	pvec = osc_env_info(env)->oti_pvec;
 	io = &osc_env_info(env)->oti_io;
 
-	client_obd_list_lock(&cli->cl_lru_list_lock);
 	cfs_atomic_inc(&cli->cl_lru_shrinkers);
-	maxscan = min(target << 1, cfs_atomic_read(&cli->cl_lru_in_list));
-	while (!cfs_list_empty(&cli->cl_lru_list)) {
-		struct cl_page *page;
-
-		if (--maxscan < 0)
-			break;
+	maxscan = min(target << 1, cfs_atomic_read(stream ? &cli->cl_lru_stream :
+						   &cli->cl_lru_in_list));
+	for (i = 0; i < ncpt && rc == 0 && maxscan > 0 && count < target;
+	     i++) {
+		shard = cli->cl_lru_shards[(cpt + i) % ncpt];
+
+		client_obd_list_lock(&shard->cls_lock);
+		while (1) {
+			struct cl_page *page;
+			cfs_list_t *head;
+
+			if (!cfs_list_empty(&shard->cls_stream))
+				head = &shard->cls_stream;
+			else if (!stream && !cfs_list_empty(&shard->cls_list))
+				head = &shard->cls_list;
+			else
+				break;
 
-		opg = cfs_list_entry(cli->cl_lru_list.next, struct osc_page,
-				     ops_lru);
-		page = cl_page_top(opg->ops_cl.cpl_page);
-		if (cl_page_in_use_noref(page)) {
-			cfs_list_move_tail(&opg->ops_lru, &cli->cl_lru_list);
-			continue;
-		}
+			if (--maxscan < 0)
+				break;
 
-		LASSERT(page->cp_obj != NULL);
-		if (clobj != page->cp_obj) {
-			struct cl_object *tmp = page->cp_obj;
+			++scanned;
+			opg = cfs_list_entry(head->next, struct osc_page,
+					     ops_lru);
+			page = cl_page_top(opg->ops_cl.cpl_page);
+			if (cl_page_in_use_noref(page)) {
+				/* a busy streamed page joins the normal LRU */
+				osc_lru_unstream(cli, opg);
+				cfs_list_move_tail(&opg->ops_lru,
+						   &shard->cls_list);
+				continue;
+			}
 
-			cl_object_get(tmp);
-			client_obd_list_unlock(&cli->cl_lru_list_lock);
+			LASSERT(page->cp_obj != NULL);
+			if (clobj != page->cp_obj) {
+				struct cl_object *tmp = page->cp_obj;
 
-			if (clobj != NULL) {
-				count -= discard_pagevec(env, io, pvec, index);
-				index = 0;
+				cl_object_get(tmp);
+				client_obd_list_unlock(&shard->cls_lock);
 
-				cl_io_fini(env, io);
-				cl_object_put(env, clobj);
-				clobj = NULL;
-			}
+				if (clobj != NULL) {
+					count -= discard_pagevec(env, io, pvec,
+								 index);
+					index = 0;
 
-			clobj = tmp;
-			io->ci_obj = clobj;
-			rc = cl_io_init(env, io, CIT_MISC, clobj);
+					cl_io_fini(env, io);
+					cl_object_put(env, clobj);
+					clobj = NULL;
+				}
 
-			client_obd_list_lock(&cli->cl_lru_list_lock);
+				clobj = tmp;
+				io->ci_obj = clobj;
+				rc = cl_io_init(env, io, CIT_MISC, clobj);
 
-			if (rc != 0)
-				break;
+				client_obd_list_lock(&shard->cls_lock);
 
-			++maxscan;
-			continue;
-		}
+				if (rc != 0)
+					break;
 
-		/* move this page to the end of list as it will be discarded
-		 * soon. The page will be finally removed from LRU list in
-		 * osc_page_delete().  */
-		cfs_list_move_tail(&opg->ops_lru, &cli->cl_lru_list);
+				++maxscan;
+				--scanned;
+				continue;
+			}
 
-		/* it's okay to grab a refcount here w/o holding lock because
-		 * it has to grab cl_lru_list_lock to delete the page. */
-		cl_page_get(page);
-		pvec[index++] = page;
-		if (++count >= target)
-			break;
+			/* move this page to the end of list as it will be
+			 * discarded soon. The page will be finally removed
+			 * from LRU list in osc_page_delete().  */
+			osc_lru_unstream(cli, opg);
+			cfs_list_move_tail(&opg->ops_lru, &shard->cls_list);
+
+			/* it's okay to grab a refcount here w/o holding lock
+			 * because it has to grab cls_lock to delete the
+			 * page. */
+			cl_page_get(page);
+			pvec[index++] = page;
+			if (++count >= target)
+				break;
 
-		if (unlikely(index == OTI_PVEC_SIZE)) {
-			client_obd_list_unlock(&cli->cl_lru_list_lock);
-			count -= discard_pagevec(env, io, pvec, index);
-			index = 0;
+			if (unlikely(index == OTI_PVEC_SIZE)) {
+				client_obd_list_unlock(&shard->cls_lock);
+				count -= discard_pagevec(env, io, pvec, index);
+				index = 0;
 
-			client_obd_list_lock(&cli->cl_lru_list_lock);
+				client_obd_list_lock(&shard->cls_lock);
+			}
 		}
+		client_obd_list_unlock(&shard->cls_lock);
 	}
-	client_obd_list_unlock(&cli->cl_lru_list_lock);
 
 	if (clobj != NULL) {
 		count -= discard_pagevec(env, io, pvec, index);
@@ -758,25 +834,55 @@ int osc_lru_shrink(struct client_obd *cli, int target)
 	}
 	cl_env_nested_put(&nest, env);
 
+	cfs_atomic_add(scanned, &cli->cl_lru_scanned);
+	if (count > 0)
+		cfs_atomic_add(count, &cli->cl_lru_reclaimed);
 	cfs_atomic_dec(&cli->cl_lru_shrinkers);
 	RETURN(count > 0 ? count : rc);
 }
 
+int osc_lru_shrink(struct client_obd *cli, int target)
+{
+	return __osc_lru_shrink(cli, target, false);
+}
+
+/**
+ * Drop the clean pages of streaming writes. This is called by the threads
+ * adding pages to the cache or waiting for them to be written, not from
+ * brw_interpret(), so that ptlrpcd doesn't block on page discards.
+ */
+int osc_lru_shrink_stream(struct client_obd *cli)
+{
+	int nr = cfs_atomic_read(&cli->cl_lru_stream);
+
+	return nr > 0 ? __osc_lru_shrink(cli, nr, true) : 0;
+}
+
 static void osc_lru_add(struct client_obd *cli, struct osc_page *opg)
 {
+	struct cl_lru_shard *shard;
 	bool wakeup = false;
 
 	if (!opg->ops_in_lru)
 		return;
 
 	cfs_atomic_dec(&cli->cl_lru_busy);
-	client_obd_list_lock(&cli->cl_lru_list_lock);
+	shard = cli->cl_lru_shards[opg->ops_lru_cpt];
+	client_obd_list_lock(&shard->cls_lock);
 	if (cfs_list_empty(&opg->ops_lru)) {
-		cfs_list_move_tail(&opg->ops_lru, &cli->cl_lru_list);
+		/* streamed pages are kept apart so that exactly those are
+		 * dropped, see osc_lru_reserve() */
+		if (opg->ops_stream) {
+			cfs_list_move_tail(&opg->ops_lru, &shard->cls_stream);
+			opg->ops_lru_stream = 1;
+			cfs_atomic_inc(&cli->cl_lru_stream);
+		} else {
+			cfs_list_move_tail(&opg->ops_lru, &shard->cls_list);
+		}
 		cfs_atomic_inc_return(&cli->cl_lru_in_list);
 		wakeup = cfs_atomic_read(&osc_lru_waiters) > 0;
 	}
-	client_obd_list_unlock(&cli->cl_lru_list_lock);
+	client_obd_list_unlock(&shard->cls_lock);
 
 	if (wakeup)
 		cfs_waitq_broadcast(&osc_lru_waitq);
@@ -787,9 +893,13 @@ static void osc_lru_add(struct client_obd *cli, struct osc_page *opg)
 static void osc_lru_del(struct client_obd *cli, struct osc_page *opg, bool del)
 {
 	if (opg->ops_in_lru) {
-		client_obd_list_lock(&cli->cl_lru_list_lock);
+		struct cl_lru_shard *shard;
+
+		shard = cli->cl_lru_shards[opg->ops_lru_cpt];
+		client_obd_list_lock(&shard->cls_lock);
 		if (!cfs_list_empty(&opg->ops_lru)) {
 			LASSERT(cfs_atomic_read(&cli->cl_lru_in_list) > 0);
+			osc_lru_unstream(cli, opg);
 			cfs_list_del_init(&opg->ops_lru);
 			cfs_atomic_dec(&cli->cl_lru_in_list);
 			if (!del)
@@ -798,7 +908,7 @@ static void osc_lru_del(struct client_obd *cli, struct osc_page *opg, bool del)
 			LASSERT(cfs_atomic_read(&cli->cl_lru_busy) > 0);
 			cfs_atomic_dec(&cli->cl_lru_busy);
 		}
-		client_obd_list_unlock(&cli->cl_lru_list_lock);
+		client_obd_list_unlock(&shard->cls_lock);
 		if (del) {
 			cfs_atomic_inc(cli->cl_lru_left);
 			/* this is a great place to release more LRU pages if
@@ -883,6 +993,10 @@ static int osc_lru_reserve(const struct lu_env *env, struct osc_object *obj,
 	if (cli->cl_cache == NULL) /* shall not be in LRU */
 		RETURN(0);
 
+	/* drop the clean pages of streaming writes an RPC worth at a time */
+	if (cfs_atomic_read(&cli->cl_lru_stream) >= cli->cl_max_pages_per_rpc)
+		osc_lru_shrink_stream(cli);
+
 	LASSERT(cfs_atomic_read(cli->cl_lru_left) >= 0);
 	while (!cfs_atomic_add_unless(cli->cl_lru_left, -1, 0)) {
 		int gen;
@@ -914,6 +1028,9 @@ static int osc_lru_reserve(const struct lu_env *env, struct osc_object *obj,
 
 	if (rc >= 0) {
 		cfs_atomic_inc(&cli->cl_lru_busy);
+		/* the page stays on this shard, it may be on its list when
+		 * osc_lru_add() is called again */
+		opg->ops_lru_cpt = cfs_cpt_current(cfs_cpt_table, 1);
 		opg->ops_in_lru = 1;
 		rc = 0;
 	}
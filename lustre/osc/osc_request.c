@@ -1124,6 +1124,57 @@ static void handle_short_read(int nob_read, obd_count page_count,
         }
 }
 
+/* Copy the data of a short I/O between its pages and the RPC buffer */
+static void osc_short_io_copy(obd_count page_count, struct brw_page **pga,
+			      char *buf, int nob, int to_buf)
+{
+	char *ptr;
+	int len;
+	int i;
+
+	for (i = 0; i < page_count && nob > 0; i++) {
+		len = min_t(int, pga[i]->count, nob);
+		ptr = cfs_kmap(pga[i]->pg) + (pga[i]->off & ~CFS_PAGE_MASK);
+		if (to_buf)
+			memcpy(buf, ptr, len);
+		else
+			memcpy(ptr, buf, len);
+		cfs_kunmap(pga[i]->pg);
+		buf += len;
+		nob -= len;
+	}
+}
+
+/* Returns the size of a BRW small enough to carry its data in the RPC
+ * itself, or 0 if it must go by bulk */
+static int osc_brw_short_io_size(struct client_obd *cli, obd_count page_count,
+				 struct brw_page **pga)
+{
+	struct ptlrpc_sec *sec;
+	int nob = 0;
+	int i;
+
+	if (!(cli->cl_import->imp_connect_data.ocd_connect_flags &
+	      OBD_CONNECT_SHORTIO))
+		return 0;
+
+	/* keep the data under the bulk protection of the flavor, if any */
+	sec = sptlrpc_import_sec_ref(cli->cl_import);
+	if (sec != NULL) {
+		i = sptlrpc_flavor_has_bulk(&sec->ps_flvr);
+		sptlrpc_sec_put(sec);
+		if (i)
+			return 0;
+	}
+
+	for (i = 0; i < page_count; i++) {
+		nob += pga[i]->count;
+		if (nob > cli->cl_short_io_bytes)
+			return 0;
+	}
+	return nob;
+}
+
 static int check_write_rcs(struct ptlrpc_request *req,
                            int requested_nob, int niocount,
                            obd_count page_count, struct brw_page **pga)
@@ -1151,7 +1202,8 @@ static int check_write_rcs(struct ptlrpc_request *req,
                 }
         }
 
-        if (req->rq_bulk->bd_nob_transferred != requested_nob) {
+        if (req->rq_bulk != NULL &&
+            req->rq_bulk->bd_nob_transferred != requested_nob) {
                 CERROR("Unexpected # bytes transferred: %d (requested %d)\n",
                        req->rq_bulk->bd_nob_transferred, requested_nob);
                 return(-EPROTO);
@@ -1244,7 +1296,7 @@ static int osc_brw_prep_request(int cmd, struct client_obd *cli,struct obdo *oa,
                                 int resend)
 {
         struct ptlrpc_request   *req;
-        struct ptlrpc_bulk_desc *desc;
+        struct ptlrpc_bulk_desc *desc = NULL;
         struct ost_body         *body;
         struct obd_ioobj        *ioobj;
         struct niobuf_remote    *niobuf;
@@ -1252,6 +1304,8 @@ static int osc_brw_prep_request(int cmd, struct client_obd *cli,struct obdo *oa,
         struct osc_brw_async_args *aa;
         struct req_capsule      *pill;
         struct brw_page *pg_prev;
+	char *short_io_buf = NULL;
+	int short_io_size;
 
         ENTRY;
         if (OBD_FAIL_CHECK(OBD_FAIL_OSC_BRW_PREP_REQ))
@@ -1259,17 +1313,27 @@ static int osc_brw_prep_request(int cmd, struct client_obd *cli,struct obdo *oa,
         if (OBD_FAIL_CHECK(OBD_FAIL_OSC_BRW_PREP_REQ2))
                 RETURN(-EINVAL); /* Fatal */
 
+	short_io_size = osc_brw_short_io_size(cli, page_count, pga);
+again:
         if ((cmd & OBD_BRW_WRITE) != 0) {
                 opc = OST_WRITE;
+		/* the request pool is sized for writes carrying no data */
                 req = ptlrpc_request_alloc_pool(cli->cl_import,
+						short_io_size != 0 ? NULL :
                                                 cli->cl_import->imp_rq_pool,
                                                 &RQF_OST_BRW_WRITE);
         } else {
                 opc = OST_READ;
                 req = ptlrpc_request_alloc(cli->cl_import, &RQF_OST_BRW_READ);
         }
-        if (req == NULL)
+        if (req == NULL) {
+		/* a write can still go by bulk from the request pool */
+		if (opc == OST_WRITE && short_io_size != 0) {
+			short_io_size = 0;
+			goto again;
+		}
                 RETURN(-ENOMEM);
+        }
 
         for (niocount = i = 1; i < page_count; i++) {
                 if (!can_merge_pages(pga[i - 1], pga[i]))
@@ -1282,10 +1346,18 @@ static int osc_brw_prep_request(int cmd, struct client_obd *cli,struct obdo *oa,
         req_capsule_set_size(pill, &RMF_NIOBUF_REMOTE, RCL_CLIENT,
                              niocount * sizeof(*niobuf));
         osc_set_capa_size(req, &RMF_CAPA1, ocapa);
+	if (opc == OST_WRITE)
+		req_capsule_set_size(pill, &RMF_SHORT_IO, RCL_CLIENT,
+				     short_io_size);
 
         rc = ptlrpc_request_pack(req, LUSTRE_OST_VERSION, opc);
         if (rc) {
                 ptlrpc_request_free(req);
+		/* a write can still go by bulk from the request pool */
+		if (rc == -ENOMEM && opc == OST_WRITE && short_io_size != 0) {
+			short_io_size = 0;
+			goto again;
+		}
                 RETURN(rc);
         }
         req->rq_request_portal = OST_IO_PORTAL; /* bug 7198 */
@@ -1294,16 +1366,28 @@ static int osc_brw_prep_request(int cmd, struct client_obd *cli,struct obdo *oa,
 	 * retry logic */
 	req->rq_no_retry_einprogress = 1;
 
-        if (opc == OST_WRITE)
-                desc = ptlrpc_prep_bulk_imp(req, page_count,
-                                            BULK_GET_SOURCE, OST_BULK_PORTAL);
-        else
-                desc = ptlrpc_prep_bulk_imp(req, page_count,
-                                            BULK_PUT_SINK, OST_BULK_PORTAL);
-
-        if (desc == NULL)
-                GOTO(out, rc = -ENOMEM);
-        /* NB request now owns desc and will free it when it gets freed */
+	if (short_io_size != 0) {
+		/* the data travels in RMF_SHORT_IO, no bulk is needed */
+		if (opc == OST_WRITE) {
+			short_io_buf = req_capsule_client_get(pill,
+							      &RMF_SHORT_IO);
+			LASSERT(short_io_buf != NULL);
+		}
+	} else {
+		if (opc == OST_WRITE)
+			desc = ptlrpc_prep_bulk_imp(req, page_count,
+						    BULK_GET_SOURCE,
+						    OST_BULK_PORTAL);
+		else
+			desc = ptlrpc_prep_bulk_imp(req, page_count,
+						    BULK_PUT_SINK,
+						    OST_BULK_PORTAL);
+
+		if (desc == NULL)
+			GOTO(out, rc = -ENOMEM);
+		/* NB request now owns desc and will free it when it gets
+		 * freed */
+	}
 
         body = req_capsule_client_get(pill, &RMF_OST_BODY);
         ioobj = req_capsule_client_get(pill, &RMF_OBD_IOOBJ);
@@ -1345,7 +1429,9 @@ static int osc_brw_prep_request(int cmd, struct client_obd *cli,struct obdo *oa,
                 LASSERT((pga[0]->flag & OBD_BRW_SRVLOCK) ==
                         (pg->flag & OBD_BRW_SRVLOCK));
 
-		ptlrpc_prep_bulk_page_pin(desc, pg->pg, poff, pg->count);
+		if (desc != NULL)
+			ptlrpc_prep_bulk_page_pin(desc, pg->pg, poff,
+						  pg->count);
                 requested_nob += pg->count;
 
                 if (i > 0 && can_merge_pages(pg_prev, pg)) {
@@ -1373,6 +1459,20 @@ static int osc_brw_prep_request(int cmd, struct client_obd *cli,struct obdo *oa,
                 body->oa.o_flags |= OBD_FL_RECOV_RESEND;
         }
 
+	/* the flag may come back from an earlier reply in @oa */
+	if (body->oa.o_valid & OBD_MD_FLFLAGS)
+		body->oa.o_flags &= ~OBD_FL_SHORT_IO;
+	if (short_io_size != 0) {
+		if ((body->oa.o_valid & OBD_MD_FLFLAGS) == 0) {
+			body->oa.o_valid |= OBD_MD_FLFLAGS;
+			body->oa.o_flags = 0;
+		}
+		body->oa.o_flags |= OBD_FL_SHORT_IO;
+		if (short_io_buf != NULL)
+			osc_short_io_copy(page_count, pga, short_io_buf,
+					  short_io_size, 1);
+	}
+
         if (osc_should_shrink_grant(cli))
                 osc_shrink_grant_local(cli, &body->oa);
 
@@ -1416,6 +1516,8 @@ static int osc_brw_prep_request(int cmd, struct client_obd *cli,struct obdo *oa,
                         body->oa.o_flags |= cksum_type_pack(cli->cl_cksum_type);
                         body->oa.o_valid |= OBD_MD_FLCKSUM | OBD_MD_FLFLAGS;
                 }
+		req_capsule_set_size(pill, &RMF_SHORT_IO, RCL_SERVER,
+				     short_io_size);
         }
         ptlrpc_request_set_replen(req);
 
@@ -1534,10 +1636,12 @@ static int osc_brw_fini_request(struct ptlrpc_request *req, int rc)
                         CERROR("Unexpected +ve rc %d\n", rc);
                         RETURN(-EPROTO);
                 }
-                LASSERT(req->rq_bulk->bd_nob == aa->aa_requested_nob);
+		if (req->rq_bulk != NULL) {
+			LASSERT(req->rq_bulk->bd_nob == aa->aa_requested_nob);
 
-                if (sptlrpc_cli_unwrap_bulk_write(req, req->rq_bulk))
-                        RETURN(-EAGAIN);
+			if (sptlrpc_cli_unwrap_bulk_write(req, req->rq_bulk))
+				RETURN(-EAGAIN);
+		}
 
                 if ((aa->aa_oa->o_valid & OBD_MD_FLCKSUM) && client_cksum &&
                     check_write_checksum(&body->oa, peer, client_cksum,
@@ -1553,10 +1657,12 @@ static int osc_brw_fini_request(struct ptlrpc_request *req, int rc)
 
         /* The rest of this function executes only for OST_READs */
 
-        /* if unwrap_bulk failed, return -EAGAIN to retry */
-        rc = sptlrpc_cli_unwrap_bulk_read(req, req->rq_bulk, rc);
-        if (rc < 0)
-                GOTO(out, rc = -EAGAIN);
+	if (req->rq_bulk != NULL) {
+		/* if unwrap_bulk failed, return -EAGAIN to retry */
+		rc = sptlrpc_cli_unwrap_bulk_read(req, req->rq_bulk, rc);
+		if (rc < 0)
+			GOTO(out, rc = -EAGAIN);
+	}
 
         if (rc > aa->aa_requested_nob) {
                 CERROR("Unexpected rc %d (%d requested)\n", rc,
@@ -1564,7 +1670,21 @@ static int osc_brw_fini_request(struct ptlrpc_request *req, int rc)
                 RETURN(-EPROTO);
         }
 
-        if (rc != req->rq_bulk->bd_nob_transferred) {
+	if (req->rq_bulk == NULL) {
+		/* short I/O, the data came back in the reply itself */
+		char *buf = NULL;
+
+		if (rc > 0) {
+			buf = req_capsule_server_sized_get(&req->rq_pill,
+							   &RMF_SHORT_IO, rc);
+			if (buf == NULL) {
+				CERROR("Missing/short short I/O data, rc %d\n",
+				       rc);
+				RETURN(-EPROTO);
+			}
+		}
+		osc_short_io_copy(aa->aa_page_count, aa->aa_ppga, buf, rc, 0);
+	} else if (rc != req->rq_bulk->bd_nob_transferred) {
                 CERROR ("Unexpected rc %d (%d transferred)\n",
                         rc, req->rq_bulk->bd_nob_transferred);
                 return (-EPROTO);
@@ -1586,7 +1706,8 @@ static int osc_brw_fini_request(struct ptlrpc_request *req, int rc)
                                                  aa->aa_ppga, OST_READ,
                                                  cksum_type);
 
-                if (peer->nid == req->rq_bulk->bd_sender) {
+                if (req->rq_bulk == NULL ||
+                    peer->nid == req->rq_bulk->bd_sender) {
                         via = router = "";
                 } else {
                         via = " via ";
@@ -1940,6 +2061,71 @@ out:
         RETURN(rc);
 }
 
+/* Bounds on the number of RPCs estimated to be queued at the OSS beyond what
+ * an uncongested path holds, see osc_rif_update(). */
+#define OSC_RIF_ALPHA	1
+#define OSC_RIF_BETA	3
+
+/**
+ * Adapt cl_max_rpcs_in_flight to the time BRW RPCs take, like TCP Vegas does
+ * with its congestion window. The RPCs queued at the OSS are estimated from
+ * how much the smoothed RPC time exceeds the lowest one seen. Once per window
+ * of cl_max_rpcs_in_flight replies one more RPC is allowed if fewer than
+ * OSC_RIF_ALPHA are queued, and one less if more than OSC_RIF_BETA are
+ * queued or the OSS advertises a longer service estimate than before.
+ *
+ * Only full-size RPCs of \a pages pages are sampled, the time of smaller
+ * ones would make full-size RPCs look queued.
+ *
+ * Called with cl_loi_list_lock held.
+ */
+static void osc_rif_update(struct client_obd *cli, int pages, long usec,
+			   unsigned int srv_est)
+{
+	int rif = cli->cl_max_rpcs_in_flight;
+	__u64 queued;
+
+	if (!cli->cl_rif_auto || usec <= 0 ||
+	    pages < cli->cl_max_pages_per_rpc)
+		return;
+
+	if (cli->cl_rif_rtt == 0)
+		cli->cl_rif_rtt = usec;
+	else
+		cli->cl_rif_rtt += (usec - cli->cl_rif_rtt) / 8;
+	if (cli->cl_rif_base_rtt == 0 || usec < cli->cl_rif_base_rtt)
+		cli->cl_rif_base_rtt = usec;
+
+	if (++cli->cl_rif_samples < rif)
+		return;
+	cli->cl_rif_samples = 0;
+
+	queued = 0;
+	if (cli->cl_rif_rtt > cli->cl_rif_base_rtt) {
+		queued = (__u64)rif * (cli->cl_rif_rtt - cli->cl_rif_base_rtt);
+		do_div(queued, cli->cl_rif_rtt);
+	}
+
+	if (queued > OSC_RIF_BETA ||
+	    (cli->cl_rif_srv_est != 0 && srv_est > cli->cl_rif_srv_est))
+		rif--;
+	else if (queued < OSC_RIF_ALPHA)
+		rif++;
+	rif = max(cli->cl_rif_min, min(rif, cli->cl_rif_max));
+
+	/* let the uncongested time follow lasting changes of the path */
+	cli->cl_rif_base_rtt += (cli->cl_rif_rtt - cli->cl_rif_base_rtt) / 64;
+	cli->cl_rif_srv_est = srv_est;
+
+	if (rif != cli->cl_max_rpcs_in_flight)
+		CDEBUG(D_CACHE, "%s: max_rpcs_in_flight %d -> %d, rpc time "
+		       "%ld usec, base %ld usec, queued "LPU64"\n",
+		       cli->cl_import->imp_obd->obd_name,
+		       cli->cl_max_rpcs_in_flight, rif, cli->cl_rif_rtt,
+		       cli->cl_rif_base_rtt, queued);
+	cli->cl_max_rpcs_in_flight = rif;
+}
+
 static int brw_interpret(const struct lu_env *env,
                          struct ptlrpc_request *req, void *data, int rc)
 {
@@ -1948,6 +2134,7 @@ static int brw_interpret(const struct lu_env *env,
 	struct osc_extent *tmp;
 	struct cl_object  *obj = NULL;
 	struct client_obd *cli = aa->aa_cli;
+	int nob;
         ENTRY;
 
         rc = osc_brw_fini_request(req, rc);
@@ -2025,12 +2212,38 @@ static int brw_interpret(const struct lu_env *env,
 	}
 	OBDO_FREE(aa->aa_oa);
 
-	cl_req_completion(env, aa->aa_clerq, rc < 0 ? rc :
-			  req->rq_bulk->bd_nob_transferred);
+	if (req->rq_bulk != NULL)
+		nob = req->rq_bulk->bd_nob_transferred;
+	else if (rc < 0)
+		nob = 0;
+	else if (lustre_msg_get_opc(req->rq_reqmsg) == OST_READ)
+		/* a short read returns the bytes read, less at EOF */
+		nob = max(req->rq_status, 0);
+	else
+		nob = aa->aa_requested_nob;
+	cl_req_completion(env, aa->aa_clerq, rc < 0 ? rc : nob);
 	osc_release_ppga(aa->aa_ppga, aa->aa_page_count);
-	ptlrpc_lprocfs_brw(req, req->rq_bulk->bd_nob_transferred);
+	ptlrpc_lprocfs_brw(req, nob);
 
 	client_obd_list_lock(&cli->cl_loi_list_lock);
+	if (rc >= 0 && req->rq_bulk == NULL) {
+		struct osc_stats *stats = &obd2osc_dev(cli->cl_import->
+						       imp_obd)->od_stats;
+
+		if (lustre_msg_get_opc(req->rq_reqmsg) == OST_WRITE)
+			stats->os_short_io_writes++;
+		else
+			stats->os_short_io_reads++;
+	}
+	if (rc >= 0 && cli->cl_rif_auto) {
+		struct timeval now;
+
+		cfs_gettimeofday(&now);
+		osc_rif_update(cli, aa->aa_page_count,
+			       cfs_timeval_sub(&now, &req->rq_arrival_time,
+					       NULL),
+			       lustre_msg_get_timeout(req->rq_repmsg));
+	}
 	/* We need to decrement before osc_ap_completion->osc_wake_cache_waiters
 	 * is called so we know whether to go to sync BRWs or wait for more
 	 * RPCs to complete */
@@ -3440,9 +3653,13 @@ int osc_setup(struct obd_device *obd, struct lustre_cfg *lcfg)
 	if (rc)
 		GOTO(out_ptlrpcd, rc);
 
+	rc = osc_lru_setup(cli);
+	if (rc)
+		GOTO(out_client_setup, rc);
+
 	handler = ptlrpcd_alloc_work(cli->cl_import, brw_queue_work, cli);
 	if (IS_ERR(handler))
-		GOTO(out_client_setup, rc = PTR_ERR(handler));
+		GOTO(out_lru, rc = PTR_ERR(handler));
 	cli->cl_writeback_work = handler;
 
 	rc = osc_quota_setup(obd);
@@ -3473,6 +3690,8 @@ int osc_setup(struct obd_device *obd, struct lustre_cfg *lcfg)
 
 out_ptlrpcd_work:
 	ptlrpcd_destroy_work(handler);
+out_lru:
+	osc_lru_cleanup(cli);
 out_client_setup:
 	client_obd_cleanup(obd);
 out_ptlrpcd:
@@ -3542,6 +3761,7 @@ int osc_cleanup(struct obd_device *obd)
 		cfs_atomic_dec(&cli->cl_cache->ccc_users);
 		cli->cl_cache = NULL;
 	}
+	osc_lru_cleanup(cli);
 
         /* free memory of osc quota cache */
         osc_quota_cleanup(obd);
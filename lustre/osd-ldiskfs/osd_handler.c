@@ -1027,6 +1027,7 @@ static void osd_conf_get(const struct lu_env *env,
 	param->ddp_inodespace     = PER_OBJ_USAGE;
 	/* per-fragment overhead to be used by the client code */
 	param->ddp_grant_frag     = 6 * LDISKFS_BLOCK_SIZE(sb);
+	param->ddp_incompat       = 0;
         param->ddp_mntopts      = 0;
         if (test_opt(sb, XATTR_USER))
                 param->ddp_mntopts |= MNTOPT_USERXATTR;
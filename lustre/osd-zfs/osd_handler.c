@@ -334,6 +334,8 @@ static void osd_conf_get(const struct lu_env *env,
 			 const struct dt_device *dev,
 			 struct dt_device_param *param)
 {
+	struct osd_device *osd = osd_dt_dev(dev);
+
 	/*
 	 * XXX should be taken from not-yet-existing fs abstraction layer.
 	 */
@@ -360,6 +362,11 @@ static void osd_conf_get(const struct lu_env *env,
 	 * and we should use the same logic as in udmu_objset_statfs() to
 	 * estimate the real size consumed by an object */
 	param->ddp_inodespace = OSD_DNODE_EST_COUNT;
+
+	/* an older osd-zfs would look the OIs up by sequence only and
+	 * miss every object, see osd_oi_hash_init() */
+	param->ddp_incompat = osd->od_oi_hash == OSD_OI_HASH_FID ?
+			      OBD_INCOMPAT_OI_HASH : 0;
 	/* per-fragment overhead to be used by the client code */
 	param->ddp_grant_frag = udmu_blk_insert_cost();
 
@@ -577,6 +584,10 @@ static int osd_mount(const struct lu_env *env,
 	if (rc)
 		GOTO(err, rc);
 
+	rc = osd_destroy_thread_start(env, o);
+	if (rc)
+		GOTO(err, rc);
+
 	o->arc_prune_cb = arc_add_prune_callback(arc_prune_func, o);
 
 	/* initialize quota slave instance */
@@ -630,6 +641,10 @@ static int osd_device_init0(const struct lu_env *env,
 	if (o->od_capa_hash == NULL)
 		GOTO(out, rc = -ENOMEM);
 
+	spin_lock_init(&o->od_destroy_lock);
+	cfs_waitq_init(&o->od_destroy_thread.t_ctl_waitq);
+	o->od_sync_destroy_max = OSD_SYNC_DESTROY_MAX;
+
 out:
 	RETURN(rc);
 }
@@ -695,7 +710,7 @@ static struct lu_device *osd_device_fini(const struct lu_env *env,
 	int		   rc;
 	ENTRY;
 
-
+	osd_destroy_thread_stop(o);
 	osd_shutdown(env, o);
 	osd_oi_fini(env, o);
 
@@ -57,6 +57,11 @@
 #define LUSTRE_ROOT_FID_SEQ	0
 #define DMU_OSD_SVNAME		"svname"
 #define DMU_OSD_OI_NAME_BASE	"oi"
+#define DMU_OSD_UNLINKED_NAME	"lustre_unlinked"
+#define DMU_OSD_OI_HASH_NAME	"lustre_oi_hash"
+
+/* objects larger than this are freed by the osd_destroy thread */
+#define OSD_SYNC_DESTROY_MAX	(1ULL << 20)
 
 #define OSD_GFP_IO		(GFP_NOFS | __GFP_HIGHMEM)
 
@@ -187,6 +192,36 @@ struct osd_oi {
 	uint64_t		oi_zapid;
 };
 
+/*
+ * How a fid selects its OI, stored in the master node at format time.
+ * Filesystems without the record use OSD_OI_HASH_SEQ.
+ */
+enum osd_oi_hash {
+	/* by sequence: all fids of a client sequence share one OI */
+	OSD_OI_HASH_SEQ	= 0,
+	/* by sequence and object id: creates are spread over all OIs */
+	OSD_OI_HASH_FID	= 1,
+};
+
+#define OSD_OI_NEG_BITS		10
+#define OSD_OI_NEG_SIZE		(1 << OSD_OI_NEG_BITS)
+#define OSD_OI_NEG_LOCKS	32
+
+/*
+ * Cache of fids recently found missing from the OIs, so repeated lookups
+ * of absent objects don't walk the fat ZAPs.  Each slot holds one fid,
+ * a stripe's generation is bumped by every OI insert hashing to it so a
+ * lookup racing with a create never caches a stale miss.
+ */
+struct osd_oi_neg_cache {
+	struct {
+		spinlock_t	 lock;
+		__u64		 gen;
+	}			 onc_stripes[OSD_OI_NEG_LOCKS];
+	struct lu_fid		 onc_fids[OSD_OI_NEG_SIZE];
+	cfs_atomic_t		 onc_hits;
+};
+
 struct osd_seq {
 	uint64_t	 *os_compat_dirs;
 	int		 os_subdir_count; /* subdir count for each seq */
@@ -226,6 +261,8 @@ struct osd_device {
 	uint64_t		 od_root;
 	struct osd_oi		**od_oi_table;
 	unsigned int		 od_oi_count;
+	enum osd_oi_hash	 od_oi_hash;
+	struct osd_oi_neg_cache	*od_oi_neg;
 	uint64_t		od_ost_compat_grp0;
 	struct osd_seq_list	od_seq_list;
 
@@ -253,6 +290,16 @@ struct osd_device {
 	cfs_atomic_t		 od_zerocopy_pin;
 
 	arc_prune_t		*arc_prune_cb;
+
+	/* ZAP of destroyed objects whose data is still to be freed,
+	 * maps object id to its size at destroy */
+	uint64_t		 od_unlinkedid;
+	struct ptlrpc_thread	 od_destroy_thread;
+	/* protects the backlog counters below */
+	spinlock_t		 od_destroy_lock;
+	__u64			 od_destroy_objects;
+	__u64			 od_destroy_bytes;
+	__u64			 od_sync_destroy_max;
 };
 
 struct osd_object {
@@ -281,6 +328,9 @@ struct osd_object {
 
 	/* record size for index file */
 	int			 oo_recsize;
+
+	/* destroy declared as deferred, see osd_object_destroy_deferred() */
+	int			 oo_destroy_deferred;
 };
 
 int osd_statfs(const struct lu_env *, struct dt_device *, struct obd_statfs *);
@@ -388,6 +438,8 @@ int udmu_zap_cursor_retrieve_value(const struct lu_env *env,
 
 /* osd_object.c */
 void osd_object_sa_dirty_rele(struct osd_thandle *oh);
+int osd_destroy_thread_start(const struct lu_env *env, struct osd_device *osd);
+void osd_destroy_thread_stop(struct osd_device *osd);
 int __osd_obj2dbuf(const struct lu_env *env, objset_t *os,
 		   uint64_t oid, dmu_buf_t **dbp, void *tag);
 struct lu_object *osd_object_alloc(const struct lu_env *env,
@@ -410,6 +462,7 @@ int osd_fid_lookup(const struct lu_env *env,
 		   struct osd_device *, const struct lu_fid *, uint64_t *);
 uint64_t osd_get_name_n_idx(const struct lu_env *env, struct osd_device *osd,
 			    const struct lu_fid *fid, char *buf);
+void osd_oi_neg_forget(struct osd_device *osd, const struct lu_fid *fid);
 int osd_options_init(void);
 
 /* osd_index.c */
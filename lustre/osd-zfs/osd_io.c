@@ -337,6 +337,10 @@ static int osd_bufs_get_write(const struct lu_env *env, struct osd_object *obj,
 	ENTRY;
 
 	dmu_object_size_from_db(obj->oo_db, &bs, &dummy);
+	/* a single small block grows on write, dmu_assign_arcbuf() falls
+	 * back to copy then. don't cut the bulk into sub-page niobufs */
+	if (bs < CFS_PAGE_SIZE)
+		bs = CFS_PAGE_SIZE;
 
 	/*
 	 * currently only full blocks are subject to zerocopy approach:
@@ -348,13 +352,23 @@ static int osd_bufs_get_write(const struct lu_env *env, struct osd_object *obj,
 		off_in_block = off & (bs - 1);
 		sz_in_block = min_t(int, bs - off_in_block, len);
 
+		abuf = NULL;
 		if (sz_in_block == bs) {
 			/* full block, try to use zerocopy */
-
 			abuf = dmu_request_arcbuf(obj->oo_db, bs);
 			if (unlikely(abuf == NULL))
 				GOTO(out_err, -ENOMEM);
 
+			/* bulk pages must map the buffer 1:1, otherwise
+			 * the block would need more niobufs than pages */
+			if (unlikely((unsigned long)abuf->b_data &
+				     ~CFS_PAGE_MASK)) {
+				dmu_return_arcbuf(abuf);
+				abuf = NULL;
+			}
+		}
+
+		if (abuf != NULL) {
 			cfs_atomic_inc(&osd->od_zerocopy_loan);
 
 			/* go over pages arcbuf contains, put them as
@@ -583,8 +597,8 @@ static int osd_declare_write_commit(const struct lu_env *env,
 		 * operation is committed, if required. */
 		space += osd_count_not_mapped(obj, offset, size);
 
-		offset = lnb->lnb_file_offset;
-		size = lnb->len;
+		offset = lnb[i].lnb_file_offset;
+		size = lnb[i].len;
 	}
 
 	if (size) {
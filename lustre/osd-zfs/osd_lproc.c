@@ -167,6 +167,78 @@ static int lprocfs_osd_wr_iused_est(struct file *file, const char *buffer,
 	return count;
 }
 
+static int lprocfs_osd_rd_destroys_pending(char *page, char **start, off_t off,
+					   int count, int *eof, void *data)
+{
+	struct osd_device *osd = osd_dt_dev((struct dt_device *)data);
+	__u64		   objects, bytes;
+
+	LASSERT(osd != NULL);
+	*eof = 1;
+
+	spin_lock(&osd->od_destroy_lock);
+	objects = osd->od_destroy_objects;
+	bytes = osd->od_destroy_bytes;
+	spin_unlock(&osd->od_destroy_lock);
+
+	return snprintf(page, count, "objects: "LPU64"\nbytes: "LPU64"\n",
+			objects, bytes);
+}
+
+static int lprocfs_osd_rd_oi_hash(char *page, char **start, off_t off,
+				  int count, int *eof, void *data)
+{
+	struct osd_device *osd = osd_dt_dev((struct dt_device *)data);
+
+	LASSERT(osd != NULL);
+	*eof = 1;
+
+	return snprintf(page, count, "%s\n",
+			osd->od_oi_hash == OSD_OI_HASH_FID ? "fid" : "seq");
+}
+
+static int lprocfs_osd_rd_oi_neg_hits(char *page, char **start, off_t off,
+				      int count, int *eof, void *data)
+{
+	struct osd_device *osd = osd_dt_dev((struct dt_device *)data);
+
+	LASSERT(osd != NULL);
+	*eof = 1;
+
+	return snprintf(page, count, "%d\n", osd->od_oi_neg == NULL ? 0 :
+			cfs_atomic_read(&osd->od_oi_neg->onc_hits));
+}
+
+static int lprocfs_osd_rd_sync_destroy_max(char *page, char **start, off_t off,
+					   int count, int *eof, void *data)
+{
+	struct osd_device *osd = osd_dt_dev((struct dt_device *)data);
+
+	LASSERT(osd != NULL);
+	*eof = 1;
+
+	return snprintf(page, count, LPU64"\n", osd->od_sync_destroy_max);
+}
+
+static int lprocfs_osd_wr_sync_destroy_max(struct file *file,
+					   const char *buffer,
+					   unsigned long count, void *data)
+{
+	struct osd_device *osd = osd_dt_dev((struct dt_device *)data);
+	__u64		   val;
+	int		   rc;
+
+	LASSERT(osd != NULL);
+
+	rc = lprocfs_write_u64_helper(buffer, count, &val);
+	if (rc)
+		return rc;
+
+	osd->od_sync_destroy_max = val;
+
+	return count;
+}
+
 struct lprocfs_vars lprocfs_osd_obd_vars[] = {
 	{ "blocksize",       lprocfs_osd_rd_blksize,     0, 0 },
 	{ "kbytestotal",     lprocfs_osd_rd_kbytestotal, 0, 0 },
@@ -179,6 +251,11 @@ struct lprocfs_vars lprocfs_osd_obd_vars[] = {
 	{ "force_sync",      0, lprocfs_osd_wr_force_sync     },
 	{ "quota_iused_estimate",  lprocfs_osd_rd_iused_est,
 		lprocfs_osd_wr_iused_est,   0, 0 },
+	{ "destroys_pending", lprocfs_osd_rd_destroys_pending, 0, 0 },
+	{ "sync_destroy_max_size", lprocfs_osd_rd_sync_destroy_max,
+		lprocfs_osd_wr_sync_destroy_max, 0, 0 },
+	{ "oi_hash",         lprocfs_osd_rd_oi_hash,     0, 0 },
+	{ "oi_neg_hits",     lprocfs_osd_rd_oi_neg_hits, 0, 0 },
 	{ 0 }
 };
 
@@ -403,6 +403,20 @@ static void osd_object_free(const struct lu_env *env, struct lu_object *l)
 	OBD_SLAB_FREE_PTR(obj, osd_object_kmem);
 }
 
+/*
+ * Freeing the data of a large object can take many txgs worth of work,
+ * which would block the service thread and make every other writer wait
+ * for the txg sync.  Such objects are only moved to the od_unlinkedid ZAP
+ * by the destroy transaction, and their data is freed in bounded chunks
+ * by the osd_destroy thread later.
+ */
+static inline int osd_object_destroy_deferred(struct osd_device *osd,
+					      struct osd_object *obj)
+{
+	return osd->od_unlinkedid != 0 && S_ISREG(obj->oo_attr.la_mode) &&
+	       obj->oo_attr.la_size > osd->od_sync_destroy_max;
+}
+
 static void __osd_declare_object_destroy(const struct lu_env *env,
 					 struct osd_object *obj,
 					 struct osd_thandle *oh)
@@ -416,7 +430,15 @@ static void __osd_declare_object_destroy(const struct lu_env *env,
 	zap_cursor_t		*zc;
 	int			 rc = 0;
 
-	dmu_tx_hold_free(tx, oid, 0, DMU_OBJECT_END);
+	/* decided once, sync_destroy_max_size may change before the
+	 * destroy itself */
+	obj->oo_destroy_deferred = osd_object_destroy_deferred(osd, obj);
+	if (obj->oo_destroy_deferred) {
+		dmu_tx_hold_bonus(tx, oid);
+		dmu_tx_hold_zap(tx, osd->od_unlinkedid, TRUE, NULL);
+	} else {
+		dmu_tx_hold_free(tx, oid, 0, DMU_OBJECT_END);
+	}
 
 	/* zap holding xattrs */
 	if (obj->oo_xattr != ZFS_NO_OBJECT) {
@@ -562,6 +584,20 @@ static int __osd_object_destroy(const struct lu_env *env,
 			       osd->od_svname, rc);
 	}
 
+	if (obj->oo_destroy_deferred) {
+		rc = -zap_add_int_key(uos->os, osd->od_unlinkedid,
+				      obj->oo_db->db_object,
+				      obj->oo_attr.la_size, tx);
+		if (rc == 0) {
+			spin_lock(&osd->od_destroy_lock);
+			osd->od_destroy_objects++;
+			osd->od_destroy_bytes += obj->oo_attr.la_size;
+			spin_unlock(&osd->od_destroy_lock);
+			cfs_waitq_signal(&osd->od_destroy_thread.t_ctl_waitq);
+		}
+		return rc;
+	}
+
 	return __osd_object_free(uos, obj->oo_db->db_object, tx);
 }
 
@@ -627,6 +663,250 @@ out:
 	RETURN (0);
 }
 
+#define OSD_DESTROY_CHUNK	(32ULL << 20)	/* bytes freed per tx */
+#define OSD_DESTROY_TXG_MAX	(256ULL << 20)	/* bytes freed per txg */
+#define OSD_DESTROY_RETRY_MIN	1		/* seconds after an error */
+#define OSD_DESTROY_RETRY_MAX	300
+
+/*
+ * Free the data of unlinked object \a oid from its end, one chunk per
+ * transaction and at most OSD_DESTROY_TXG_MAX bytes per txg, then free the
+ * dnode and drop it from the unlinked ZAP.  Returns -EINTR if the thread
+ * is being stopped, the object is resumed on the next mount.
+ */
+static int osd_unlinked_free(const struct lu_env *env, struct osd_device *osd,
+			     uint64_t oid, uint64_t size,
+			     uint64_t *txg, uint64_t *txg_bytes)
+{
+	udmu_objset_t		*uos = &osd->od_objset;
+	dmu_object_info_t	*doi = &osd_oti_get(env)->oti_doi;
+	struct ptlrpc_thread	*thread = &osd->od_destroy_thread;
+	uint64_t		 off = 0;
+	uint64_t		 len;
+	dmu_tx_t		*tx;
+	int			 exists;
+	int			 rc;
+
+	rc = -dmu_object_info(uos->os, oid, doi);
+	if (rc != 0 && rc != -ENOENT)
+		return rc;
+	exists = (rc == 0);
+	if (exists)
+		off = doi->doi_max_offset;
+
+	while (off > 0) {
+		if (unlikely(!thread_is_running(thread)))
+			return -EINTR;
+
+		if (*txg_bytes >= OSD_DESTROY_TXG_MAX) {
+			txg_wait_open(dmu_objset_pool(uos->os), *txg + 1);
+			*txg_bytes = 0;
+		}
+
+		len = min_t(uint64_t, off, OSD_DESTROY_CHUNK);
+		tx = dmu_tx_create(uos->os);
+		dmu_tx_hold_free(tx, oid, off - len, len);
+		rc = -dmu_tx_assign(tx, TXG_WAIT);
+		if (rc) {
+			dmu_tx_abort(tx);
+			return rc;
+		}
+		if (tx->tx_txg != *txg) {
+			*txg = tx->tx_txg;
+			*txg_bytes = 0;
+		}
+		rc = -dmu_free_range(uos->os, oid, off - len, len, tx);
+		dmu_tx_commit(tx);
+		if (rc)
+			return rc;
+
+		*txg_bytes += len;
+		off -= len;
+	}
+
+	tx = dmu_tx_create(uos->os);
+	if (exists)
+		dmu_tx_hold_free(tx, oid, 0, DMU_OBJECT_END);
+	dmu_tx_hold_zap(tx, osd->od_unlinkedid, FALSE, NULL);
+	rc = -dmu_tx_assign(tx, TXG_WAIT);
+	if (rc) {
+		dmu_tx_abort(tx);
+		return rc;
+	}
+	if (exists)
+		rc = __osd_object_free(uos, oid, tx);
+	if (rc == 0)
+		rc = -zap_remove_int(uos->os, osd->od_unlinkedid, oid, tx);
+	dmu_tx_commit(tx);
+
+	if (rc == 0) {
+		spin_lock(&osd->od_destroy_lock);
+		if (osd->od_destroy_objects > 0)
+			osd->od_destroy_objects--;
+		osd->od_destroy_bytes -= min_t(__u64, size, osd->od_destroy_bytes);
+		spin_unlock(&osd->od_destroy_lock);
+	}
+
+	return rc;
+}
+
+/* sum up the backlog left in the unlinked ZAP by the previous mount */
+static int osd_unlinked_count(const struct lu_env *env,
+			      struct osd_device *osd)
+{
+	zap_attribute_t	*za = &osd_oti_get(env)->oti_za;
+	zap_cursor_t	*zc;
+	int		 rc;
+
+	rc = -udmu_zap_cursor_init(&zc, &osd->od_objset, osd->od_unlinkedid, 0);
+	if (rc)
+		return rc;
+
+	while ((rc = -zap_cursor_retrieve(zc, za)) == 0) {
+		osd->od_destroy_objects++;
+		osd->od_destroy_bytes += za->za_first_integer;
+		zap_cursor_advance(zc);
+	}
+	udmu_zap_cursor_fini(zc);
+
+	return rc == -ENOENT ? 0 : rc;
+}
+
+static int osd_destroy_main(void *args)
+{
+	struct osd_device	*osd = args;
+	struct ptlrpc_thread	*thread = &osd->od_destroy_thread;
+	struct l_wait_info	 lwi = { 0 };
+	struct l_wait_info	 lwi_retry;
+	struct lu_env		 env;
+	zap_attribute_t		*za;
+	zap_cursor_t		*zc;
+	uint64_t		 txg = 0;
+	uint64_t		 txg_bytes = 0;
+	uint64_t		 oid;
+	int			 retry = OSD_DESTROY_RETRY_MIN;
+	int			 rc;
+	ENTRY;
+
+	cfs_daemonize("osd_destroy");
+	rc = lu_env_init(&env, LCT_DT_THREAD);
+	if (rc != 0) {
+		CERROR("%s: cannot init env for destroy thread: rc = %d\n",
+		       osd->od_svname, rc);
+		GOTO(noenv, rc);
+	}
+	za = &osd_oti_get(&env)->oti_za;
+
+	spin_lock(&osd->od_destroy_lock);
+	thread_set_flags(thread, SVC_RUNNING);
+	spin_unlock(&osd->od_destroy_lock);
+	cfs_waitq_broadcast(&thread->t_ctl_waitq);
+
+	while (1) {
+		l_wait_event(thread->t_ctl_waitq,
+			     !thread_is_running(thread) ||
+			     osd->od_destroy_objects > 0, &lwi);
+		if (!thread_is_running(thread))
+			break;
+
+		/* freed entries are removed, so the first one is next */
+		oid = 0;
+		rc = -udmu_zap_cursor_init(&zc, &osd->od_objset,
+					   osd->od_unlinkedid, 0);
+		if (rc == 0) {
+			rc = -zap_cursor_retrieve(zc, za);
+			udmu_zap_cursor_fini(zc);
+		}
+		if (rc == -ENOENT) {
+			/* entries are added before the counters are bumped,
+			 * so the backlog is really empty */
+			spin_lock(&osd->od_destroy_lock);
+			osd->od_destroy_objects = 0;
+			osd->od_destroy_bytes = 0;
+			spin_unlock(&osd->od_destroy_lock);
+			continue;
+		}
+
+		if (rc == 0) {
+			oid = simple_strtoull(za->za_name, NULL, 16);
+			rc = osd_unlinked_free(&env, osd, oid,
+					       za->za_first_integer,
+					       &txg, &txg_bytes);
+			if (rc == -EINTR)
+				break;
+		}
+		if (rc == 0) {
+			retry = OSD_DESTROY_RETRY_MIN;
+			continue;
+		}
+
+		/* the entry stays in the unlinked ZAP, try again later
+		 * rather than leak its space until the next mount */
+		CERROR("%s: cannot free unlinked object "LPU64", retry in %d "
+		       "seconds: rc = %d\n", osd->od_svname, oid, retry, rc);
+		lwi_retry = LWI_TIMEOUT(cfs_time_seconds(retry), NULL, NULL);
+		l_wait_event(thread->t_ctl_waitq, !thread_is_running(thread),
+			     &lwi_retry);
+		retry = min(retry * 2, OSD_DESTROY_RETRY_MAX);
+	}
+
+	lu_env_fini(&env);
+
+noenv:
+	spin_lock(&osd->od_destroy_lock);
+	thread_set_flags(thread, SVC_STOPPED);
+	cfs_waitq_broadcast(&thread->t_ctl_waitq);
+	spin_unlock(&osd->od_destroy_lock);
+	RETURN(rc);
+}
+
+int osd_destroy_thread_start(const struct lu_env *env, struct osd_device *osd)
+{
+	struct ptlrpc_thread	*thread = &osd->od_destroy_thread;
+	struct l_wait_info	 lwi = { 0 };
+	int			 rc;
+	ENTRY;
+
+	thread_set_flags(thread, 0);
+	rc = osd_unlinked_count(env, osd);
+	if (rc) {
+		CERROR("%s: cannot read unlinked objects: rc = %d\n",
+		       osd->od_svname, rc);
+		RETURN(rc);
+	}
+
+	rc = cfs_create_thread(osd_destroy_main, osd, 0);
+	if (rc < 0) {
+		CERROR("%s: cannot start destroy thread: rc = %d\n",
+		       osd->od_svname, rc);
+		RETURN(rc);
+	}
+
+	l_wait_event(thread->t_ctl_waitq,
+		     thread_is_running(thread) || thread_is_stopped(thread),
+		     &lwi);
+
+	RETURN(0);
+}
+
+void osd_destroy_thread_stop(struct osd_device *osd)
+{
+	struct ptlrpc_thread	*thread = &osd->od_destroy_thread;
+	struct l_wait_info	 lwi = { 0 };
+
+	spin_lock(&osd->od_destroy_lock);
+	if (!thread_is_init(thread) && !thread_is_stopped(thread)) {
+		thread_set_flags(thread, SVC_STOPPING);
+		spin_unlock(&osd->od_destroy_lock);
+		cfs_waitq_broadcast(&thread->t_ctl_waitq);
+		l_wait_event(thread->t_ctl_waitq,
+			     thread_is_stopped(thread),
+			     &lwi);
+		spin_lock(&osd->od_destroy_lock);
+	}
+	spin_unlock(&osd->od_destroy_lock);
+}
+
 static void osd_object_delete(const struct lu_env *env, struct lu_object *l)
 {
 	struct osd_object *obj = osd_obj(l);
@@ -1446,6 +1726,7 @@ static int osd_object_create(const struct lu_env *env, struct dt_object *dt,
 	zapid = osd_get_name_n_idx(env, osd, fid, buf);
 
 	rc = -zap_add(osd->od_objset.os, zapid, buf, 8, 1, zde, oh->ot_tx);
+	osd_oi_neg_forget(osd, fid);
 	if (rc)
 		GOTO(out, rc);
 
@@ -412,18 +412,21 @@ static void osd_fid2str(char *buf, const struct lu_fid *fid)
 
 /*
  * Determine the zap object id which is being used as the OI for the
- * given fid.  The lowest N bits in the sequence ID are used as the
- * index key.  On failure 0 is returned which zfs treats internally
- * as an invalid object id.
+ * given fid.  The lowest N bits in the sequence ID, mixed with the object
+ * ID for OSD_OI_HASH_FID, are used as the index key.  On failure 0 is
+ * returned which zfs treats internally as an invalid object id.
  */
 static uint64_t
 osd_get_idx_for_fid(struct osd_device *osd, const struct lu_fid *fid,
 		    char *buf)
 {
 	struct osd_oi *oi;
+	__u64	       key = fid_seq(fid);
 
 	LASSERT(osd->od_oi_table != NULL);
-	oi = osd->od_oi_table[fid_seq(fid) & (osd->od_oi_count - 1)];
+	if (osd->od_oi_hash == OSD_OI_HASH_FID)
+		key ^= fid_oid(fid);
+	oi = osd->od_oi_table[key & (osd->od_oi_count - 1)];
 	osd_fid2str(buf, fid);
 
 	return oi->oi_zapid;
@@ -467,12 +470,75 @@ static inline int fid_is_fs_root(const struct lu_fid *fid)
 		fid_oid(fid) == OSD_FS_ROOT_OID;
 }
 
+static inline int osd_oi_neg_cacheable(const struct lu_fid *fid)
+{
+	return fid_is_norm(fid) || fid_is_idif(fid);
+}
+
+/* returns true if \a fid is known to be missing, the stripe generation
+ * to pass to osd_oi_neg_add() otherwise */
+static int osd_oi_neg_lookup(struct osd_device *osd, const struct lu_fid *fid,
+			     __u64 *gen)
+{
+	struct osd_oi_neg_cache	*onc = osd->od_oi_neg;
+	int			 idx = fid_hash(fid, OSD_OI_NEG_BITS);
+	int			 s = idx & (OSD_OI_NEG_LOCKS - 1);
+	int			 found;
+
+	spin_lock(&onc->onc_stripes[s].lock);
+	found = lu_fid_eq(&onc->onc_fids[idx], fid);
+	*gen = onc->onc_stripes[s].gen;
+	spin_unlock(&onc->onc_stripes[s].lock);
+
+	if (found)
+		cfs_atomic_inc(&onc->onc_hits);
+	return found;
+}
+
+static void osd_oi_neg_add(struct osd_device *osd, const struct lu_fid *fid,
+			   __u64 gen)
+{
+	struct osd_oi_neg_cache	*onc = osd->od_oi_neg;
+	int			 idx = fid_hash(fid, OSD_OI_NEG_BITS);
+	int			 s = idx & (OSD_OI_NEG_LOCKS - 1);
+
+	spin_lock(&onc->onc_stripes[s].lock);
+	/* an insert raced with the lookup, the miss may be stale */
+	if (onc->onc_stripes[s].gen == gen)
+		onc->onc_fids[idx] = *fid;
+	spin_unlock(&onc->onc_stripes[s].lock);
+}
+
+/**
+ * Drop \a fid from the negative cache, called once it is inserted to
+ * the OI so that lookups started before the insert can't cache a miss.
+ */
+void osd_oi_neg_forget(struct osd_device *osd, const struct lu_fid *fid)
+{
+	struct osd_oi_neg_cache	*onc = osd->od_oi_neg;
+	int			 idx;
+	int			 s;
+
+	if (onc == NULL || !osd_oi_neg_cacheable(fid))
+		return;
+
+	idx = fid_hash(fid, OSD_OI_NEG_BITS);
+	s = idx & (OSD_OI_NEG_LOCKS - 1);
+	spin_lock(&onc->onc_stripes[s].lock);
+	if (lu_fid_eq(&onc->onc_fids[idx], fid))
+		fid_zero(&onc->onc_fids[idx]);
+	onc->onc_stripes[s].gen++;
+	spin_unlock(&onc->onc_stripes[s].lock);
+}
+
 int osd_fid_lookup(const struct lu_env *env, struct osd_device *dev,
 		   const struct lu_fid *fid, uint64_t *oid)
 {
 	struct osd_thread_info	*info = osd_oti_get(env);
 	char			*buf = info->oti_buf;
 	uint64_t		zapid;
+	__u64			gen = 0;
+	int			neg;
 	int			rc = 0;
 	ENTRY;
 
@@ -487,10 +553,16 @@ int osd_fid_lookup(const struct lu_env *env, struct osd_device *dev,
 	} else if (unlikely(fid_is_fs_root(fid))) {
 		*oid = dev->od_root;
 	} else {
+		neg = dev->od_oi_neg != NULL && osd_oi_neg_cacheable(fid);
+		if (neg && osd_oi_neg_lookup(dev, fid, &gen))
+			RETURN(-ENOENT);
+
 		zapid = osd_get_name_n_idx(env, dev, fid, buf);
 
 		rc = -zap_lookup(dev->od_objset.os, zapid, buf,
 				8, 1, &info->oti_zde);
+		if (rc == -ENOENT && neg)
+			osd_oi_neg_add(dev, fid, gen);
 		if (rc)
 			RETURN(rc);
 		*oid = info->oti_zde.lzd_reg.zde_dnode;
@@ -681,9 +753,66 @@ osd_oi_init_compat(const struct lu_env *env, struct osd_device *o)
 		RETURN(rc);
 	o->od_igrp_oid = odb;
 
+	/* objects destroyed but not freed yet, see osd_destroy_main() */
+	rc = osd_oi_find_or_create(env, o, MASTER_NODE_OBJ,
+				   DMU_OSD_UNLINKED_NAME, &odb);
+	if (rc)
+		RETURN(rc);
+	o->od_unlinkedid = odb;
+
 	RETURN(rc);
 }
 
+/**
+ * Read how fids are mapped to the OIs, a new filesystem (\a create) gets
+ * the record written before any OI is created.
+ */
+static int
+osd_oi_hash_init(const struct lu_env *env, struct osd_device *o, int create)
+{
+	uint64_t	 hash;
+	dmu_tx_t	*tx;
+	int		 rc;
+
+	rc = -zap_lookup(o->od_objset.os, MASTER_NODE_OBJ,
+			 DMU_OSD_OI_HASH_NAME, 8, 1, &hash);
+	if (rc == 0) {
+		if (hash != OSD_OI_HASH_SEQ && hash != OSD_OI_HASH_FID) {
+			CERROR("%s: unknown OI hash "LPU64"\n",
+			       o->od_svname, hash);
+			return -EINVAL;
+		}
+		o->od_oi_hash = hash;
+		return 0;
+	}
+	if (rc != -ENOENT)
+		return rc;
+
+	o->od_oi_hash = OSD_OI_HASH_SEQ;
+	if (!create)
+		return 0;
+
+	tx = dmu_tx_create(o->od_objset.os);
+	if (tx == NULL)
+		return -ENOMEM;
+
+	dmu_tx_hold_zap(tx, MASTER_NODE_OBJ, TRUE, DMU_OSD_OI_HASH_NAME);
+	rc = -dmu_tx_assign(tx, TXG_WAIT);
+	if (rc) {
+		dmu_tx_abort(tx);
+		return rc;
+	}
+
+	hash = OSD_OI_HASH_FID;
+	rc = -zap_add(o->od_objset.os, MASTER_NODE_OBJ, DMU_OSD_OI_HASH_NAME,
+		      8, 1, &hash, tx);
+	dmu_tx_commit(tx);
+	if (rc == 0)
+		o->od_oi_hash = hash;
+
+	return rc;
+}
+
 /**
  * Initialize the OIs by either opening or creating them as needed.
  */
@@ -697,6 +826,10 @@ int osd_oi_init(const struct lu_env *env, struct osd_device *o)
 	if (rc)
 		RETURN(rc);
 
+	rc = osd_oi_hash_init(env, o, count == 0);
+	if (rc)
+		RETURN(rc);
+
 	if (count == 0) {
 		uint64_t odb, sdb;
 
@@ -725,6 +858,15 @@ int osd_oi_init(const struct lu_env *env, struct osd_device *o)
 	if (rc) {
 		OBD_FREE(o->od_oi_table, sizeof(struct osd_oi *) * count);
 		o->od_oi_table = NULL;
+		RETURN(rc);
+	}
+
+	/* the negative cache is only an optimization */
+	OBD_ALLOC_LARGE(o->od_oi_neg, sizeof(*o->od_oi_neg));
+	if (o->od_oi_neg != NULL) {
+		for (i = 0; i < OSD_OI_NEG_LOCKS; i++)
+			spin_lock_init(&o->od_oi_neg->onc_stripes[i].lock);
+		cfs_atomic_set(&o->od_oi_neg->onc_hits, 0);
 	}
 
 	RETURN(rc);
@@ -736,6 +878,11 @@ void osd_oi_fini(const struct lu_env *env, struct osd_device *o)
 
 	osd_ost_seq_fini(env, o);
 
+	if (o->od_oi_neg != NULL) {
+		OBD_FREE_LARGE(o->od_oi_neg, sizeof(*o->od_oi_neg));
+		o->od_oi_neg = NULL;
+	}
+
 	if (o->od_oi_table != NULL) {
 		(void) osd_oi_close_table(env, o);
 		OBD_FREE(o->od_oi_table,
@@ -703,6 +703,43 @@ static void ost_tls_put(struct ptlrpc_request *r)
         }
 }
 
+/* Move the data of a short I/O (OBD_FL_SHORT_IO) between the pages of
+ * @desc and the RMF_SHORT_IO buffer of @req, in place of a bulk transfer */
+static int ost_short_io_copy(struct ptlrpc_request *req,
+			     struct ptlrpc_bulk_desc *desc, int opc)
+{
+	enum req_location loc = opc == OST_WRITE ? RCL_CLIENT : RCL_SERVER;
+	char *buf;
+	char *ptr;
+	int i;
+
+	if (req_capsule_get_size(&req->rq_pill, &RMF_SHORT_IO, loc) <
+	    desc->bd_nob)
+		return -EPROTO;
+
+	if (opc == OST_WRITE)
+		buf = req_capsule_client_get(&req->rq_pill, &RMF_SHORT_IO);
+	else
+		buf = req_capsule_server_get(&req->rq_pill, &RMF_SHORT_IO);
+	if (buf == NULL && desc->bd_nob > 0)
+		return -EPROTO;
+
+	for (i = 0; i < desc->bd_iov_count; i++) {
+		ptr = kmap(desc->bd_iov[i].kiov_page) +
+		      (desc->bd_iov[i].kiov_offset & ~CFS_PAGE_MASK);
+		if (opc == OST_WRITE)
+			memcpy(ptr, buf, desc->bd_iov[i].kiov_len);
+		else
+			memcpy(buf, ptr, desc->bd_iov[i].kiov_len);
+		kunmap(desc->bd_iov[i].kiov_page);
+		buf += desc->bd_iov[i].kiov_len;
+	}
+
+	desc->bd_nob_transferred = desc->bd_nob;
+	desc->bd_sender = req->rq_peer.nid;
+	return 0;
+}
+
 static int ost_brw_read(struct ptlrpc_request *req, struct obd_trans_info *oti)
 {
         struct ptlrpc_bulk_desc *desc = NULL;
@@ -716,6 +753,7 @@ static int ost_brw_read(struct ptlrpc_request *req, struct obd_trans_info *oti)
         struct lustre_handle lockh = { 0 };
         int niocount, npages, nob = 0, rc, i;
         int no_reply = 0;
+	int short_io_size = 0;
         struct ost_thread_local_cache *tls;
         ENTRY;
 
@@ -769,6 +807,20 @@ static int ost_brw_read(struct ptlrpc_request *req, struct obd_trans_info *oti)
                 }
         }
 
+	if ((body->oa.o_valid & OBD_MD_FLFLAGS) &&
+	    (body->oa.o_flags & OBD_FL_SHORT_IO)) {
+		/* the data goes back in the reply, make room for it */
+		for (i = 0; i < niocount; i++) {
+			if (remote_nb[i].len >
+			    OBD_MAX_SHORT_IO_BYTES - short_io_size)
+				GOTO(out, rc = -EPROTO);
+			short_io_size += remote_nb[i].len;
+		}
+	}
+	/* empty unless this is a short read */
+	req_capsule_set_size(&req->rq_pill, &RMF_SHORT_IO, RCL_SERVER,
+			     short_io_size);
+
         rc = req_capsule_server_pack(&req->rq_pill);
         if (rc)
                 GOTO(out, rc);
@@ -853,7 +905,12 @@ static int ost_brw_read(struct ptlrpc_request *req, struct obd_trans_info *oti)
 
         /* Check if client was evicted while we were doing i/o before touching
            network */
-        if (rc == 0) {
+	if (rc == 0 && short_io_size != 0) {
+		rc = ost_short_io_copy(req, desc, OST_READ);
+		if (rc == 0)
+			req_capsule_shrink(&req->rq_pill, &RMF_SHORT_IO, nob,
+					   RCL_SERVER);
+	} else if (rc == 0) {
                 if (likely(!CFS_FAIL_PRECHECK(OBD_FAIL_PTLRPC_CLIENT_BULK_CB2)))
                         rc = target_bulk_io(exp, desc, &lwi);
                 no_reply = rc != 0;
@@ -977,7 +1034,7 @@ static int ost_brw_write(struct ptlrpc_request *req, struct obd_trans_info *oti)
         int rc, i, j;
         obd_count                client_cksum = 0, server_cksum = 0;
         cksum_type_t             cksum_type = OBD_CKSUM_CRC32;
-        int                      no_reply = 0, mmap = 0;
+        int                      no_reply = 0, mmap = 0, short_io = 0;
         __u32                    o_uid = 0, o_gid = 0;
         struct ost_thread_local_cache *tls;
         ENTRY;
@@ -1073,6 +1130,9 @@ static int ost_brw_write(struct ptlrpc_request *req, struct obd_trans_info *oti)
         }
         if (body->oa.o_valid & OBD_MD_FLFLAGS && body->oa.o_flags & OBD_FL_MMAP)
                 mmap = 1;
+	if (body->oa.o_valid & OBD_MD_FLFLAGS &&
+	    body->oa.o_flags & OBD_FL_SHORT_IO)
+		short_io = 1;
 
         /* Because we already sync grant info with client when reconnect,
          * grant info will be cleared for resent req, then fed_grant and
@@ -1109,12 +1169,17 @@ static int ost_brw_write(struct ptlrpc_request *req, struct obd_trans_info *oti)
 					    local_nb[i].lnb_page_offset,
 					    local_nb[i].len);
 
-        rc = sptlrpc_svc_prep_bulk(req, desc);
-        if (rc != 0)
-                GOTO(out_lock, rc);
+	if (short_io) {
+		/* the data came in the request itself */
+		rc = ost_short_io_copy(req, desc, OST_WRITE);
+	} else {
+		rc = sptlrpc_svc_prep_bulk(req, desc);
+		if (rc != 0)
+			GOTO(out_lock, rc);
 
-        rc = target_bulk_io(exp, desc, &lwi);
-        no_reply = rc != 0;
+		rc = target_bulk_io(exp, desc, &lwi);
+		no_reply = rc != 0;
+	}
 
 skip_transfer:
         if (client_cksum != 0 && rc == 0) {
@@ -2601,10 +2666,10 @@ static int ost_setup(struct obd_device *obd, struct lustre_cfg* lcfg)
 		.psc_name		= "ost_io",
 		.psc_watchdog_factor	= OSS_SERVICE_WATCHDOG_FACTOR,
 		.psc_buf		= {
-			.bc_nbufs		= OST_NBUFS,
-			.bc_buf_size		= OST_BUFSIZE,
-			.bc_req_max_size	= OST_MAXREQSIZE,
-			.bc_rep_max_size	= OST_MAXREPSIZE,
+			.bc_nbufs		= OST_IO_NBUFS,
+			.bc_buf_size		= OST_IO_BUFSIZE,
+			.bc_req_max_size	= OST_IO_MAXREQSIZE,
+			.bc_rep_max_size	= OST_IO_MAXREPSIZE,
 			.bc_req_portal		= OST_IO_PORTAL,
 			.bc_rep_portal		= OSC_REPLY_PORTAL,
 		},
@@ -375,6 +375,9 @@ void request_in_callback(lnet_event_t *ev)
 
 	cfs_list_add_tail(&req->rq_list, &svcpt->scp_req_incoming);
 	svcpt->scp_nreqs_incoming++;
+	/* feed the request buffer pool sizing */
+	svcpt->scp_rqbd_arrivals++;
+	svcpt->scp_rqbd_bytes += ev->mlength;
 
 	/* NB everything can disappear under us once the request
 	 * has been queued and we unlock, so do the wake now... */
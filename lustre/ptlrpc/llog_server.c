@@ -170,6 +170,8 @@ int llog_origin_handle_next_block(struct ptlrpc_request *req)
         struct llog_ctxt    *ctxt;
         __u32                flags;
         void                *ptr;
+	int                  cached;
+	int                  gen = 0;
 	int                  rc;
 
         ENTRY;
@@ -182,6 +184,32 @@ int llog_origin_handle_next_block(struct ptlrpc_request *req)
 	if (ctxt == NULL)
 		RETURN(-ENODEV);
 
+	/* the cache may be set up meanwhile, but is only freed with the
+	 * context, which our reference keeps */
+	cached = ctxt->loc_chunk_cache != NULL;
+	if (cached) {
+		req_capsule_set_size(&req->rq_pill, &RMF_EADATA, RCL_SERVER,
+				     LLOG_CHUNK_SIZE);
+		rc = req_capsule_server_pack(&req->rq_pill);
+		if (rc) {
+			llog_ctxt_put(ctxt);
+			RETURN(-ENOMEM);
+		}
+
+		repbody = req_capsule_server_get(&req->rq_pill,
+						 &RMF_LLOGD_BODY);
+		*repbody = *body;
+		ptr = req_capsule_server_get(&req->rq_pill, &RMF_EADATA);
+		if (llog_chunk_cache_lookup(ctxt, &body->lgd_logid,
+					    &repbody->lgd_saved_index,
+					    repbody->lgd_index,
+					    &repbody->lgd_cur_offset, ptr,
+					    &gen)) {
+			llog_ctxt_put(ctxt);
+			RETURN(0);
+		}
+	}
+
 	disk_obd = ctxt->loc_exp->exp_obd;
 	push_ctxt(&saved, &disk_obd->obd_lvfs_ctxt, NULL);
 
@@ -196,21 +224,31 @@ int llog_origin_handle_next_block(struct ptlrpc_request *req)
         if (rc)
                 GOTO(out_close, rc);
 
-        req_capsule_set_size(&req->rq_pill, &RMF_EADATA, RCL_SERVER,
-                             LLOG_CHUNK_SIZE);
-        rc = req_capsule_server_pack(&req->rq_pill);
-        if (rc)
-                GOTO(out_close, rc = -ENOMEM);
+	if (!cached) {
+		req_capsule_set_size(&req->rq_pill, &RMF_EADATA, RCL_SERVER,
+				     LLOG_CHUNK_SIZE);
+		rc = req_capsule_server_pack(&req->rq_pill);
+		if (rc)
+			GOTO(out_close, rc = -ENOMEM);
 
-        repbody = req_capsule_server_get(&req->rq_pill, &RMF_LLOGD_BODY);
-        *repbody = *body;
+		repbody = req_capsule_server_get(&req->rq_pill,
+						 &RMF_LLOGD_BODY);
+		*repbody = *body;
+		ptr = req_capsule_server_get(&req->rq_pill, &RMF_EADATA);
+	}
 
-        ptr = req_capsule_server_get(&req->rq_pill, &RMF_EADATA);
 	rc = llog_next_block(req->rq_svc_thread->t_env, loghandle,
 			     &repbody->lgd_saved_index, repbody->lgd_index,
 			     &repbody->lgd_cur_offset, ptr, LLOG_CHUNK_SIZE);
 	if (rc)
 		GOTO(out_close, rc);
+
+	if (cached)
+		llog_chunk_cache_insert(ctxt, &body->lgd_logid,
+					body->lgd_cur_offset,
+					body->lgd_saved_index, body->lgd_index,
+					repbody->lgd_cur_offset,
+					repbody->lgd_saved_index, ptr, gen);
 	EXIT;
 out_close:
 	llog_origin_close(req->rq_svc_thread->t_env, loghandle);
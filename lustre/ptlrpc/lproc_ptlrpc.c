@@ -212,7 +212,8 @@ void ptlrpc_lprocfs_register(struct proc_dir_entry *root, char *dir,
         }
 
         lprocfs_counter_init(svc_stats, PTLRPC_REQWAIT_CNTR,
-                             svc_counter_config, "req_waittime", "usec");
+                             svc_counter_config | LPROCFS_CNTR_HISTOGRAM,
+                             "req_waittime", "usec");
         lprocfs_counter_init(svc_stats, PTLRPC_REQQDEPTH_CNTR,
                              svc_counter_config, "req_qdepth", "reqs");
         lprocfs_counter_init(svc_stats, PTLRPC_REQACTIVE_CNTR,
@@ -240,7 +241,9 @@ void ptlrpc_lprocfs_register(struct proc_dir_entry *root, char *dir,
         for (i = 0; i < LUSTRE_MAX_OPCODES; i++) {
                 __u32 opcode = ll_rpc_opcode_table[i].opcode;
                 lprocfs_counter_init(svc_stats,
-                                     EXTRA_MAX_OPCODES + i, svc_counter_config,
+                                     EXTRA_MAX_OPCODES + i,
+                                     svc_counter_config |
+                                     LPROCFS_CNTR_HISTOGRAM,
                                      ll_opcode2str(opcode), "usec");
         }
 
@@ -414,6 +417,124 @@ ptlrpc_lprocfs_wr_threads_max(struct file *file, const char *buffer,
 	return count;
 }
 
+static int
+ptlrpc_lprocfs_rd_threads_idle_timeout(char *page, char **start, off_t off,
+				       int count, int *eof, void *data)
+{
+	struct ptlrpc_service *svc = data;
+
+	return snprintf(page, count, "%d\n", svc->srv_nthrs_idle_timeout);
+}
+
+static int
+ptlrpc_lprocfs_wr_threads_idle_timeout(struct file *file, const char *buffer,
+				       unsigned long count, void *data)
+{
+	struct ptlrpc_service *svc = data;
+	struct ptlrpc_service_part *svcpt;
+	int	val;
+	int	i;
+	int	rc = lprocfs_write_helper(buffer, count, &val);
+
+	if (rc < 0)
+		return rc;
+
+	if (val < 0)
+		return -ERANGE;
+
+	spin_lock(&svc->srv_lock);
+	svc->srv_nthrs_idle_timeout = val;
+	spin_unlock(&svc->srv_lock);
+
+	/* idle threads wait again with the new timeout */
+	ptlrpc_service_for_each_part(svcpt, i, svc)
+		cfs_waitq_broadcast(&svcpt->scp_waitq);
+
+	return count;
+}
+
+#define pct(a, b) (b ? a * 100 / b : 0)
+
+static int
+ptlrpc_lprocfs_rd_req_wait_hist(char *page, char **start, off_t off,
+				int count, int *eof, void *data)
+{
+	struct ptlrpc_service		*svc = data;
+	struct ptlrpc_service_part	*svcpt;
+	unsigned long			 buckets[OBD_HIST_MAX] = { 0 };
+	unsigned long			 tot = 0;
+	unsigned long			 cum = 0;
+	long				 avg = 0;
+	int				 rc;
+	int				 i;
+	int				 j;
+
+	ptlrpc_service_for_each_part(svcpt, i, svc) {
+		for (j = 0; j < OBD_HIST_MAX; j++)
+			buckets[j] += svcpt->scp_wait_hist.oh_buckets[j];
+		avg += svcpt->scp_wait_avg;
+	}
+
+	for (j = 0; j < OBD_HIST_MAX; j++)
+		tot += buckets[j];
+
+	*eof = 1;
+	rc = snprintf(page, count, "average wait: %ld usecs\n"
+		      "queue wait (usec)   reqs  %% cum %%\n",
+		      avg / svc->srv_ncpts);
+
+	for (j = 0; j < OBD_HIST_MAX && rc < count; j++) {
+		if (buckets[j] == 0)
+			continue;
+		cum += buckets[j];
+		rc += snprintf(page + rc, count - rc,
+			       "%-17u: %10lu %3lu %3lu\n", 1U << j,
+			       buckets[j], pct(buckets[j], tot),
+			       pct(cum, tot));
+	}
+
+	return rc;
+}
+
+static int
+ptlrpc_lprocfs_wr_req_wait_hist(struct file *file, const char *buffer,
+				unsigned long count, void *data)
+{
+	struct ptlrpc_service		*svc = data;
+	struct ptlrpc_service_part	*svcpt;
+	int				 i;
+
+	ptlrpc_service_for_each_part(svcpt, i, svc)
+		lprocfs_oh_clear(&svcpt->scp_wait_hist);
+
+	return count;
+}
+
+static int
+ptlrpc_lprocfs_rd_req_buffers(char *page, char **start, off_t off,
+			      int count, int *eof, void *data)
+{
+	struct ptlrpc_service		*svc = data;
+	struct ptlrpc_service_part	*svcpt;
+	int				 rc = 0;
+	int				 i;
+
+	*eof = 1;
+	ptlrpc_service_for_each_part(svcpt, i, svc) {
+		if (rc >= count)
+			break;
+		rc += snprintf(page + rc, count - rc,
+			       "cpt %d: total %d posted %d target %d "
+			       "rate %d reqs/sec size %d\n",
+			       svcpt->scp_cpt, svcpt->scp_nrqbds_total,
+			       svcpt->scp_nrqbds_posted,
+			       svcpt->scp_rqbd_target, svcpt->scp_rqbd_rate,
+			       svcpt->scp_rqbd_msgsize);
+	}
+
+	return rc;
+}
+
 /**
  * \addtogoup nrs
  * @{
@@ -1122,6 +1243,17 @@ void ptlrpc_lprocfs_register_service(struct proc_dir_entry *entry,
                 {.name       = "threads_started",
                  .read_fptr  = ptlrpc_lprocfs_rd_threads_started,
                  .data       = svc},
+		{.name	     = "threads_idle_timeout",
+		 .read_fptr  = ptlrpc_lprocfs_rd_threads_idle_timeout,
+		 .write_fptr = ptlrpc_lprocfs_wr_threads_idle_timeout,
+		 .data	     = svc},
+		{.name	     = "req_wait_hist",
+		 .read_fptr  = ptlrpc_lprocfs_rd_req_wait_hist,
+		 .write_fptr = ptlrpc_lprocfs_wr_req_wait_hist,
+		 .data	     = svc},
+		{.name	     = "req_buffers",
+		 .read_fptr  = ptlrpc_lprocfs_rd_req_buffers,
+		 .data	     = svc},
                 {.name       = "timeouts",
                  .read_fptr  = ptlrpc_lprocfs_rd_timeouts,
                  .data       = svc},
@@ -317,9 +317,13 @@ int null_alloc_rs(struct ptlrpc_request *req, int msgsize)
                 /* pre-allocated */
                 LASSERT(rs->rs_size >= rs_size);
         } else {
-                OBD_ALLOC_LARGE(rs, rs_size);
-                if (rs == NULL)
-                        return -ENOMEM;
+		struct ptlrpc_service_part *svcpt = req->rq_rqbd->rqbd_svcpt;
+
+		/* keep the reply state on the CPT that handled the request */
+		OBD_CPT_ALLOC_LARGE(rs, svcpt->scp_service->srv_cptable,
+				    svcpt->scp_cpt, rs_size);
+		if (rs == NULL)
+			return -ENOMEM;
 
                 rs->rs_size = rs_size;
         }
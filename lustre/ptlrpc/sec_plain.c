@@ -827,9 +827,13 @@ int plain_alloc_rs(struct ptlrpc_request *req, int msgsize)
                 /* pre-allocated */
                 LASSERT(rs->rs_size >= rs_size);
         } else {
-                OBD_ALLOC_LARGE(rs, rs_size);
-                if (rs == NULL)
-                        RETURN(-ENOMEM);
+		struct ptlrpc_service_part *svcpt = req->rq_rqbd->rqbd_svcpt;
+
+		/* keep the reply state on the CPT that handled the request */
+		OBD_CPT_ALLOC_LARGE(rs, svcpt->scp_service->srv_cptable,
+				    svcpt->scp_cpt, rs_size);
+		if (rs == NULL)
+			RETURN(-ENOMEM);
 
                 rs->rs_size = rs_size;
         }
@@ -61,6 +61,32 @@ CFS_MODULE_PARM(at_early_margin, "i", int, 0644,
 CFS_MODULE_PARM(at_extra, "i", int, 0644,
                 "How much extra time to give with each early reply");
 
+static int thread_idle_timeout = 300;
+CFS_MODULE_PARM(thread_idle_timeout, "i", int, 0644,
+		"Default seconds an extra service thread may stay idle before "
+		"it exits (0 to never shrink)");
+static int thread_retire_wait = 1000;
+CFS_MODULE_PARM(thread_retire_wait, "i", int, 0644,
+		"Idle service threads only exit while the average request "
+		"queue wait is below this (usec)");
+static int thread_grow_wait = 10000;
+CFS_MODULE_PARM(thread_grow_wait, "i", int, 0644,
+		"Start another service thread while the average request "
+		"queue wait is above this and the CPUs are not saturated "
+		"(usec, 0 to only grow when all threads are busy)");
+static int req_buffer_max_scale = 16;
+CFS_MODULE_PARM(req_buffer_max_scale, "i", int, 0644,
+		"Request buffer pools may grow to this multiple of their "
+		"initial size to absorb request bursts (1 to disable)");
+
+/* don't grow a request buffer pool for this long after an allocation
+ * failure (sec) */
+#define PTLRPC_RQBD_SQUEEZE_TIME	10
+
+/* max # of AT timing wheels per service partition */
+#define PTLRPC_AT_ARRAYS_MAX	8
+/* # of early-replied requests put back into the timing wheels at once */
+#define PTLRPC_AT_BATCH		16
 
 /* forward ref */
 static int ptlrpc_server_post_idle_rqbds(struct ptlrpc_service_part *svcpt);
@@ -143,20 +169,28 @@ ptlrpc_grow_req_bufs(struct ptlrpc_service_part *svcpt, int post)
 	spin_unlock(&svcpt->scp_lock);
 
 
-        for (i = 0; i < svc->srv_nbuf_per_group; i++) {
-                /* NB: another thread might have recycled enough rqbds, we
+	for (i = 0; i < svcpt->scp_rqbd_target; i++) {
+		/* NB: another thread might have recycled enough rqbds, we
 		 * need to make sure it wouldn't over-allocate, see LU-1212. */
-		if (svcpt->scp_nrqbds_posted >= svc->srv_nbuf_per_group)
+		if (svcpt->scp_nrqbds_posted + i >= svcpt->scp_rqbd_target)
 			break;
 
 		rqbd = ptlrpc_alloc_rqbd(svcpt);
 
-                if (rqbd == NULL) {
-                        CERROR("%s: Can't allocate request buffer\n",
-                               svc->srv_name);
-                        rc = -ENOMEM;
-                        break;
-                }
+		if (rqbd == NULL) {
+			CERROR("%s: Can't allocate request buffer\n",
+			       svc->srv_name);
+			/* stop growing for a while, and settle for what we
+			 * have got so far */
+			spin_lock(&svcpt->scp_lock);
+			svcpt->scp_rqbd_squeezed = cfs_time_current_sec();
+			svcpt->scp_rqbd_target =
+				max(svc->srv_nbuf_per_group,
+				    svcpt->scp_nrqbds_posted + i);
+			spin_unlock(&svcpt->scp_lock);
+			rc = -ENOMEM;
+			break;
+		}
 	}
 
 	spin_lock(&svcpt->scp_lock);
@@ -240,8 +274,6 @@ struct ptlrpc_hr_service {
 	/** controller sleep waitq */
 	cfs_waitq_t			hr_waitq;
         unsigned int			hr_stopping;
-	/** roundrobin rotor for non-affinity service */
-	unsigned int			hr_rotor;
 	/* partition data */
 	struct ptlrpc_hr_partition	**hr_partitions;
 };
@@ -273,6 +305,11 @@ static void rs_batch_init(struct rs_batch *b)
 
 /**
  * Choose an hr thread to dispatch requests to.
+ *
+ * Replies of a CPT-affine service are handled on the partition of the
+ * service partition which handled the request, where its reply state was
+ * allocated.  Otherwise stay on the partition of the current CPU rather
+ * than spreading replies over remote nodes.
  */
 static struct ptlrpc_hr_thread *
 ptlrpc_hr_select(struct ptlrpc_service_part *svcpt)
@@ -286,10 +323,8 @@ ptlrpc_hr_select(struct ptlrpc_service_part *svcpt)
 		hrp = ptlrpc_hr.hr_partitions[svcpt->scp_cpt];
 
 	} else {
-		rotor = ptlrpc_hr.hr_rotor++;
-		rotor %= cfs_cpt_number(ptlrpc_hr.hr_cpt_table);
-
-		hrp = ptlrpc_hr.hr_partitions[rotor];
+		hrp = ptlrpc_hr.hr_partitions[cfs_cpt_current(
+					      ptlrpc_hr.hr_cpt_table, 1)];
 	}
 
 	rotor = hrp->hrp_rotor++;
@@ -421,28 +456,66 @@ ptlrpc_schedule_difficult_reply(struct ptlrpc_reply_state *rs)
 }
 EXPORT_SYMBOL(ptlrpc_schedule_difficult_reply);
 
+/**
+ * maximum number of service partitions whose committed replies are
+ * gathered separately by ptlrpc_commit_replies()
+ */
+#define RS_COMMIT_PARTS 8
+
 void ptlrpc_commit_replies(struct obd_export *exp)
 {
-        struct ptlrpc_reply_state *rs, *nxt;
-        DECLARE_RS_BATCH(batch);
-        ENTRY;
+	struct ptlrpc_reply_state	*rs, *nxt;
+	struct ptlrpc_service_part	*svcpts[RS_COMMIT_PARTS];
+	cfs_list_t			 lists[RS_COMMIT_PARTS];
+	int				 nparts = 0;
+	int				 i;
+	DECLARE_RS_BATCH(batch);
+	ENTRY;
 
-        rs_batch_init(&batch);
-        /* Find any replies that have been committed and get their service
-         * to attend to complete them. */
+	rs_batch_init(&batch);
+	/* Find any replies that have been committed and get their service
+	 * to attend to complete them.  Replies of an export usually come
+	 * from several service partitions: sort them onto a list per
+	 * partition in one pass, so each partition's replies are handed to
+	 * its hr threads in one batch instead of switching scp_rep_lock for
+	 * every reply.  The lists stay under exp_uncommitted_replies_lock,
+	 * which protects rs_obd_list. */
 
-        /* CAVEAT EMPTOR: spinlock ordering!!! */
+	/* CAVEAT EMPTOR: spinlock ordering!!! */
 	spin_lock(&exp->exp_uncommitted_replies_lock);
-        cfs_list_for_each_entry_safe(rs, nxt, &exp->exp_uncommitted_replies,
-                                     rs_obd_list) {
-                LASSERT (rs->rs_difficult);
-                /* VBR: per-export last_committed */
-                LASSERT(rs->rs_export);
-                if (rs->rs_transno <= exp->exp_last_committed) {
-                        cfs_list_del_init(&rs->rs_obd_list);
-                        rs_batch_add(&batch, rs);
-                }
-        }
+	cfs_list_for_each_entry_safe(rs, nxt, &exp->exp_uncommitted_replies,
+				     rs_obd_list) {
+		LASSERT(rs->rs_difficult);
+		/* VBR: per-export last_committed */
+		LASSERT(rs->rs_export);
+		if (rs->rs_transno > exp->exp_last_committed)
+			continue;
+
+		for (i = 0; i < nparts; i++) {
+			if (svcpts[i] == rs->rs_svcpt)
+				break;
+		}
+		if (i == nparts && nparts < RS_COMMIT_PARTS) {
+			svcpts[nparts] = rs->rs_svcpt;
+			CFS_INIT_LIST_HEAD(&lists[nparts]);
+			nparts++;
+		}
+
+		if (i < nparts) {
+			cfs_list_move_tail(&rs->rs_obd_list, &lists[i]);
+		} else {
+			/* too many partitions, schedule it right away */
+			cfs_list_del_init(&rs->rs_obd_list);
+			rs_batch_add(&batch, rs);
+		}
+	}
+
+	for (i = 0; i < nparts; i++) {
+		cfs_list_for_each_entry_safe(rs, nxt, &lists[i], rs_obd_list) {
+			cfs_list_del_init(&rs->rs_obd_list);
+			rs_batch_add(&batch, rs);
+		}
+	}
 	spin_unlock(&exp->exp_uncommitted_replies_lock);
 	rs_batch_fini(&batch);
 	EXIT;
@@ -467,7 +540,15 @@ ptlrpc_server_post_idle_rqbds(struct ptlrpc_service_part *svcpt)
 		rqbd = cfs_list_entry(svcpt->scp_rqbd_idle.next,
 				      struct ptlrpc_request_buffer_desc,
 				      rqbd_list);
-		cfs_list_del(&rqbd->rqbd_list);
+		cfs_list_del_init(&rqbd->rqbd_list);
+
+		/* the burst it was allocated for is over, give it back */
+		if (svcpt->scp_nrqbds_posted >= svcpt->scp_rqbd_target +
+						(svcpt->scp_rqbd_target >> 2)) {
+			spin_unlock(&svcpt->scp_lock);
+			ptlrpc_free_rqbd(rqbd);
+			continue;
+		}
 
 		/* assume we will post successfully */
 		svcpt->scp_nrqbds_posted++;
@@ -601,6 +682,7 @@ ptlrpc_server_nthreads_check(struct ptlrpc_service *svc,
 	nthrs = max(nthrs, tc->tc_nthrs_init);
 	svc->srv_nthrs_cpt_limit = nthrs;
 	svc->srv_nthrs_cpt_init = init;
+	svc->srv_nthrs_idle_timeout = max(0, thread_idle_timeout);
 
 	if (nthrs * svc->srv_ncpts > tc->tc_nthrs_max) {
 		LCONSOLE_WARN("%s: This service may have more threads (%d) "
@@ -611,6 +693,109 @@ ptlrpc_server_nthreads_check(struct ptlrpc_service *svc,
 #endif
 }
 
+static void
+ptlrpc_at_array_fini(struct ptlrpc_at_array *array)
+{
+	if (array->paa_reqs_array != NULL) {
+		OBD_FREE(array->paa_reqs_array,
+			 sizeof(cfs_list_t) * array->paa_size);
+		array->paa_reqs_array = NULL;
+	}
+
+	if (array->paa_reqs_count != NULL) {
+		OBD_FREE(array->paa_reqs_count,
+			 sizeof(__u32) * array->paa_size);
+		array->paa_reqs_count = NULL;
+	}
+}
+
+static int
+ptlrpc_at_array_init(struct ptlrpc_service *svc, struct ptlrpc_at_array *array,
+		     int cpt)
+{
+	int	size;
+	int	index;
+
+	size = at_est2timeout(at_max);
+	spin_lock_init(&array->paa_lock);
+	array->paa_size     = size;
+	array->paa_count    = 0;
+	array->paa_deadline = -1;
+
+	/* allocate memory for the timing wheel (ptlrpc_at_array) */
+	OBD_CPT_ALLOC(array->paa_reqs_array,
+		      svc->srv_cptable, cpt, sizeof(cfs_list_t) * size);
+	if (array->paa_reqs_array == NULL)
+		return -ENOMEM;
+
+	for (index = 0; index < size; index++)
+		CFS_INIT_LIST_HEAD(&array->paa_reqs_array[index]);
+
+	OBD_CPT_ALLOC(array->paa_reqs_count,
+		      svc->srv_cptable, cpt, sizeof(__u32) * size);
+	if (array->paa_reqs_count == NULL) {
+		ptlrpc_at_array_fini(array);
+		return -ENOMEM;
+	}
+
+	return 0;
+}
+
+static void
+ptlrpc_service_part_at_fini(struct ptlrpc_service_part *svcpt)
+{
+	int	i;
+
+	if (svcpt->scp_at_arrays == NULL)
+		return;
+
+	for (i = 0; i < svcpt->scp_at_narrays; i++)
+		ptlrpc_at_array_fini(&svcpt->scp_at_arrays[i]);
+
+	OBD_FREE(svcpt->scp_at_arrays,
+		 sizeof(struct ptlrpc_at_array) * svcpt->scp_at_narrays);
+	svcpt->scp_at_arrays = NULL;
+
+#ifdef HAVE_LIBCFS_CPT
+	if (svcpt->scp_at_cpu_index != NULL) {
+		OBD_FREE(svcpt->scp_at_cpu_index, NR_CPUS);
+		svcpt->scp_at_cpu_index = NULL;
+	}
+#endif
+}
+
+/*
+ * Map each CPU to a timing wheel by its position in the CPU mask of the
+ * partition, so that ptlrpc_at_array_index() is a lookup.  CPUs outside
+ * the partition, e.g. after a thread migrated, are spread by their number.
+ */
+static int
+ptlrpc_at_cpu_index_init(struct ptlrpc_service *svc,
+			 struct ptlrpc_service_part *svcpt, int cpt)
+{
+#ifdef HAVE_LIBCFS_CPT
+	cpumask_t	*mask;
+	int		 index = 0;
+	int		 i;
+
+	if (svcpt->scp_at_narrays == 1)
+		return 0;
+
+	OBD_CPT_ALLOC(svcpt->scp_at_cpu_index, svc->srv_cptable, cpt,
+		      NR_CPUS);
+	if (svcpt->scp_at_cpu_index == NULL)
+		return -ENOMEM;
+
+	for (i = 0; i < NR_CPUS; i++)
+		svcpt->scp_at_cpu_index[i] = i % svcpt->scp_at_narrays;
+
+	mask = cfs_cpt_cpumask(svc->srv_cptable, cpt);
+	for_each_cpu_mask(i, *mask)
+		svcpt->scp_at_cpu_index[i] = index++ % svcpt->scp_at_narrays;
+#endif
+	return 0;
+}
+
 /**
  * Initialize percpt data for a service
  */
@@ -618,10 +803,9 @@ static int
 ptlrpc_service_part_init(struct ptlrpc_service *svc,
 			 struct ptlrpc_service_part *svcpt, int cpt)
 {
-	struct ptlrpc_at_array	*array;
-	int			size;
-	int			index;
-	int			rc;
+	int	narrays;
+	int	i;
+	int	rc;
 
 	svcpt->scp_cpt = cpt;
 	CFS_INIT_LIST_HEAD(&svcpt->scp_threads);
@@ -649,27 +833,34 @@ ptlrpc_service_part_init(struct ptlrpc_service *svc,
 	cfs_waitq_init(&svcpt->scp_rep_waitq);
 	cfs_atomic_set(&svcpt->scp_nreps_difficult, 0);
 
-	/* adaptive timeout */
+	/* queue wait statistics for the thread pool controller */
+	spin_lock_init(&svcpt->scp_wait_hist.oh_lock);
+	svcpt->scp_wait_avg = 0;
+
+	/* adaptive timeout: one timing wheel per CPU of this partition, so
+	 * that tracking a request doesn't bounce a lock between CPUs */
 	spin_lock_init(&svcpt->scp_at_lock);
-	array = &svcpt->scp_at_array;
+	svcpt->scp_at_armed = -1;
 
-	size = at_est2timeout(at_max);
-	array->paa_size     = size;
-	array->paa_count    = 0;
-	array->paa_deadline = -1;
+	narrays = cpt == CFS_CPT_ANY ?
+		  cfs_cpt_weight(svc->srv_cptable, CFS_CPT_ANY) :
+		  cfs_cpt_weight(svc->srv_cptable, cpt);
+	narrays = max(1, min(narrays, PTLRPC_AT_ARRAYS_MAX));
 
-	/* allocate memory for scp_at_array (ptlrpc_at_array) */
-	OBD_CPT_ALLOC(array->paa_reqs_array,
-		      svc->srv_cptable, cpt, sizeof(cfs_list_t) * size);
-	if (array->paa_reqs_array == NULL)
+	OBD_CPT_ALLOC(svcpt->scp_at_arrays, svc->srv_cptable, cpt,
+		      sizeof(struct ptlrpc_at_array) * narrays);
+	if (svcpt->scp_at_arrays == NULL)
 		return -ENOMEM;
+	svcpt->scp_at_narrays = narrays;
 
-	for (index = 0; index < size; index++)
-		CFS_INIT_LIST_HEAD(&array->paa_reqs_array[index]);
+	for (i = 0; i < narrays; i++) {
+		rc = ptlrpc_at_array_init(svc, &svcpt->scp_at_arrays[i], cpt);
+		if (rc != 0)
+			goto failed;
+	}
 
-	OBD_CPT_ALLOC(array->paa_reqs_count,
-		      svc->srv_cptable, cpt, sizeof(__u32) * size);
-	if (array->paa_reqs_count == NULL)
+	rc = ptlrpc_at_cpu_index_init(svc, svcpt, cpt);
+	if (rc != 0)
 		goto failed;
 
 	cfs_timer_init(&svcpt->scp_at_timer, ptlrpc_at_timer, svcpt);
@@ -679,6 +870,8 @@ ptlrpc_service_part_init(struct ptlrpc_service *svc,
 
 	/* assign this before call ptlrpc_grow_req_bufs */
 	svcpt->scp_service = svc;
+	svcpt->scp_rqbd_target = svc->srv_nbuf_per_group;
+	svcpt->scp_rqbd_sampled = cfs_time_current_sec();
 	/* Now allocate the request buffers, but don't post them now */
 	rc = ptlrpc_grow_req_bufs(svcpt, 0);
 	/* We shouldn't be under memory pressure at startup, so
@@ -689,16 +882,7 @@ ptlrpc_service_part_init(struct ptlrpc_service *svc,
 	return 0;
 
  failed:
-	if (array->paa_reqs_count != NULL) {
-		OBD_FREE(array->paa_reqs_count, sizeof(__u32) * size);
-		array->paa_reqs_count = NULL;
-	}
-
-	if (array->paa_reqs_array != NULL) {
-		OBD_FREE(array->paa_reqs_array,
-			 sizeof(cfs_list_t) * array->paa_size);
-		array->paa_reqs_array = NULL;
-	}
+	ptlrpc_service_part_at_fini(svcpt);
 
 	return -ENOMEM;
 }
@@ -894,12 +1078,15 @@ void ptlrpc_server_drop_request(struct ptlrpc_request *req)
                 return;
 
 	if (req->rq_at_linked) {
-		spin_lock(&svcpt->scp_at_lock);
+		struct ptlrpc_at_array *array;
+
+		array = &svcpt->scp_at_arrays[req->rq_at_array];
+		spin_lock(&array->paa_lock);
 		/* recheck with lock, in case it's unlinked by
 		 * ptlrpc_at_check_timed() */
 		if (likely(req->rq_at_linked))
 			ptlrpc_at_remove_timed(req);
-		spin_unlock(&svcpt->scp_at_lock);
+		spin_unlock(&array->paa_lock);
 	}
 
 	LASSERT(cfs_list_empty(&req->rq_timed_list));
@@ -1136,19 +1323,35 @@ static int ptlrpc_check_req(struct ptlrpc_request *req)
         return rc;
 }
 
-static void ptlrpc_at_set_timer(struct ptlrpc_service_part *svcpt)
+/**
+ * Arm the early reply timer of \a svcpt for \a deadline, unless it is
+ * already armed for an earlier one.  A deadline of -1 means there is nothing
+ * to track any more.
+ *
+ * ptlrpc_at_check_timed() resets scp_at_armed before it scans the arrays, so
+ * a request added during the scan always gets a chance to arm the timer.
+ */
+static void ptlrpc_at_set_timer(struct ptlrpc_service_part *svcpt,
+				time_t deadline)
 {
-	struct ptlrpc_at_array *array = &svcpt->scp_at_array;
 	__s32 next;
 
-	if (array->paa_count == 0) {
-		cfs_timer_disarm(&svcpt->scp_at_timer);
+	spin_lock(&svcpt->scp_at_lock);
+	if (deadline == -1) {
+		if (svcpt->scp_at_armed == -1)
+			cfs_timer_disarm(&svcpt->scp_at_timer);
+		spin_unlock(&svcpt->scp_at_lock);
 		return;
 	}
 
+	if (svcpt->scp_at_armed != -1 && svcpt->scp_at_armed <= deadline) {
+		spin_unlock(&svcpt->scp_at_lock);
+		return;
+	}
+	svcpt->scp_at_armed = deadline;
+
 	/* Set timer for closest deadline */
-	next = (__s32)(array->paa_deadline - cfs_time_current_sec() -
-		       at_early_margin);
+	next = (__s32)(deadline - cfs_time_current_sec() - at_early_margin);
 	if (next <= 0) {
 		ptlrpc_at_timer((unsigned long)svcpt);
 	} else {
@@ -1156,47 +1359,54 @@ static void ptlrpc_at_set_timer(struct ptlrpc_service_part *svcpt)
 		CDEBUG(D_INFO, "armed %s at %+ds\n",
 		       svcpt->scp_service->srv_name, next);
 	}
+	spin_unlock(&svcpt->scp_at_lock);
 }
 
-/* Add rpc to early reply check list */
-static int ptlrpc_at_add_timed(struct ptlrpc_request *req)
+static inline int ptlrpc_at_need_timed(struct ptlrpc_request *req)
 {
-	struct ptlrpc_service_part *svcpt = req->rq_rqbd->rqbd_svcpt;
-	struct ptlrpc_at_array *array = &svcpt->scp_at_array;
-        struct ptlrpc_request *rq = NULL;
-        __u32 index;
+	if (AT_OFF)
+		return 0;
 
-        if (AT_OFF)
-                return(0);
+	if (req->rq_no_reply)
+		return 0;
 
-        if (req->rq_no_reply)
-                return 0;
+	if ((lustre_msghdr_get_flags(req->rq_reqmsg) & MSGHDR_AT_SUPPORT) == 0)
+		return -ENOSYS;
 
-        if ((lustre_msghdr_get_flags(req->rq_reqmsg) & MSGHDR_AT_SUPPORT) == 0)
-                return(-ENOSYS);
+	return 1;
+}
 
-	spin_lock(&svcpt->scp_at_lock);
-        LASSERT(cfs_list_empty(&req->rq_timed_list));
+/**
+ * Link \a req into the timing wheel \a array, which must be locked by the
+ * caller.  Returns 1 if the request has the earliest deadline of the array.
+ */
+static int ptlrpc_at_link_timed(struct ptlrpc_at_array *array,
+				struct ptlrpc_request *req)
+{
+	struct ptlrpc_request	*rq = NULL;
+	__u32			 index;
 
-        index = (unsigned long)req->rq_deadline % array->paa_size;
-        if (array->paa_reqs_count[index] > 0) {
-                /* latest rpcs will have the latest deadlines in the list,
-                 * so search backward. */
-                cfs_list_for_each_entry_reverse(rq,
-                                                &array->paa_reqs_array[index],
-                                                rq_timed_list) {
-                        if (req->rq_deadline >= rq->rq_deadline) {
-                                cfs_list_add(&req->rq_timed_list,
-                                             &rq->rq_timed_list);
-                                break;
-                        }
-                }
-        }
+	LASSERT(cfs_list_empty(&req->rq_timed_list));
+
+	index = (unsigned long)req->rq_deadline % array->paa_size;
+	if (array->paa_reqs_count[index] > 0) {
+		/* latest rpcs will have the latest deadlines in the list,
+		 * so search backward. */
+		cfs_list_for_each_entry_reverse(rq,
+						&array->paa_reqs_array[index],
+						rq_timed_list) {
+			if (req->rq_deadline >= rq->rq_deadline) {
+				cfs_list_add(&req->rq_timed_list,
+					     &rq->rq_timed_list);
+				break;
+			}
+		}
+	}
 
-        /* Add the request at the head of the list */
-        if (cfs_list_empty(&req->rq_timed_list))
-                cfs_list_add(&req->rq_timed_list,
-                             &array->paa_reqs_array[index]);
+	/* Add the request at the head of the list */
+	if (cfs_list_empty(&req->rq_timed_list))
+		cfs_list_add(&req->rq_timed_list,
+			     &array->paa_reqs_array[index]);
 
 	spin_lock(&req->rq_lock);
 	req->rq_at_linked = 1;
@@ -1206,9 +1416,46 @@ static int ptlrpc_at_add_timed(struct ptlrpc_request *req)
 	array->paa_count++;
 	if (array->paa_count == 1 || array->paa_deadline > req->rq_deadline) {
 		array->paa_deadline = req->rq_deadline;
-		ptlrpc_at_set_timer(svcpt);
+		return 1;
 	}
-	spin_unlock(&svcpt->scp_at_lock);
+	return 0;
+}
+
+/*
+ * AT array of the current CPU, see ptlrpc_at_cpu_index_init().  The CPU is
+ * only a hint for spreading the lock, the request remembers its array, so
+ * preemption doesn't matter here.
+ */
+static int ptlrpc_at_array_index(struct ptlrpc_service_part *svcpt)
+{
+#ifdef HAVE_LIBCFS_CPT
+	if (svcpt->scp_at_cpu_index != NULL)
+		return svcpt->scp_at_cpu_index[raw_smp_processor_id()];
+#endif
+	return 0;
+}
+
+/* Add rpc to early reply check list */
+static int ptlrpc_at_add_timed(struct ptlrpc_request *req)
+{
+	struct ptlrpc_service_part *svcpt = req->rq_rqbd->rqbd_svcpt;
+	struct ptlrpc_at_array	   *array;
+	int			    earliest;
+	int			    rc;
+
+	rc = ptlrpc_at_need_timed(req);
+	if (rc <= 0)
+		return rc;
+
+	req->rq_at_array = ptlrpc_at_array_index(svcpt);
+	array = &svcpt->scp_at_arrays[req->rq_at_array];
+
+	spin_lock(&array->paa_lock);
+	earliest = ptlrpc_at_link_timed(array, req);
+	spin_unlock(&array->paa_lock);
+
+	if (earliest)
+		ptlrpc_at_set_timer(svcpt, req->rq_deadline);
 
 	return 0;
 }
@@ -1218,9 +1465,9 @@ ptlrpc_at_remove_timed(struct ptlrpc_request *req)
 {
 	struct ptlrpc_at_array *array;
 
-	array = &req->rq_rqbd->rqbd_svcpt->scp_at_array;
+	array = &req->rq_rqbd->rqbd_svcpt->scp_at_arrays[req->rq_at_array];
 
-	/* NB: must call with hold svcpt::scp_at_lock */
+	/* NB: must call with hold ptlrpc_at_array::paa_lock */
 	LASSERT(!cfs_list_empty(&req->rq_timed_list));
 	cfs_list_del_init(&req->rq_timed_list);
 
@@ -1368,53 +1615,26 @@ out:
         RETURN(rc);
 }
 
-/* Send early replies to everybody expiring within at_early_margin
-   asking for at_extra time */
-static int ptlrpc_at_check_timed(struct ptlrpc_service_part *svcpt)
-{
-	struct ptlrpc_at_array *array = &svcpt->scp_at_array;
-        struct ptlrpc_request *rq, *n;
-        cfs_list_t work_list;
-        __u32  index, count;
-        time_t deadline;
-        time_t now = cfs_time_current_sec();
-        cfs_duration_t delay;
-        int first, counter = 0;
-        ENTRY;
-
-	spin_lock(&svcpt->scp_at_lock);
-	if (svcpt->scp_at_check == 0) {
-		spin_unlock(&svcpt->scp_at_lock);
-		RETURN(0);
-	}
-	delay = cfs_time_sub(cfs_time_current(), svcpt->scp_at_checktime);
-	svcpt->scp_at_check = 0;
-
-	if (array->paa_count == 0) {
-		spin_unlock(&svcpt->scp_at_lock);
-		RETURN(0);
-	}
-
-	/* The timer went off, but maybe the nearest rpc already completed. */
-	first = array->paa_deadline - now;
-	if (first > at_early_margin) {
-		/* We've still got plenty of time.  Reset the timer. */
-		ptlrpc_at_set_timer(svcpt);
-		spin_unlock(&svcpt->scp_at_lock);
-		RETURN(0);
-	}
-
-        /* We're close to a timeout, and we don't know how much longer the
-           server will take. Send early replies to everyone expiring soon. */
-        CFS_INIT_LIST_HEAD(&work_list);
-        deadline = -1;
-        index = (unsigned long)array->paa_deadline % array->paa_size;
-        count = array->paa_count;
-        while (count > 0) {
-                count -= array->paa_reqs_count[index];
-                cfs_list_for_each_entry_safe(rq, n,
-                                             &array->paa_reqs_array[index],
-                                             rq_timed_list) {
+/**
+ * Move requests of \a array expiring within at_early_margin to \a work_list.
+ * Called with ptlrpc_at_array::paa_lock held, returns the number of requests
+ * moved.
+ */
+static int ptlrpc_at_collect_timed(struct ptlrpc_at_array *array, time_t now,
+				   cfs_list_t *work_list)
+{
+	struct ptlrpc_request	*rq, *n;
+	__u32			 index, count;
+	time_t			 deadline = -1;
+	int			 counter = 0;
+
+	index = (unsigned long)array->paa_deadline % array->paa_size;
+	count = array->paa_count;
+	while (count > 0) {
+		count -= array->paa_reqs_count[index];
+		cfs_list_for_each_entry_safe(rq, n,
+					     &array->paa_reqs_array[index],
+					     rq_timed_list) {
 			if (rq->rq_deadline > now + at_early_margin) {
 				/* update the earliest deadline */
 				if (deadline == -1 ||
@@ -1430,19 +1650,118 @@ static int ptlrpc_at_check_timed(struct ptlrpc_service_part *svcpt)
 			 * don't add entry to work_list
 			 */
 			if (likely(cfs_atomic_inc_not_zero(&rq->rq_refcount)))
-				cfs_list_add(&rq->rq_timed_list, &work_list);
+				cfs_list_add(&rq->rq_timed_list, work_list);
 			counter++;
-                }
+		}
 
-                if (++index >= array->paa_size)
-                        index = 0;
-        }
-        array->paa_deadline = deadline;
-	/* we have a new earliest deadline, restart the timer */
-	ptlrpc_at_set_timer(svcpt);
+		if (++index >= array->paa_size)
+			index = 0;
+	}
+	array->paa_deadline = deadline;
+
+	return counter;
+}
+
+/**
+ * Put requests which got an early reply back into their timing wheels.
+ * Requests of the same wheel are linked under one lock hold, the extra
+ * reference taken by ptlrpc_at_collect_timed() is dropped afterwards.
+ */
+static void ptlrpc_at_relink_timed(struct ptlrpc_service_part *svcpt,
+				   struct ptlrpc_request **batch, int nr)
+{
+	struct ptlrpc_at_array	*array = NULL;
+	time_t			 deadline = -1;
+	int			 i;
+
+	for (i = 0; i < nr; i++) {
+		struct ptlrpc_at_array *next;
+
+		if (ptlrpc_at_need_timed(batch[i]) <= 0)
+			continue;
+
+		next = &svcpt->scp_at_arrays[batch[i]->rq_at_array];
+		if (next != array) {
+			if (array != NULL)
+				spin_unlock(&array->paa_lock);
+			array = next;
+			spin_lock(&array->paa_lock);
+		}
+
+		if (ptlrpc_at_link_timed(array, batch[i]) &&
+		    (deadline == -1 || batch[i]->rq_deadline < deadline))
+			deadline = batch[i]->rq_deadline;
+	}
+	if (array != NULL)
+		spin_unlock(&array->paa_lock);
+
+	if (deadline != -1)
+		ptlrpc_at_set_timer(svcpt, deadline);
+
+	for (i = 0; i < nr; i++)
+		ptlrpc_server_drop_request(batch[i]);
+}
+
+/* Send early replies to everybody expiring within at_early_margin
+   asking for at_extra time */
+static int ptlrpc_at_check_timed(struct ptlrpc_service_part *svcpt)
+{
+	struct ptlrpc_at_array *array;
+	struct ptlrpc_request *rq;
+	struct ptlrpc_request *batch[PTLRPC_AT_BATCH];
+	cfs_list_t work_list;
+	time_t deadline = -1;
+	time_t now = cfs_time_current_sec();
+	cfs_duration_t delay;
+	int first = INT_MAX;
+	int counter = 0;
+	int nr = 0;
+	int i;
+	ENTRY;
 
+	spin_lock(&svcpt->scp_at_lock);
+	if (svcpt->scp_at_check == 0) {
+		spin_unlock(&svcpt->scp_at_lock);
+		RETURN(0);
+	}
+	delay = cfs_time_sub(cfs_time_current(), svcpt->scp_at_checktime);
+	svcpt->scp_at_check = 0;
+	/* the timer is spent, let new requests rearm it during the scan */
+	svcpt->scp_at_armed = -1;
 	spin_unlock(&svcpt->scp_at_lock);
 
+	CFS_INIT_LIST_HEAD(&work_list);
+	for (i = 0; i < svcpt->scp_at_narrays; i++) {
+		array = &svcpt->scp_at_arrays[i];
+
+		spin_lock(&array->paa_lock);
+		if (array->paa_count == 0) {
+			spin_unlock(&array->paa_lock);
+			continue;
+		}
+
+		/* The timer went off, but maybe the nearest rpc already
+		 * completed. */
+		if (array->paa_deadline - now < first)
+			first = array->paa_deadline - now;
+		if (array->paa_deadline - now <= at_early_margin)
+			counter += ptlrpc_at_collect_timed(array, now,
+							   &work_list);
+
+		if (array->paa_count > 0 &&
+		    (deadline == -1 || array->paa_deadline < deadline))
+			deadline = array->paa_deadline;
+		spin_unlock(&array->paa_lock);
+	}
+
+	/* we have a new earliest deadline, restart the timer */
+	ptlrpc_at_set_timer(svcpt, deadline);
+
+	if (counter == 0)
+		RETURN(0);
+
+        /* We're close to a timeout, and we don't know how much longer the
+           server will take. Send early replies to everyone expiring soon. */
         CDEBUG(D_ADAPTTO, "timeout in %+ds, asking for %d secs on %d early "
                "replies\n", first, at_extra, counter);
         if (first < 0) {
@@ -1458,18 +1777,28 @@ static int ptlrpc_at_check_timed(struct ptlrpc_service_part *svcpt)
 		      at_get(&svcpt->scp_at_estimate), delay);
         }
 
-        /* we took additional refcount so entries can't be deleted from list, no
-         * locking is needed */
-        while (!cfs_list_empty(&work_list)) {
-                rq = cfs_list_entry(work_list.next, struct ptlrpc_request,
-                                    rq_timed_list);
-                cfs_list_del_init(&rq->rq_timed_list);
-
-                if (ptlrpc_at_send_early_reply(rq) == 0)
-                        ptlrpc_at_add_timed(rq);
+	/* we took additional refcount so entries can't be deleted from list, no
+	 * locking is needed.  Requests which got an early reply are put back
+	 * into the wheels in batches, to take each wheel lock only once per
+	 * batch rather than once per request. */
+	while (!cfs_list_empty(&work_list)) {
+		rq = cfs_list_entry(work_list.next, struct ptlrpc_request,
+				    rq_timed_list);
+		cfs_list_del_init(&rq->rq_timed_list);
+
+		if (ptlrpc_at_send_early_reply(rq) != 0) {
+			ptlrpc_server_drop_request(rq);
+			continue;
+		}
 
-                ptlrpc_server_drop_request(rq);
-        }
+		batch[nr++] = rq;
+		if (nr == PTLRPC_AT_BATCH) {
+			ptlrpc_at_relink_timed(svcpt, batch, nr);
+			nr = 0;
+		}
+	}
+	if (nr > 0)
+		ptlrpc_at_relink_timed(svcpt, batch, nr);
 
 	RETURN(1); /* return "did_something" for liblustre */
 }
@@ -1919,6 +2248,10 @@ ptlrpc_server_handle_request(struct ptlrpc_service_part *svcpt,
 
         cfs_gettimeofday(&work_start);
         timediff = cfs_timeval_sub(&work_start, &request->rq_arrival_time,NULL);
+	/* 1/8 weighted moving average, updated without lock as it is only
+	 * a hint for ptlrpc_thread_retire() */
+	svcpt->scp_wait_avg += (max(timediff, 0L) - svcpt->scp_wait_avg) / 8;
+	lprocfs_oh_tally_log2(&svcpt->scp_wait_hist, max(timediff, 0L));
         if (likely(svc->srv_stats != NULL)) {
                 lprocfs_counter_add(svc->srv_stats, PTLRPC_REQWAIT_CNTR,
                                     timediff);
@@ -2226,12 +2559,80 @@ liblustre_check_services (void *arg)
 
 #else /* __KERNEL__ */
 
+/**
+ * Size the pool of posted request buffers from the request arrival rate:
+ * keep enough buffers posted to land about one second's worth of requests,
+ * so a reconnect storm doesn't run the partition out of buffers.  The rate
+ * follows bursts up at once and decays slowly, and the pool doesn't grow
+ * for a while after we failed to allocate buffers.
+ */
+static void
+ptlrpc_rqbd_pool_resize(struct ptlrpc_service_part *svcpt)
+{
+	struct ptlrpc_service	*svc = svcpt->scp_service;
+	time_t			 now = cfs_time_current_sec();
+	int			 per_buf;
+	int			 target;
+	int			 rate;
+
+	/* NB I'm not locking; just looking. */
+	if (svcpt->scp_rqbd_sampled == now || test_req_buffer_pressure)
+		return;
+
+	spin_lock(&svcpt->scp_lock);
+	if (svcpt->scp_rqbd_sampled == now) {
+		spin_unlock(&svcpt->scp_lock);
+		return;
+	}
+
+	rate = svcpt->scp_rqbd_arrivals / (now - svcpt->scp_rqbd_sampled);
+	if (svcpt->scp_rqbd_arrivals > 0)
+		svcpt->scp_rqbd_msgsize = svcpt->scp_rqbd_bytes /
+					  svcpt->scp_rqbd_arrivals;
+	svcpt->scp_rqbd_arrivals = 0;
+	svcpt->scp_rqbd_bytes = 0;
+	svcpt->scp_rqbd_sampled = now;
+
+	if (rate >= svcpt->scp_rqbd_rate)
+		svcpt->scp_rqbd_rate = rate;
+	else
+		svcpt->scp_rqbd_rate -= (svcpt->scp_rqbd_rate - rate + 3) / 4;
+
+	/* LNet unlinks a buffer once less than srv_max_req_size is left */
+	per_buf = 1;
+	if (svcpt->scp_rqbd_msgsize > 0 &&
+	    svc->srv_buf_size > svc->srv_max_req_size)
+		per_buf += (svc->srv_buf_size - svc->srv_max_req_size) /
+			   svcpt->scp_rqbd_msgsize;
+
+	target = svcpt->scp_rqbd_rate / per_buf;
+	target = min(target, svc->srv_nbuf_per_group *
+			     max(req_buffer_max_scale, 1));
+	target = max(target, svc->srv_nbuf_per_group);
+
+	if (now - svcpt->scp_rqbd_squeezed < PTLRPC_RQBD_SQUEEZE_TIME)
+		target = min(target, svcpt->scp_rqbd_target);
+
+	if (target != svcpt->scp_rqbd_target)
+		CDEBUG(D_RPCTRACE, "%s: cpt %d request buffers %d -> %d, "
+		       "%d reqs/sec of %d bytes\n", svc->srv_name,
+		       svcpt->scp_cpt, svcpt->scp_rqbd_target, target,
+		       svcpt->scp_rqbd_rate, svcpt->scp_rqbd_msgsize);
+	svcpt->scp_rqbd_target = target;
+
+	spin_unlock(&svcpt->scp_lock);
+}
+
 static void
 ptlrpc_check_rqbd_pool(struct ptlrpc_service_part *svcpt)
 {
 	int avail = svcpt->scp_nrqbds_posted;
-	int low_water = test_req_buffer_pressure ? 0 :
-			svcpt->scp_service->srv_nbuf_per_group / 2;
+	int low_water;
+
+	ptlrpc_rqbd_pool_resize(svcpt);
+
+	low_water = test_req_buffer_pressure ? 0 :
+		    svcpt->scp_rqbd_target / 2;
 
         /* NB I'm not locking; just looking. */
 
@@ -2280,13 +2681,40 @@ ptlrpc_threads_increasable(struct ptlrpc_service_part *svcpt)
 }
 
 /**
- * too many requests and allowed to create more threads
+ * CPU load input of the thread pool controller: the CPUs are saturated if
+ * the 1-minute load average is at least the number of online CPUs, more
+ * service threads would then only add scheduling and lock contention.  The
+ * load average is system wide and also counts tasks blocked on I/O, so it is
+ * only used to hold back growth that queue wait alone asks for.
+ */
+static inline int
+ptlrpc_cpus_saturated(void)
+{
+#ifdef __KERNEL__
+	return (avenrun[0] >> FSHIFT) >= num_online_cpus();
+#else
+	return 0;
+#endif
+}
+
+/**
+ * too many requests and allowed to create more threads: either all threads
+ * are busy, or requests wait too long in the queue while at least half of
+ * the threads are busy and there is CPU left to run another one
  */
 static inline int
 ptlrpc_threads_need_create(struct ptlrpc_service_part *svcpt)
 {
-	return !ptlrpc_threads_enough(svcpt) &&
-		ptlrpc_threads_increasable(svcpt);
+	if (!ptlrpc_threads_increasable(svcpt))
+		return 0;
+
+	if (!ptlrpc_threads_enough(svcpt))
+		return 1;
+
+	return thread_grow_wait > 0 &&
+	       svcpt->scp_wait_avg > thread_grow_wait &&
+	       svcpt->scp_nreqs_active >= svcpt->scp_nthrs_running / 2 &&
+	       !ptlrpc_cpus_saturated();
 }
 
 static inline int
@@ -2296,6 +2724,72 @@ ptlrpc_thread_stopping(struct ptlrpc_thread *thread)
 	       thread->t_svcpt->scp_service->srv_is_stopping;
 }
 
+/**
+ * Idle threads may exit if there are more of them than the service needs
+ * at start up and the thread pool is not busy.
+ */
+static inline int
+ptlrpc_threads_shrinkable(struct ptlrpc_service_part *svcpt)
+{
+	return svcpt->scp_service->srv_nthrs_idle_timeout > 0 &&
+	       svcpt->scp_nthrs_running > svcpt->scp_service->srv_nthrs_cpt_init;
+}
+
+/**
+ * Called when \a thread has been idle for srv_nthrs_idle_timeout: let it
+ * exit if requests hardly wait in the queue and either at most half of the
+ * threads are busy or the CPUs are saturated anyway.  Scaling down only after
+ * a long idle period while growing as soon as threads run short gives the
+ * hysteresis needed to not flap on bursty workloads.
+ *
+ * Returns 1 if the thread has to exit; it stays on scp_threads until it is
+ * SVC_STOPPED, see the end of ptlrpc_main().
+ */
+static int
+ptlrpc_thread_retire(struct ptlrpc_service_part *svcpt,
+		     struct ptlrpc_thread *thread)
+{
+	struct ptlrpc_reply_state *rs = NULL;
+	int			   retire = 0;
+
+	/* nobody needed this thread for a while, age the wait estimate as no
+	 * request may have updated it */
+	svcpt->scp_wait_avg /= 2;
+
+	spin_lock(&svcpt->scp_lock);
+	if (!ptlrpc_thread_stopping(thread) &&
+	    ptlrpc_threads_shrinkable(svcpt) &&
+	    svcpt->scp_nthrs_starting == 0 &&
+	    svcpt->scp_wait_avg < thread_retire_wait &&
+	    (svcpt->scp_nreqs_active < svcpt->scp_nthrs_running / 2 ||
+	     ptlrpc_cpus_saturated())) {
+		thread_clear_flags(thread, SVC_RUNNING);
+		svcpt->scp_nthrs_running--;
+		retire = 1;
+	}
+	spin_unlock(&svcpt->scp_lock);
+
+	if (!retire)
+		return 0;
+
+	/* give back the reply state this thread added to the pool */
+	spin_lock(&svcpt->scp_rep_lock);
+	if (!cfs_list_empty(&svcpt->scp_rep_idle)) {
+		rs = cfs_list_entry(svcpt->scp_rep_idle.next,
+				    struct ptlrpc_reply_state, rs_list);
+		cfs_list_del(&rs->rs_list);
+	}
+	spin_unlock(&svcpt->scp_rep_lock);
+
+	if (rs != NULL)
+		OBD_FREE_LARGE(rs, svcpt->scp_service->srv_max_reply_size);
+
+	CDEBUG(D_RPCTRACE, "%s: idle thread %s exits, %d threads left\n",
+	       svcpt->scp_service->srv_name, thread->t_name,
+	       svcpt->scp_nthrs_running);
+	return 1;
+}
+
 static inline int
 ptlrpc_rqbd_pending(struct ptlrpc_service_part *svcpt)
 {
@@ -2327,24 +2821,38 @@ ptlrpc_wait_event(struct ptlrpc_service_part *svcpt,
 	/* Don't exit while there are replies to be handled */
 	struct l_wait_info lwi = LWI_TIMEOUT(svcpt->scp_rqbd_timeout,
 					     ptlrpc_retry_rqbds, svcpt);
+	int		   timeout = svcpt->scp_service->srv_nthrs_idle_timeout;
+	int		   idle = 0;
+	int		   rc;
 
 	lc_watchdog_disable(thread->t_watchdog);
 
 	cfs_cond_resched();
 
-	l_wait_event_exclusive_head(svcpt->scp_waitq,
+	/* threads are woken up LIFO, so threads which wait long are not
+	 * needed by the current load */
+	if (svcpt->scp_rqbd_timeout == 0 && ptlrpc_threads_shrinkable(svcpt)) {
+		lwi = LWI_TIMEOUT(cfs_time_seconds(timeout), NULL, NULL);
+		idle = 1;
+	}
+
+	/* a new threads_idle_timeout wakes the idle threads up to wait again
+	 * with it */
+	rc = l_wait_event_exclusive_head(svcpt->scp_waitq,
 				ptlrpc_thread_stopping(thread) ||
 				ptlrpc_server_request_incoming(svcpt) ||
 				ptlrpc_server_request_pending(svcpt, 0) ||
 				ptlrpc_rqbd_pending(svcpt) ||
-				ptlrpc_at_check(svcpt), &lwi);
+				ptlrpc_at_check(svcpt) ||
+				svcpt->scp_service->srv_nthrs_idle_timeout !=
+				timeout, &lwi);
 
 	if (ptlrpc_thread_stopping(thread))
 		return -EINTR;
 
 	lc_watchdog_touch(thread->t_watchdog,
 			  ptlrpc_server_get_timeout(svcpt));
-	return 0;
+	return (idle && rc == -ETIMEDOUT) ? -ETIMEDOUT : 0;
 }
 
 /**
@@ -2364,6 +2872,7 @@ static int ptlrpc_main(void *arg)
 #endif
         struct lu_env *env;
         int counter = 0, rc = 0;
+	int retired = 0;
         ENTRY;
 
         thread->t_pid = cfs_curproc_pid();
@@ -2420,9 +2929,10 @@ static int ptlrpc_main(void *arg)
 		goto out_srv_fini;
 	}
 
-        /* Alloc reply state structure for this one */
-        OBD_ALLOC_LARGE(rs, svc->srv_max_reply_size);
-        if (!rs) {
+	/* Alloc reply state structure for this one */
+	OBD_CPT_ALLOC_LARGE(rs, svc->srv_cptable, svcpt->scp_cpt,
+			    svc->srv_max_reply_size);
+	if (!rs) {
                 rc = -ENOMEM;
                 goto out_srv_fini;
         }
@@ -2459,8 +2969,15 @@ static int ptlrpc_main(void *arg)
 
 	/* XXX maintain a list of all managed devices: insert here */
 	while (!ptlrpc_thread_stopping(thread)) {
-		if (ptlrpc_wait_event(svcpt, thread))
+		int event = ptlrpc_wait_event(svcpt, thread);
+
+		if (event == -ETIMEDOUT) {
+			retired = ptlrpc_thread_retire(svcpt, thread);
+			if (retired)
+				break;
+		} else if (event != 0) {
 			break;
+		}
 
 		ptlrpc_check_rqbd_pool(svcpt);
 
@@ -2529,8 +3046,17 @@ out:
 	thread_add_flags(thread, SVC_STOPPED);
 
 	cfs_waitq_signal(&thread->t_ctl_waitq);
+	/* a retired thread frees itself, unless ptlrpc_svcpt_stop_threads()
+	 * already waits for it and will free it */
+	if (retired && thread_is_stopping(thread))
+		retired = 0;
+	if (retired)
+		cfs_list_del(&thread->t_link);
 	spin_unlock(&svcpt->scp_lock);
 
+	if (retired)
+		OBD_FREE_PTR(thread);
+
 	return rc;
 }
 
@@ -3090,7 +3616,6 @@ static void
 ptlrpc_service_free(struct ptlrpc_service *svc)
 {
 	struct ptlrpc_service_part	*svcpt;
-	struct ptlrpc_at_array		*array;
 	int				i;
 
 	ptlrpc_service_for_each_part(svcpt, i, svc) {
@@ -3099,19 +3624,7 @@ ptlrpc_service_free(struct ptlrpc_service *svc)
 
 		/* In case somebody rearmed this in the meantime */
 		cfs_timer_disarm(&svcpt->scp_at_timer);
-		array = &svcpt->scp_at_array;
-
-		if (array->paa_reqs_array != NULL) {
-			OBD_FREE(array->paa_reqs_array,
-				 sizeof(cfs_list_t) * array->paa_size);
-			array->paa_reqs_array = NULL;
-		}
-
-		if (array->paa_reqs_count != NULL) {
-			OBD_FREE(array->paa_reqs_count,
-				 sizeof(__u32) * array->paa_size);
-			array->paa_reqs_count = NULL;
-		}
+		ptlrpc_service_part_at_fini(svcpt);
 	}
 
 	ptlrpc_service_for_each_part(svcpt, i, svc)
@@ -494,6 +494,26 @@ void lustre_assert_wire_constants(void)
 	LASSERTF((int)sizeof(((struct som_attrs *)0)->som_mountid) == 8, "found %lld\n",
 		 (long long)(int)sizeof(((struct som_attrs *)0)->som_mountid));
 
+	/* Checks for struct lsom_attrs */
+	LASSERTF((int)sizeof(struct lsom_attrs) == 24, "found %lld\n",
+		 (long long)(int)sizeof(struct lsom_attrs));
+	LASSERTF((int)offsetof(struct lsom_attrs, lsa_compat) == 0, "found %lld\n",
+		 (long long)(int)offsetof(struct lsom_attrs, lsa_compat));
+	LASSERTF((int)sizeof(((struct lsom_attrs *)0)->lsa_compat) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct lsom_attrs *)0)->lsa_compat));
+	LASSERTF((int)offsetof(struct lsom_attrs, lsa_incompat) == 4, "found %lld\n",
+		 (long long)(int)offsetof(struct lsom_attrs, lsa_incompat));
+	LASSERTF((int)sizeof(((struct lsom_attrs *)0)->lsa_incompat) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct lsom_attrs *)0)->lsa_incompat));
+	LASSERTF((int)offsetof(struct lsom_attrs, lsa_size) == 8, "found %lld\n",
+		 (long long)(int)offsetof(struct lsom_attrs, lsa_size));
+	LASSERTF((int)sizeof(((struct lsom_attrs *)0)->lsa_size) == 8, "found %lld\n",
+		 (long long)(int)sizeof(((struct lsom_attrs *)0)->lsa_size));
+	LASSERTF((int)offsetof(struct lsom_attrs, lsa_blocks) == 16, "found %lld\n",
+		 (long long)(int)offsetof(struct lsom_attrs, lsa_blocks));
+	LASSERTF((int)sizeof(((struct lsom_attrs *)0)->lsa_blocks) == 8, "found %lld\n",
+		 (long long)(int)sizeof(((struct lsom_attrs *)0)->lsa_blocks));
+
 	/* Checks for struct hsm_attrs */
 	LASSERTF((int)sizeof(struct hsm_attrs) == 24, "found %lld\n",
 		 (long long)(int)sizeof(struct hsm_attrs));
@@ -1158,6 +1178,8 @@ void lustre_assert_wire_constants(void)
 		 OBD_CONNECT_LIGHTWEIGHT);
 	LASSERTF(OBD_CONNECT_SHORTIO == 0x2000000000000ULL, "found 0x%.16llxULL\n",
 		 OBD_CONNECT_SHORTIO);
+	LASSERTF(OBD_CONNECT_XATTR_ALL == 0x8000000000000ULL, "found 0x%.16llxULL\n",
+		 OBD_CONNECT_XATTR_ALL);
 	LASSERTF(OBD_CKSUM_CRC32 == 0x00000001UL, "found 0x%.8xUL\n",
 		(unsigned)OBD_CKSUM_CRC32);
 	LASSERTF(OBD_CKSUM_ADLER == 0x00000002UL, "found 0x%.8xUL\n",
@@ -1368,6 +1390,8 @@ void lustre_assert_wire_constants(void)
 		 OBD_MD_FLCROSSREF);
 	LASSERTF(OBD_MD_FLGETATTRLOCK == (0x0000200000000000ULL), "found 0x%.16llxULL\n",
 		 OBD_MD_FLGETATTRLOCK);
+	LASSERTF(OBD_MD_FLXATTRALL == (0x0000800000000000ULL), "found 0x%.16llxULL\n",
+		 OBD_MD_FLXATTRALL);
 	LASSERTF(OBD_MD_FLRMTLSETFACL == (0x0001000000000000ULL), "found 0x%.16llxULL\n",
 		 OBD_MD_FLRMTLSETFACL);
 	LASSERTF(OBD_MD_FLRMTLGETFACL == (0x0002000000000000ULL), "found 0x%.16llxULL\n",
@@ -1378,6 +1402,8 @@ void lustre_assert_wire_constants(void)
 		 OBD_MD_FLRMTRGETFACL);
 	LASSERTF(OBD_MD_FLDATAVERSION == (0x0010000000000000ULL), "found 0x%.16llxULL\n",
 		 OBD_MD_FLDATAVERSION);
+	LASSERTF(OBD_MD_FLLAZYSIZE == (0x0020000000000000ULL), "found 0x%.16llxULL\n",
+		 OBD_MD_FLLAZYSIZE);
 	CLASSERT(OBD_FL_INLINEDATA == 0x00000001);
 	CLASSERT(OBD_FL_OBDMDEXISTS == 0x00000002);
 	CLASSERT(OBD_FL_DELORPHAN == 0x00000004);
@@ -1398,6 +1424,7 @@ void lustre_assert_wire_constants(void)
 	CLASSERT(OBD_FL_MMAP == 0x00040000);
 	CLASSERT(OBD_FL_RECOV_RESEND == 0x00080000);
 	CLASSERT(OBD_FL_NOSPC_BLK == 0x00100000);
+	CLASSERT(OBD_FL_SHORT_IO == 0x00200000);
 	CLASSERT(OBD_FL_LOCAL_MASK == 0xf0000000);
 
 	/* Checks for struct lov_ost_data_v1 */
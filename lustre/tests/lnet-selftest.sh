@@ -94,10 +94,12 @@ test_smoke_sub () {
         done
     done
 
-    for c in $lst_CONCR; do
-        for d in "${nc}:${ns} --from c --to s" "${ns}:${nc} --from s --to c"; do
-            echo -n "$pre"
-            echo " --concurrency $c --distribute $d ping "
+    for t in ping storm; do
+        for c in $lst_CONCR; do
+            for d in "${nc}:${ns} --from c --to s" "${ns}:${nc} --from s --to c"; do
+                echo -n "$pre"
+                echo " --concurrency $c --distribute $d $t "
+            done
         done
     done
 
@@ -108,6 +110,7 @@ test_smoke_sub () {
     echo 'trap "cleanup $pid" INT TERM'
     echo sleep $smoke_DURATION
     echo 'cleanup $pid'
+    echo "$LST latency --peers c s"
     
 }
 
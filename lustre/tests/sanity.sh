@@ -4473,6 +4473,32 @@ test_60d() {
 }
 run_test 60d "test printk console message masking"
 
+test_60e() {
+	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
+	$LCTL get_param -n debug_defer >/dev/null 2>&1 ||
+		{ skip "no deferred debug formatting"; return; }
+
+	local olddebug=$($LCTL get_param -n debug)
+	local log=$TMP/$tfile.log
+
+	$LCTL set_param debug=+trace
+	$LCTL set_param debug_defer=1
+	$LCTL clear
+	touch $DIR/$tfile
+	stat $DIR/$tfile > /dev/null
+	$LCTL dk $log > /dev/null
+	$LCTL set_param debug_defer=0
+	$LCTL set_param debug="$olddebug"
+
+	# messages must be formatted when the log is dumped
+	grep -q "Process entered" $log || error "no ENTRY messages in log"
+	grep -q "Process leaving" $log || error "no EXIT messages in log"
+	grep "Process leaving" $log | grep -q "(rc=[0-9]" ||
+		error "arguments not formatted"
+	rm -f $log $DIR/$tfile
+}
+run_test 60e "deferred formatting of debug messages"
+
 test_61() {
 	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
 	f="$DIR/f61"
@@ -8904,6 +8930,38 @@ test_160() {
 }
 run_test 160 "changelog sanity"
 
+test_160b() { # changelog chunk cache shared between consumers
+	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
+	remote_mds_nodsh && skip "remote MDS with nodsh" && return
+	local param=mdt.$MDT0.changelog_cache
+
+	do_facet $SINGLEMDS $LCTL get_param -n $param 2>/dev/null |
+		grep -q hits || { skip "no changelog chunk cache"; return; }
+
+	local USER=$(do_facet $SINGLEMDS $LCTL --device $MDT0 \
+		changelog_register -n)
+	echo "Registered as changelog user $USER"
+
+	# fill several llog chunks
+	test_mkdir -p $DIR/$tdir
+	createmany -o $DIR/$tdir/f 500 || error "createmany failed"
+
+	local nr1=$($LFS changelog $MDT0 | wc -l)
+	local hits1=$(do_facet $SINGLEMDS $LCTL get_param -n $param |
+		awk '/hits/ { print $2 }')
+	local nr2=$($LFS changelog $MDT0 | wc -l)
+	local hits2=$(do_facet $SINGLEMDS $LCTL get_param -n $param |
+		awk '/hits/ { print $2 }')
+
+	do_facet $SINGLEMDS $LCTL --device $MDT0 changelog_deregister $USER
+	unlinkmany $DIR/$tdir/f 500
+
+	echo "records $nr1/$nr2 cache hits $hits1 -> $hits2"
+	[ $nr1 -le $nr2 ] || error "second reader lost records: $nr1 > $nr2"
+	[ $hits2 -gt $hits1 ] || error "second reader did not hit chunk cache"
+}
+run_test 160b "changelog readers share llog chunks on the MDT"
+
 test_161() {
 	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
     test_mkdir -p $DIR/$tdir
@@ -10078,12 +10136,13 @@ test_215() { # for bugs 18102, 21079, 21517
 	remove_lnet_proc_files "routes"
 
 	# /proc/sys/lnet/routers should look like this:
-	# ref rtr_ref alive_cnt state last_ping ping_sent deadline down_ni router
+	# ref rtr_ref alive_cnt state last_ping ping_sent deadline down_ni rtt router
 	# where ref > 0, rtr_ref > 0, alive_cnt >= 0, state is up/down,
 	# last_ping >= 0, ping_sent is boolean (0/1), deadline and down_ni are
-	# numeric (0 or >0 or <0), router is a string like 192.168.1.1@tcp2
-	L1="^ref +rtr_ref +alive_cnt +state +last_ping +ping_sent +deadline +down_ni +router$"
-	BR="^$P +$P +$N +(up|down) +$N +(0|1) +$I +$I +$NID$"
+	# numeric (0 or >0 or <0), rtt >= 0, router is a string like
+	# 192.168.1.1@tcp2
+	L1="^ref +rtr_ref +alive_cnt +state +last_ping +ping_sent +deadline +down_ni +rtt +router$"
+	BR="^$P +$P +$N +(up|down) +$N +(0|1) +$I +$I +$N +$NID$"
 	create_lnet_proc_files "routers"
 	check_lnet_proc_entry "routers.out" "/proc/sys/lnet/routers" "$BR" "$L1"
 	check_lnet_proc_entry "routers.sys" "lnet.routers" "$BR" "$L1"
@@ -10650,6 +10709,426 @@ test_230b() {
 }
 run_test 230b "nested remote directory should be failed"
 
+test_231() {
+	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
+	remote_ost_nodsh && skip "remote OST with nodsh" && return
+	local param=ost.OSS.ost_io
+
+	do_facet ost1 $LCTL get_param -n $param.threads_idle_timeout \
+		>/dev/null 2>&1 ||
+		{ skip "no thread pool shrinking on OSS"; return; }
+
+	local old=$(do_facet ost1 $LCTL get_param -n \
+		$param.threads_idle_timeout)
+	local tmin=$(do_facet ost1 $LCTL get_param -n $param.threads_min)
+
+	# grow the pool with parallel I/O
+	for i in $(seq 8); do
+		dd if=/dev/zero of=$DIR/$tfile.$i bs=1M count=32 \
+			oflag=direct 2>/dev/null &
+	done
+	wait
+	local before=$(do_facet ost1 $LCTL get_param -n \
+		$param.threads_started)
+	do_facet ost1 $LCTL get_param -n $param.req_wait_hist |
+		grep -q "queue wait" || error "no queue wait histogram"
+
+	do_facet ost1 $LCTL set_param $param.threads_idle_timeout=1
+	sleep 10
+	local after=$(do_facet ost1 $LCTL get_param -n \
+		$param.threads_started)
+	do_facet ost1 $LCTL set_param $param.threads_idle_timeout=$old
+	rm -f $DIR/$tfile.*
+
+	echo "threads min $tmin, started $before -> $after"
+	[ $after -ge $tmin ] || error "pool shrunk below threads_min"
+	[ $before -le $tmin -o $after -lt $before ] ||
+		error "idle threads did not exit: $before -> $after"
+}
+run_test 231 "idle service threads exit down to threads_min"
+
+test_232() {
+	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
+	remote_mds_nodsh && skip "remote MDS with nodsh" && return
+	local param=mds.MDS.mdt.req_buffers
+
+	do_facet $SINGLEMDS $LCTL get_param -n $param >/dev/null 2>&1 ||
+		{ skip "no request buffer pool stats on MDS"; return; }
+
+	local before=$(do_facet $SINGLEMDS $LCTL get_param -n $param |
+		       awk '{ total += $4 } END { print total }')
+	local nthreads=8
+	local i
+
+	# a burst of metadata requests should grow the pool
+	mkdir -p $DIR/$tdir
+	for i in $(seq $nthreads); do
+		createmany -o $DIR/$tdir/f$i- 2000 &
+	done
+	wait
+	do_facet $SINGLEMDS $LCTL get_param -n $param
+	local after=$(do_facet $SINGLEMDS $LCTL get_param -n $param |
+		      awk '{ total += $4 } END { print total }')
+	[ $after -gt $before ] ||
+		error "request buffers not grown: $before -> $after"
+	for i in $(seq $nthreads); do
+		unlinkmany $DIR/$tdir/f$i- 2000 || error "unlinkmany failed"
+	done
+	rm -rf $DIR/$tdir
+}
+run_test 232 "request buffer pool tracks arrival rate"
+
+test_233() {
+	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
+	local param="mdc.$FSNAME-MDT0000-mdc-*.stats_latency"
+
+	$LCTL get_param -n $param >/dev/null 2>&1 ||
+		{ skip "no latency histograms on MDC"; return; }
+
+	$LCTL set_param $param=0
+	mkdir -p $DIR/$tdir
+	createmany -o $DIR/$tdir/f- 100 || error "createmany failed"
+	$LCTL get_param -n $param
+	# percentiles must be non-decreasing and bounded by max
+	$LCTL get_param -n $param | awk '/samples/ {
+		n++
+		if ($6 > $8 || $8 > $10 || $10 > $12 || $12 > $14) exit 1
+	} END { if (n == 0) exit 1 }' || error "bad latency histogram"
+	unlinkmany $DIR/$tdir/f- 100 || error "unlinkmany failed"
+	rm -rf $DIR/$tdir
+}
+run_test 233 "per-opcode latency histograms on client imports"
+
+test_234() {
+	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
+	remote_ost_nodsh && skip "remote OST with nodsh" && return
+	[ "$(facet_fstype ost1)" != "zfs" ] &&
+		skip "deferred destroy only on ZFS OST" && return
+	local ost=$(ostname_from_index 0)
+	local param=osd-zfs.$ost.destroys_pending
+	local max=$(do_facet ost1 $LCTL get_param -n \
+		osd-zfs.$ost.sync_destroy_max_size)
+
+	do_facet ost1 $LCTL set_param osd-zfs.$ost.sync_destroy_max_size=0
+	$SETSTRIPE -c 1 -i 0 $DIR/$tfile || error "setstripe failed"
+	dd if=/dev/zero of=$DIR/$tfile bs=1M count=64 || error "dd failed"
+	rm -f $DIR/$tfile
+	wait_delete_completed
+	do_facet ost1 $LCTL get_param $param
+	# the backlog is drained by the osd_destroy thread
+	wait_update_facet ost1 \
+		"$LCTL get_param -n $param | head -1 | cut -d' ' -f2" 0 60 ||
+		error "unlinked objects were not freed"
+	do_facet ost1 $LCTL set_param osd-zfs.$ost.sync_destroy_max_size=$max
+}
+run_test 234 "large objects are freed in background on ZFS OST"
+
+test_235() {
+	[ $OSTCOUNT -lt 2 ] && skip "needs >= 2 OSTs" && return
+	local param="lov.$FSNAME-clilov-*.rw_stripes"
+	local old=$($LCTL get_param -n $param 2>/dev/null | head -1)
+
+	[ -z "$old" ] && skip "no rw_stripes on LOV" && return
+
+	$SETSTRIPE -c -1 -s 64k $DIR/$tfile || error "setstripe failed"
+	dd if=/dev/urandom of=$TMP/$tfile bs=1M count=8 ||
+		error "dd to $TMP failed"
+	local sum=$(md5sum < $TMP/$tfile)
+	for n in 1 2 0; do
+		$LCTL set_param $param=$n
+		dd if=$TMP/$tfile of=$DIR/$tfile bs=4M conv=notrunc ||
+			error "write with rw_stripes=$n failed"
+		cancel_lru_locks osc
+		[ "$(md5sum < $DIR/$tfile)" == "$sum" ] ||
+			error "data mismatch with rw_stripes=$n"
+	done
+	$LCTL set_param $param=$old
+	rm -f $DIR/$tfile $TMP/$tfile
+}
+run_test 235 "read/write iterations spanning several stripes"
+
+test_236() {
+	$LCTL get_param -n llite.*.xattr_cache >/dev/null 2>&1 ||
+		{ skip "no xattr cache on client"; return; }
+	local stats="llite.*.stats"
+
+	touch $DIR/$tfile
+	setfattr -n user.a -v foo $DIR/$tfile ||
+		{ skip "user xattrs not supported"; return; }
+	setfattr -n user.b -v bar $DIR/$tfile
+	stat $DIR/$tfile > /dev/null
+
+	$LCTL set_param $stats=0
+	for i in $(seq 10); do
+		[ "$(getfattr --only-values -n user.a $DIR/$tfile)" == "foo" ] ||
+			error "wrong value for user.a"
+	done
+	getfattr -d $DIR/$tfile | grep -q "user.b=\"bar\"" ||
+		error "user.b not listed"
+	local hits=$($LCTL get_param -n $stats |
+		awk '/getxattr_hits/ { print $2 }')
+	echo "xattr cache hits: $hits"
+	[ ${hits:-0} -gt 0 ] || error "xattrs were not served from the cache"
+
+	# a change must not leave a stale value behind
+	setfattr -n user.a -v baz $DIR/$tfile
+	[ "$(getfattr --only-values -n user.a $DIR/$tfile)" == "baz" ] ||
+		error "stale value for user.a"
+	setfattr -x user.b $DIR/$tfile
+	getfattr -n user.b $DIR/$tfile 2>/dev/null &&
+		error "user.b still visible after removal"
+	rm -f $DIR/$tfile
+}
+run_test 236 "xattrs are cached under the UPDATE lock"
+
+test_237() {
+	[ $MDSCOUNT -lt 2 ] && skip "needs >= 2 MDTs" && return
+	local param="lmv.*.placement"
+	local old=$($LCTL get_param -n $param | head -1)
+	local count=$((MDSCOUNT * 8))
+	local idx
+
+	mkdir -p $DIR/$tdir
+	$LCTL set_param $param=QOS
+	for i in $(seq $count); do
+		$LFS mkdir -i -1 $DIR/$tdir/d$i ||
+			error "create remote dir d$i failed"
+	done
+	$LCTL set_param $param=$old
+
+	local used=$(for i in $(seq $count); do
+			$LFS getstripe -M $DIR/$tdir/d$i
+		     done | sort -u | wc -l)
+	echo "$count directories placed on $used MDTs"
+	[ $used -gt 1 ] || error "all directories placed on one MDT"
+	rm -rf $DIR/$tdir
+}
+run_test 237 "QoS placement spreads remote directories over MDTs"
+
+test_238() {
+	local param="llite.*.lazy_size_max_age"
+	$LCTL get_param -n $param >/dev/null 2>&1 ||
+		{ skip "no lazy size on client"; return; }
+	local old=$($LCTL get_param -n $param | head -1)
+	local stats="llite.*.stats"
+	local size
+	local blocks
+
+	$LCTL set_param $param=60
+	# only a close without dirty pages saves the lazy size
+	dd if=/dev/zero of=$DIR/$tfile bs=1k count=100 conv=fsync ||
+		error "write $DIR/$tfile failed"
+	cancel_lru_locks mdc
+	cancel_lru_locks osc
+
+	$LCTL set_param $stats=0
+	size=$(stat -c %s $DIR/$tfile)
+	blocks=$(stat -c %b $DIR/$tfile)
+	local lazy=$($LCTL get_param -n $stats |
+		awk '/getattr_lazy_size/ { print $2 }')
+	echo "size $size, blocks $blocks, lazy stat count ${lazy:-0}"
+	[ $size -eq 102400 ] || error "wrong lazy size $size"
+	[ $blocks -gt 0 ] || error "no blocks in lazy size"
+	[ ${lazy:-0} -gt 0 ] || error "lazy size was not used"
+
+	# a close with dirty pages must not leave the old size behind
+	dd if=/dev/zero of=$DIR/$tfile bs=1k count=200 ||
+		error "rewrite $DIR/$tfile failed"
+	cancel_lru_locks mdc
+	cancel_lru_locks osc
+	size=$(stat -c %s $DIR/$tfile)
+	[ $size -eq 204800 ] || error "stale size $size after rewrite"
+
+	# truncate drops the lazy size on the MDT and on the client
+	$TRUNCATE $DIR/$tfile 4096 || error "truncate failed"
+	cancel_lru_locks mdc
+	cancel_lru_locks osc
+	size=$(stat -c %s $DIR/$tfile)
+	$LCTL set_param $param=$old
+	[ $size -eq 4096 ] || error "stale size $size after truncate"
+	rm -f $DIR/$tfile
+}
+run_test 238 "stat uses the lazy size-on-MDT of closed files"
+
+test_239() {
+	local param="llite.*.glimpse_cache_max_age_ms"
+	$LCTL get_param -n $param >/dev/null 2>&1 ||
+		{ skip "no glimpse cache on client"; return; }
+	local old=$($LCTL get_param -n $param | head -1)
+	local stats="llite.*.stats"
+	local size1
+	local size2
+
+	$SETSTRIPE -c -1 $DIR/$tfile || error "setstripe $DIR/$tfile failed"
+	dd if=/dev/zero of=$DIR/$tfile bs=1M count=$OSTCOUNT ||
+		error "write $DIR/$tfile failed"
+	cancel_lru_locks osc
+
+	$LCTL set_param $param=10000
+	$LCTL set_param $stats=0
+	size1=$(stat -c %s $DIR/$tfile)
+	size2=$(stat -c %s $DIR/$tfile)
+	local cached=$($LCTL get_param -n $stats |
+		awk '/getattr_glimpse_cached/ { print $2 }')
+	$LCTL set_param $param=$old
+	echo "sizes $size1 $size2, cached glimpse count ${cached:-0}"
+	[ $size1 -eq $size2 ] || error "cached size $size2 != $size1"
+	[ ${cached:-0} -gt 0 ] || error "glimpse result was not reused"
+	rm -f $DIR/$tfile
+}
+run_test 239 "repeated stat of a striped file reuses the glimpse result"
+
+test_240() {
+	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
+	local opts="$MOUNTOPT,stream_write"
+	local cached
+
+	[ -z "$MOUNTOPT" ] && opts="-o stream_write"
+	zconf_umount $(hostname) $MOUNT || error "umount failed"
+	zconf_mount $(hostname) $MOUNT "$opts" || error "mount failed"
+	grep " $MOUNT " /proc/mounts | grep -q stream_write || {
+		remount_client $MOUNT
+		skip "stream_write mount option not supported"
+		return
+	}
+
+	cancel_lru_locks osc
+	dd if=/dev/zero of=$DIR/$tfile bs=1M count=64 conv=fsync ||
+		error "write $DIR/$tfile failed"
+	cached=$($LCTL get_param -n osc.*.osc_cached_mb |
+		awk '/used_mb/ { sum += $2 } END { print sum + 0 }')
+	echo "$cached MB left in the client cache after a streaming write"
+	rm -f $DIR/$tfile
+	remount_client $MOUNT
+	[ $cached -lt 16 ] || error "$cached MB of streamed pages still cached"
+}
+run_test 240 "streaming writes do not fill the client cache"
+
+test_241() {
+	local param="osc.$FSNAME-OST0000*.osc_cached_mb"
+	$LCTL get_param -n $param | grep -q lru_reclaimed ||
+		{ skip "no LRU shrink statistics"; return; }
+	local before
+	local after
+
+	$SETSTRIPE -c 1 -i 0 $DIR/$tfile || error "setstripe failed"
+	dd if=/dev/zero of=$DIR/$tfile bs=1M count=16 conv=fsync ||
+		error "write $DIR/$tfile failed"
+	$LCTL get_param $param
+	before=$($LCTL get_param -n $param | awk '/lru_reclaimed/ { print $2 }')
+	$LCTL set_param $param=0
+	after=$($LCTL get_param -n $param | awk '/lru_reclaimed/ { print $2 }')
+	$LCTL get_param $param
+	rm -f $DIR/$tfile
+	[ $after -gt $before ] || error "no cached page was reclaimed"
+}
+run_test 241 "LRU shrink statistics of cached pages"
+
+test_242() {
+	local osc="osc.$FSNAME-OST0000*"
+	$LCTL get_param -n $osc.max_rpcs_in_flight_auto >/dev/null 2>&1 ||
+		{ skip "no adaptive max_rpcs_in_flight"; return; }
+	local old_rif=$($LCTL get_param -n $osc.max_rpcs_in_flight)
+	local old_max=$($LCTL get_param -n $osc.max_rpcs_in_flight_max)
+	local rif
+	local rtt
+
+	$LCTL set_param $osc.max_rpcs_in_flight_max=16
+	$LCTL set_param $osc.max_rpcs_in_flight_auto=1
+	$SETSTRIPE -c 1 -i 0 $DIR/$tfile || error "setstripe failed"
+	dd if=/dev/zero of=$DIR/$tfile bs=1M count=64 conv=fsync ||
+		error "write $DIR/$tfile failed"
+	$LCTL get_param $osc.max_rpcs_in_flight_auto
+	rif=$($LCTL get_param -n $osc.max_rpcs_in_flight)
+	rtt=$($LCTL get_param -n $osc.max_rpcs_in_flight_auto |
+		awk '/^rpc_time_usec/ { print $2 }')
+
+	$LCTL set_param $osc.max_rpcs_in_flight_auto=0
+	$LCTL set_param $osc.max_rpcs_in_flight_max=$old_max
+	$LCTL set_param $osc.max_rpcs_in_flight=$old_rif
+	rm -f $DIR/$tfile
+	echo "max_rpcs_in_flight $rif, rpc time $rtt usec"
+	[ $rtt -gt 0 ] || error "BRW RPC time was not measured"
+	[ $rif -ge 1 -a $rif -le 16 ] || error "max_rpcs_in_flight $rif unbounded"
+}
+run_test 242 "max_rpcs_in_flight adapts to BRW RPC time within bounds"
+
+test_243() {
+	local osc="osc.$FSNAME-OST0000*"
+	$LCTL get_param -n $osc.connect_flags | grep -q short_io ||
+		{ skip "OST does not support short I/O"; return; }
+	local old_short=$($LCTL get_param -n $osc.short_io_bytes)
+	local bs
+	local writes
+	local reads
+
+	$LCTL set_param $osc.short_io_bytes=16384
+	$SETSTRIPE -c 1 -i 0 $DIR/$tfile || error "setstripe failed"
+	$LCTL set_param $osc.osc_stats=0
+	for bs in 1 3 7 13 16; do
+		dd if=/dev/urandom of=$TMP/$tfile bs=1k count=$bs 2>/dev/null
+		cp $TMP/$tfile $DIR/$tfile || error "write $bs KB failed"
+		cancel_lru_locks osc
+		cmp $TMP/$tfile $DIR/$tfile || error "$bs KB differs"
+	done
+	dd if=$TMP/$tfile of=$DIR/$tfile bs=4k count=4 oflag=direct ||
+		error "direct write failed"
+	cancel_lru_locks osc
+	dd if=$DIR/$tfile of=$TMP/$tfile.2 bs=4k count=4 iflag=direct ||
+		error "direct read failed"
+	cmp $TMP/$tfile $TMP/$tfile.2 || error "direct I/O data differs"
+	writes=$($LCTL get_param -n $osc.osc_stats |
+		awk '/^short_io_write_rpcs/ { print $2 }')
+	reads=$($LCTL get_param -n $osc.osc_stats |
+		awk '/^short_io_read_rpcs/ { print $2 }')
+
+	$LCTL set_param $osc.short_io_bytes=$old_short
+	rm -f $DIR/$tfile $TMP/$tfile $TMP/$tfile.2
+	echo "short I/O RPCs: $writes writes, $reads reads"
+	[ ${writes:-0} -gt 0 ] || error "no write went as short I/O"
+	[ ${reads:-0} -gt 0 ] || error "no read went as short I/O"
+}
+run_test 243 "small reads and writes carried inline in the BRW RPC"
+
+test_244() {
+	[ "$(facet_fstype $SINGLEMDS)" != zfs ] &&
+		skip "zfs only test" && return
+	local osd="osd-zfs.$FSNAME-MDT0000"
+	local hash=$(do_facet $SINGLEMDS $LCTL get_param -n $osd.oi_hash \
+		     2>/dev/null)
+	[ -z "$hash" ] && skip "no OI hash on MDS" && return
+	[ "$hash" != fid ] && skip "OIs of this filesystem hashed by $hash" &&
+		return
+	local count=100
+	local fid
+	local hits
+	local i
+
+	test_mkdir -p $DIR/$tdir
+	createmany -o $DIR/$tdir/f $count || error "createmany failed"
+	# drop the cached objects, every lookup has to go to the OIs
+	cancel_lru_locks mdc
+	do_facet $SINGLEMDS "echo 3 > /proc/sys/vm/drop_caches"
+	for ((i = 0; i < count; i++)); do
+		stat $DIR/$tdir/f$i > /dev/null || error "f$i not found"
+	done
+
+	fid=$($LFS path2fid $DIR/$tdir/f0)
+	rm -f $DIR/$tdir/f0 || error "rm f0 failed"
+	hits=$(do_facet $SINGLEMDS $LCTL get_param -n $osd.oi_neg_hits)
+	for i in 1 2 3; do
+		cancel_lru_locks mdc
+		do_facet $SINGLEMDS "echo 3 > /proc/sys/vm/drop_caches"
+		stat $MOUNT/.lustre/fid/$fid > /dev/null 2>&1 &&
+			error "removed $fid still found"
+	done
+	i=$(do_facet $SINGLEMDS $LCTL get_param -n $osd.oi_neg_hits)
+	echo "negative OI cache hits: $hits -> $i"
+	[ $i -gt $hits ] || error "lookups of $fid missed the negative cache"
+	unlinkmany $DIR/$tdir/f 1 $((count - 1)) || error "unlinkmany failed"
+}
+run_test 244 "osd-zfs OIs hashed by FID and the negative OI cache"
+
 #
 # tests that do cleanup/setup should be run at the end
 #
@@ -147,7 +147,8 @@ command_t cmdlist[] = {
 	{"setdirstripe", lfs_setdirstripe, 0,
 	 "To create a remote directory on a specified MDT.\n"
 	 "usage: setdirstripe <--index|-i mdt_index> <dir>\n"
-	 "\tmdt_index:    MDT index of first stripe\n"},
+	 "\tmdt_index:    MDT index of first stripe, -1 lets the client\n"
+	 "\t              choose (see lmv.*.placement)\n"},
 	{"getdirstripe", lfs_getdirstripe, 0,
 	 "To list the striping info for a given directory\n"
 	 "or recursively for all directories in a directory tree.\n"
@@ -158,7 +159,8 @@ command_t cmdlist[] = {
 	 "To create a remote directory on a specified MDT. And this can only\n"
 	 "be done on MDT0 by administrator.\n"
 	 "usage: mkdir <--index|-i mdt_index> <dir>\n"
-	 "\tmdt_index:    MDT index of the remote directory.\n"},
+	 "\tmdt_index:    MDT index of the remote directory, -1 lets the\n"
+	 "\t              client choose (see lmv.*.placement)\n"},
 	{"rm_entry", lfs_rmentry, 0,
 	 "To remove the name entry of the remote directory. Note: This\n"
 	 "command will only delete the name entry, i.e. the remote directory\n"
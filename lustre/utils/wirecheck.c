@@ -226,6 +226,17 @@ check_som_attrs(void)
 	CHECK_MEMBER(som_attrs, som_mountid);
 }
 
+static void
+check_lsom_attrs(void)
+{
+	BLANK_LINE();
+	CHECK_STRUCT(lsom_attrs);
+	CHECK_MEMBER(lsom_attrs, lsa_compat);
+	CHECK_MEMBER(lsom_attrs, lsa_incompat);
+	CHECK_MEMBER(lsom_attrs, lsa_size);
+	CHECK_MEMBER(lsom_attrs, lsa_blocks);
+}
+
 static void
 check_hsm_attrs(void)
 {
@@ -520,6 +531,7 @@ check_obd_connect_data(void)
 	CHECK_DEFINE_64X(OBD_CONNECT_NANOSEC_TIME);
 	CHECK_DEFINE_64X(OBD_CONNECT_LIGHTWEIGHT);
 	CHECK_DEFINE_64X(OBD_CONNECT_SHORTIO);
+	CHECK_DEFINE_64X(OBD_CONNECT_XATTR_ALL);
 
 	CHECK_VALUE_X(OBD_CKSUM_CRC32);
 	CHECK_VALUE_X(OBD_CKSUM_ADLER);
@@ -603,11 +615,13 @@ check_obdo(void)
 	CHECK_DEFINE_64X(OBD_MD_FLCKSPLIT);
 	CHECK_DEFINE_64X(OBD_MD_FLCROSSREF);
 	CHECK_DEFINE_64X(OBD_MD_FLGETATTRLOCK);
+	CHECK_DEFINE_64X(OBD_MD_FLXATTRALL);
 	CHECK_DEFINE_64X(OBD_MD_FLRMTLSETFACL);
 	CHECK_DEFINE_64X(OBD_MD_FLRMTLGETFACL);
 	CHECK_DEFINE_64X(OBD_MD_FLRMTRSETFACL);
 	CHECK_DEFINE_64X(OBD_MD_FLRMTRGETFACL);
 	CHECK_DEFINE_64X(OBD_MD_FLDATAVERSION);
+	CHECK_DEFINE_64X(OBD_MD_FLLAZYSIZE);
 
 	CHECK_CVALUE_X(OBD_FL_INLINEDATA);
 	CHECK_CVALUE_X(OBD_FL_OBDMDEXISTS);
@@ -629,6 +643,7 @@ check_obdo(void)
 	CHECK_CVALUE_X(OBD_FL_MMAP);
 	CHECK_CVALUE_X(OBD_FL_RECOV_RESEND);
 	CHECK_CVALUE_X(OBD_FL_NOSPC_BLK);
+	CHECK_CVALUE_X(OBD_FL_SHORT_IO);
 	CHECK_CVALUE_X(OBD_FL_LOCAL_MASK);
 }
 
@@ -2319,6 +2334,7 @@ main(int argc, char **argv)
 	CHECK_VALUE(OBJ_INDEX_DELETE);
 
 	check_som_attrs();
+	check_lsom_attrs();
 	check_hsm_attrs();
 	check_ost_id();
 	check_lu_dirent();